@@ -0,0 +1,154 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/// @brief The binary log format, in which messages are written with their arguments rather than their text. Shared by
+/// the Logger and by the offline decoder in Tools/LogDecoder, it must not depend on anything Windows-specific.
+/// @remarks A binary log file begins with a FileHeader, followed by records until the end of the file or until a record
+/// with a zero type, which marks the unwritten tail of a file cut short by a crash. Every field is little-endian.
+/// Section names and format strings are written once per file as String records, messages refer to them by ID, so
+/// that every file can be decoded on its own.
+namespace RbxStu::BinaryLog {
+    /// @brief Marks the start of a binary log file, "RSBL" in little-endian.
+    constexpr std::uint32_t BinaryLogMagic = 0x4C425352;
+    /// @brief Incremented whenever the layout of the binary log format changes.
+    constexpr std::uint16_t BinaryLogVersion = 1;
+
+    struct FileHeader {
+        /// @brief Must be BinaryLogMagic.
+        std::uint32_t dwMagic;
+        /// @brief Must be BinaryLogVersion.
+        std::uint16_t wVersion;
+        std::uint16_t wReserved;
+    };
+    static_assert(sizeof(FileHeader) == 8);
+
+    enum class RecordType : std::uint8_t {
+        /// @brief Followed by a StringRecord and then by the string.
+        String = 1,
+        /// @brief Followed by a MessageRecord and then by its arguments.
+        Message = 2,
+    };
+
+    struct RecordHeader {
+        RecordType type;
+        std::uint8_t bReserved;
+        std::uint16_t wReserved;
+        /// @brief The size of the record, not counting this header.
+        std::uint32_t dwLength;
+    };
+    static_assert(sizeof(RecordHeader) == 8);
+
+    struct StringRecord {
+        /// @brief The ID the string is referred to with in the rest of the file.
+        std::uint32_t dwId;
+    };
+    static_assert(sizeof(StringRecord) == 4);
+
+    /// @brief The levels of messages, as numbered by RbxStu::LogLevel.
+    constexpr std::string_view LevelNames[] = {"TRACE", "DEBUG", "INFO", "WARN", "ERROR"};
+
+    struct MessageRecord {
+        /// @brief An index into LevelNames.
+        std::uint8_t bLevel;
+        std::uint8_t bArgumentCount;
+        std::uint16_t wReserved;
+        /// @brief The ID of the thread that logged the message.
+        std::uint32_t dwThreadId;
+        /// @brief The ID of the String record with the section name.
+        std::uint32_t dwSectionId;
+        /// @brief The ID of the String record with the format string, in the syntax of std::format.
+        std::uint32_t dwFormatId;
+        /// @brief When the message was logged, in nanoseconds since the UNIX epoch.
+        std::int64_t llTimestamp;
+    };
+    static_assert(sizeof(MessageRecord) == 24);
+
+    /// @brief The type of an argument, each one being a single byte with its type followed by its value.
+    enum class ArgumentType : std::uint8_t {
+        /// @brief An std::int64_t.
+        SignedInteger = 1,
+        /// @brief An std::uint64_t.
+        UnsignedInteger = 2,
+        /// @brief A double.
+        Float = 3,
+        /// @brief A single byte, zero or one.
+        Boolean = 4,
+        /// @brief A single byte.
+        Character = 5,
+        /// @brief An std::uint64_t, formatted as a pointer.
+        Pointer = 6,
+        /// @brief An std::uint32_t with the length of the string followed by the string. Arguments of types the format
+        /// has no type for are written as their default formatting.
+        String = 7,
+    };
+
+    /// @brief Appends a value to a record, as its bytes.
+    template<typename T>
+    void AppendValue(std::string &szOutput, const T &value) {
+        szOutput.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    /// @brief Appends a record header, reserving the length of the record, which is filled in by EndRecord.
+    /// @return The offset of the record header, to be given to EndRecord.
+    inline std::size_t BeginRecord(std::string &szOutput, const RecordType type) {
+        const auto ullOffset = szOutput.size();
+        AppendValue(szOutput, RecordHeader{type, 0, 0, 0});
+        return ullOffset;
+    }
+
+    /// @brief Fills in the length of a record begun by BeginRecord, once everything in it has been appended.
+    inline void EndRecord(std::string &szOutput, const std::size_t ullOffset) {
+        const auto dwLength = static_cast<std::uint32_t>(szOutput.size() - ullOffset - sizeof(RecordHeader));
+        std::memcpy(szOutput.data() + ullOffset + offsetof(RecordHeader, dwLength), &dwLength, sizeof(dwLength));
+    }
+
+    inline void AppendStringRecord(std::string &szOutput, const std::uint32_t dwId, const std::string_view szString) {
+        const auto ullRecord = BeginRecord(szOutput, RecordType::String);
+        AppendValue(szOutput, StringRecord{dwId});
+        szOutput.append(szString);
+        EndRecord(szOutput, ullRecord);
+    }
+
+    inline void AppendStringArgument(std::string &szOutput, const std::string_view szArgument) {
+        AppendValue(szOutput, ArgumentType::String);
+        AppendValue(szOutput, static_cast<std::uint32_t>(szArgument.size()));
+        szOutput.append(szArgument);
+    }
+
+    /// @brief Reads the next record of a binary log file.
+    /// @param szBytes The bytes of the file past the ones read so far, which are advanced past the record.
+    /// @param header The header of the record.
+    /// @param szRecord The bytes of the record, past its header.
+    /// @return False at the end of the file, be it due to no bytes being left, to a zero type or to a record being cut
+    /// short.
+    inline bool ReadRecord(std::string_view &szBytes, RecordHeader &header, std::string_view &szRecord) {
+        if (szBytes.size() < sizeof(RecordHeader))
+            return false;
+
+        std::memcpy(&header, szBytes.data(), sizeof(RecordHeader));
+        if (header.type == RecordType{} || szBytes.size() - sizeof(RecordHeader) < header.dwLength)
+            return false;
+
+        szRecord = szBytes.substr(sizeof(RecordHeader), header.dwLength);
+        szBytes.remove_prefix(sizeof(RecordHeader) + header.dwLength);
+        return true;
+    }
+
+    /// @brief Reads a value from a record, advancing past it.
+    /// @return An empty optional if the record is too short for it.
+    template<typename T>
+    std::optional<T> ReadValue(std::string_view &szRecord) {
+        if (szRecord.size() < sizeof(T))
+            return {};
+
+        T value;
+        std::memcpy(&value, szRecord.data(), sizeof(T));
+        szRecord.remove_prefix(sizeof(T));
+        return value;
+    }
+} // namespace RbxStu::BinaryLog
@@ -0,0 +1,322 @@
+#include "BytecodeValidator.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <vector>
+
+#include "Luau/Bytecode.h"
+
+/// @brief Reads a byte, advancing the offset past it.
+/// @return False if the bytecode has ended.
+static bool ReadByte(const std::string_view szBytecode, std::size_t &ullOffset, std::uint8_t &bValue) {
+    if (ullOffset >= szBytecode.size())
+        return false;
+
+    bValue = static_cast<std::uint8_t>(szBytecode[ullOffset++]);
+    return true;
+}
+
+/// @brief Reads a variable-length integer, as written by the Luau compiler, advancing the offset past it.
+/// @return False if the bytecode has ended, or the integer does not fit in 32 bits.
+static bool ReadVarInt(const std::string_view szBytecode, std::size_t &ullOffset, std::uint32_t &dwValue) {
+    dwValue = 0;
+    for (std::uint32_t dwShift = 0; dwShift < 35; dwShift += 7) {
+        std::uint8_t bByte;
+        if (!ReadByte(szBytecode, ullOffset, bByte))
+            return false;
+
+        dwValue |= static_cast<std::uint32_t>(bByte & 127) << dwShift;
+        if ((bByte & 128) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+/// @brief Advances the offset past the given amount of bytes.
+/// @return False if the bytecode ends before that many bytes.
+static bool Skip(const std::string_view szBytecode, std::size_t &ullOffset, const std::uint64_t ullSize) {
+    if (ullSize > szBytecode.size() - ullOffset)
+        return false;
+
+    ullOffset += ullSize;
+    return true;
+}
+
+/// @brief Reads a reference into the string table, where zero stands for no string.
+/// @return False if the bytecode has ended, or the reference is out of the bounds of the string table.
+static bool ReadStringRef(const std::string_view szBytecode, std::size_t &ullOffset,
+                          const std::uint32_t dwStringCount) {
+    std::uint32_t dwStringId;
+    return ReadVarInt(szBytecode, ullOffset, dwStringId) && dwStringId <= dwStringCount;
+}
+
+/// @brief Validates the type information of a function, as encoded from bytecode type version 2 onwards, which both
+/// luau_load and native code generation walk through.
+static bool ValidateTypeInfo(const std::string_view szTypeInfo) {
+    std::size_t ullOffset = 0;
+    std::uint32_t dwTypeSize, dwUpvalueCount, dwLocalCount;
+    if (!ReadVarInt(szTypeInfo, ullOffset, dwTypeSize) || !ReadVarInt(szTypeInfo, ullOffset, dwUpvalueCount) ||
+        !ReadVarInt(szTypeInfo, ullOffset, dwLocalCount))
+        return false;
+
+    if ((dwTypeSize != 0 && dwTypeSize < 2) || !Skip(szTypeInfo, ullOffset, dwTypeSize) ||
+        !Skip(szTypeInfo, ullOffset, dwUpvalueCount))
+        return false;
+
+    for (std::uint32_t dwLocal = 0; dwLocal < dwLocalCount; dwLocal++) {
+        std::uint32_t dwStartPc, dwEndPc;
+        if (!Skip(szTypeInfo, ullOffset, 2) || !ReadVarInt(szTypeInfo, ullOffset, dwStartPc) ||
+            !ReadVarInt(szTypeInfo, ullOffset, dwEndPc))
+            return false;
+    }
+
+    return ullOffset == szTypeInfo.size();
+}
+
+std::optional<std::string> RbxStu::ValidateBytecode(const std::string_view szBytecode) {
+    std::size_t ullOffset = 0;
+    const auto truncated = [&ullOffset] {
+        return std::format("The bytecode is truncated or corrupted around offset {}.", ullOffset);
+    };
+
+    std::uint8_t bVersion;
+    if (!ReadByte(szBytecode, ullOffset, bVersion))
+        return "The bytecode is empty.";
+
+    // A version of zero is how the compiler reports errors, the rest of the blob is the error message.
+    if (bVersion == 0)
+        return std::format("The bytecode carries a compilation error: {}", szBytecode.substr(1));
+
+    if (bVersion < LBC_VERSION_MIN || bVersion > LBC_VERSION_MAX)
+        return std::format("Unsupported bytecode version {}, expected a version between {} and {}.", bVersion,
+                           static_cast<int>(LBC_VERSION_MIN), static_cast<int>(LBC_VERSION_MAX));
+
+    std::uint8_t bTypesVersion = 0;
+    if (bVersion >= 4) {
+        if (!ReadByte(szBytecode, ullOffset, bTypesVersion))
+            return truncated();
+
+        if (bTypesVersion < LBC_TYPE_VERSION_MIN || bTypesVersion > LBC_TYPE_VERSION_MAX)
+            return std::format("Unsupported bytecode type version {}, expected a version between {} and {}.",
+                               bTypesVersion, static_cast<int>(LBC_TYPE_VERSION_MIN),
+                               static_cast<int>(LBC_TYPE_VERSION_MAX));
+    }
+
+    std::uint32_t dwStringCount;
+    if (!ReadVarInt(szBytecode, ullOffset, dwStringCount))
+        return truncated();
+
+    for (std::uint32_t dwString = 0; dwString < dwStringCount; dwString++) {
+        std::uint32_t dwLength;
+        if (!ReadVarInt(szBytecode, ullOffset, dwLength) || !Skip(szBytecode, ullOffset, dwLength))
+            return truncated();
+    }
+
+    if (bTypesVersion == 3) {
+        // The userdata type names, terminated by an index of zero.
+        std::uint8_t bIndex;
+        if (!ReadByte(szBytecode, ullOffset, bIndex))
+            return truncated();
+
+        while (bIndex != 0) {
+            if (!ReadStringRef(szBytecode, ullOffset, dwStringCount) || !ReadByte(szBytecode, ullOffset, bIndex))
+                return truncated();
+        }
+    }
+
+    std::uint32_t dwProtoCount;
+    if (!ReadVarInt(szBytecode, ullOffset, dwProtoCount))
+        return truncated();
+
+    // Functions may only refer to those that come before them, as luau_load resolves the references as it goes.
+    std::vector<std::uint8_t> constantKinds;
+    for (std::uint32_t dwProto = 0; dwProto < dwProtoCount; dwProto++) {
+        std::uint8_t bMaxStackSize, bParameterCount, bUpvalueCount, bIsVararg;
+        if (!ReadByte(szBytecode, ullOffset, bMaxStackSize) || !ReadByte(szBytecode, ullOffset, bParameterCount) ||
+            !ReadByte(szBytecode, ullOffset, bUpvalueCount) || !ReadByte(szBytecode, ullOffset, bIsVararg))
+            return truncated();
+
+        if (bVersion >= 4) {
+            std::uint8_t bFlags;
+            std::uint32_t dwTypeSize;
+            if (!ReadByte(szBytecode, ullOffset, bFlags) || !ReadVarInt(szBytecode, ullOffset, dwTypeSize) ||
+                dwTypeSize > szBytecode.size() - ullOffset)
+                return truncated();
+
+            if (bTypesVersion >= 2 && dwTypeSize != 0 &&
+                !ValidateTypeInfo(szBytecode.substr(ullOffset, dwTypeSize)))
+                return std::format("The type information of function #{} is malformed.", dwProto);
+
+            ullOffset += dwTypeSize;
+        }
+
+        std::uint32_t dwCodeSize;
+        if (!ReadVarInt(szBytecode, ullOffset, dwCodeSize) ||
+            !Skip(szBytecode, ullOffset, static_cast<std::uint64_t>(dwCodeSize) * sizeof(std::uint32_t)))
+            return truncated();
+
+        std::uint32_t dwConstantCount;
+        if (!ReadVarInt(szBytecode, ullOffset, dwConstantCount))
+            return truncated();
+
+        constantKinds.clear();
+        for (std::uint32_t dwConstant = 0; dwConstant < dwConstantCount; dwConstant++) {
+            std::uint8_t bKind;
+            if (!ReadByte(szBytecode, ullOffset, bKind))
+                return truncated();
+
+            switch (bKind) {
+                case LBC_CONSTANT_NIL:
+                    break;
+                case LBC_CONSTANT_BOOLEAN:
+                    if (!Skip(szBytecode, ullOffset, 1))
+                        return truncated();
+                    break;
+                case LBC_CONSTANT_NUMBER:
+                    if (!Skip(szBytecode, ullOffset, sizeof(double)))
+                        return truncated();
+                    break;
+                case LBC_CONSTANT_VECTOR:
+                    if (!Skip(szBytecode, ullOffset, 4 * sizeof(float)))
+                        return truncated();
+                    break;
+                case LBC_CONSTANT_STRING:
+                    if (!ReadStringRef(szBytecode, ullOffset, dwStringCount))
+                        return truncated();
+                    break;
+                case LBC_CONSTANT_IMPORT: {
+                    std::uint32_t dwImportId;
+                    if (szBytecode.size() - ullOffset < sizeof(std::uint32_t))
+                        return truncated();
+
+                    std::memcpy(&dwImportId, szBytecode.data() + ullOffset, sizeof(std::uint32_t));
+                    ullOffset += sizeof(std::uint32_t);
+
+                    // An import is a chain of up to three lookups, each of them keyed by a constant.
+                    const auto dwLookupCount = dwImportId >> 30;
+                    if (dwLookupCount == 0)
+                        return std::format("Constant #{} of function #{} is an empty import.", dwConstant, dwProto);
+
+                    for (std::uint32_t dwLookup = 0; dwLookup < dwLookupCount; dwLookup++) {
+                        if (((dwImportId >> (20 - dwLookup * 10)) & 1023) >= dwConstantCount)
+                            return std::format("Constant #{} of function #{} imports an unknown constant.",
+                                               dwConstant, dwProto);
+                    }
+                    break;
+                }
+                case LBC_CONSTANT_TABLE: {
+                    std::uint32_t dwKeyCount;
+                    if (!ReadVarInt(szBytecode, ullOffset, dwKeyCount))
+                        return truncated();
+
+                    // The keys are set on the table as it is loaded, a nil key would raise an error mid-load.
+                    for (std::uint32_t dwKey = 0; dwKey < dwKeyCount; dwKey++) {
+                        std::uint32_t dwKeyConstant;
+                        if (!ReadVarInt(szBytecode, ullOffset, dwKeyConstant))
+                            return truncated();
+
+                        if (dwKeyConstant >= constantKinds.size() || constantKinds[dwKeyConstant] == LBC_CONSTANT_NIL)
+                            return std::format("Constant #{} of function #{} is a table with an invalid key.",
+                                               dwConstant, dwProto);
+                    }
+                    break;
+                }
+                case LBC_CONSTANT_CLOSURE: {
+                    std::uint32_t dwFunctionId;
+                    if (!ReadVarInt(szBytecode, ullOffset, dwFunctionId))
+                        return truncated();
+
+                    if (dwFunctionId >= dwProto)
+                        return std::format("Constant #{} of function #{} refers to an unknown function.", dwConstant,
+                                           dwProto);
+                    break;
+                }
+                default:
+                    return std::format("Constant #{} of function #{} is of unknown kind {}.", dwConstant, dwProto,
+                                       bKind);
+            }
+
+            constantKinds.push_back(bKind);
+        }
+
+        std::uint32_t dwChildCount;
+        if (!ReadVarInt(szBytecode, ullOffset, dwChildCount))
+            return truncated();
+
+        for (std::uint32_t dwChild = 0; dwChild < dwChildCount; dwChild++) {
+            std::uint32_t dwFunctionId;
+            if (!ReadVarInt(szBytecode, ullOffset, dwFunctionId))
+                return truncated();
+
+            if (dwFunctionId >= dwProto)
+                return std::format("Function #{} refers to an unknown function.", dwProto);
+        }
+
+        std::uint32_t dwLineDefined;
+        if (!ReadVarInt(szBytecode, ullOffset, dwLineDefined) ||
+            !ReadStringRef(szBytecode, ullOffset, dwStringCount))
+            return truncated();
+
+        std::uint8_t bHasLineInfo;
+        if (!ReadByte(szBytecode, ullOffset, bHasLineInfo))
+            return truncated();
+
+        if (bHasLineInfo) {
+            std::uint8_t bLineGapLog2;
+            if (!ReadByte(szBytecode, ullOffset, bLineGapLog2))
+                return truncated();
+
+            if (bLineGapLog2 >= 32)
+                return std::format("The line information of function #{} is malformed.", dwProto);
+
+            const std::uint64_t ullIntervals = dwCodeSize == 0 ? 0 : ((dwCodeSize - 1) >> bLineGapLog2) + 1;
+            if (!Skip(szBytecode, ullOffset, dwCodeSize) ||
+                !Skip(szBytecode, ullOffset, ullIntervals * sizeof(std::int32_t)))
+                return truncated();
+        }
+
+        std::uint8_t bHasDebugInfo;
+        if (!ReadByte(szBytecode, ullOffset, bHasDebugInfo))
+            return truncated();
+
+        if (bHasDebugInfo) {
+            std::uint32_t dwLocalCount;
+            if (!ReadVarInt(szBytecode, ullOffset, dwLocalCount))
+                return truncated();
+
+            for (std::uint32_t dwLocal = 0; dwLocal < dwLocalCount; dwLocal++) {
+                std::uint32_t dwStartPc, dwEndPc;
+                if (!ReadStringRef(szBytecode, ullOffset, dwStringCount) ||
+                    !ReadVarInt(szBytecode, ullOffset, dwStartPc) || !ReadVarInt(szBytecode, ullOffset, dwEndPc) ||
+                    !Skip(szBytecode, ullOffset, 1))
+                    return truncated();
+            }
+
+            std::uint32_t dwUpvalueNameCount;
+            if (!ReadVarInt(szBytecode, ullOffset, dwUpvalueNameCount))
+                return truncated();
+
+            if (dwUpvalueNameCount != bUpvalueCount)
+                return std::format("The debug information of function #{} is malformed.", dwProto);
+
+            for (std::uint32_t dwUpvalue = 0; dwUpvalue < dwUpvalueNameCount; dwUpvalue++) {
+                if (!ReadStringRef(szBytecode, ullOffset, dwStringCount))
+                    return truncated();
+            }
+        }
+    }
+
+    std::uint32_t dwMainId;
+    if (!ReadVarInt(szBytecode, ullOffset, dwMainId))
+        return truncated();
+
+    if (dwMainId >= dwProtoCount)
+        return "The bytecode refers to an unknown main function.";
+
+    if (ullOffset != szBytecode.size())
+        return std::format("The bytecode has {} unexpected trailing bytes.", szBytecode.size() - ullOffset);
+
+    return {};
+}
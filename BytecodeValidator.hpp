@@ -0,0 +1,15 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace RbxStu {
+    /// @brief Walks a Luau bytecode blob the way luau_load does, checking every read against the bounds of the blob and
+    /// every index against the table it refers to, without allocating any Luau objects.
+    /// @param szBytecode The bytecode, as emitted by the Luau compiler.
+    /// @return The reason the bytecode may not be loaded, or an empty std::optional if luau_load may be handed it.
+    /// @remarks luau_load trusts its input, it only asserts on what it reads, so truncated or corrupted bytecode would
+    /// read out of bounds instead of failing. The instructions themselves are not verified, bytecode is as trusted as
+    /// the source code it was compiled from.
+    std::optional<std::string> ValidateBytecode(std::string_view szBytecode);
+} // namespace RbxStu
@@ -4,11 +4,35 @@
 
 #include "Communication.hpp"
 #include <Windows.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "BytecodeValidator.hpp"
 #include "Logger.hpp"
 #include "Scheduler.hpp"
+#include "SchedulerManager.hpp"
+#include "TraceRecorder.hpp"
 
 std::shared_ptr<Communication> Communication::pInstance;
 
+/// @brief The amount of clients that may be connected to the pipe at once.
+constexpr DWORD PipeInstanceCount = 8;
+/// @brief The amount of threads handling the pipe. Reading is cheap, these only need to keep the clients flowing.
+constexpr DWORD PipeWorkerCount = 2;
+/// @brief The size of the buffers the system reserves for every pipe instance.
+constexpr DWORD PipeBufferSize = 64 * 1024;
+/// @brief The amount of bytes that may be waiting for a client to read them before further messages to it are dropped.
+constexpr std::size_t MaximumPendingWriteSize = 16 * 1024 * 1024;
+/// @brief The amount of requests a client may have waiting in the Scheduler's queues. Once it has this many, its
+/// following messages are left in the pipe until one of them leaves the queues, so that a client streaming scripts
+/// cannot crowd out the others.
+constexpr std::uint32_t MaximumQueuedRequestsPerClient = 4;
+
 std::shared_ptr<Communication> Communication::GetSingleton() {
     if (Communication::pInstance == nullptr)
         Communication::pInstance = std::make_shared<Communication>();
@@ -28,34 +52,500 @@ bool Communication::IsCodeGenerationEnabled() const { return this->m_bEnableCode
 void Communication::SetCodeGenerationEnabled(bool enableCodeGen) { this->m_bEnableCodeGen = enableCodeGen; }
 
 
-void Communication::HandlePipe(const std::string &szPipeName) {
+/// @brief Parses a directive a script may carry on its leading lines, such as "--!priority background" or
+/// "--!target server". Being comments, scripts carrying them run just as well anywhere else.
+/// @param szScript The script to parse the directive from.
+/// @param szName The name of the directive, such as "priority".
+/// @return The value of the directive, if the script carries it.
+static std::optional<std::string> ParseDirective(const std::string &szScript, const std::string_view szName) {
+    // Directives may only be found on the lines at the start of the script which are directives themselves, as Luau
+    // does with its own (--!strict, --!native...).
+    std::size_t ullLineStart = 0;
+    while (szScript.compare(ullLineStart, 3, "--!") == 0) {
+        const auto ullLineEnd = std::min(szScript.find_first_of("\r\n", ullLineStart), szScript.size());
+        const auto szLine = std::string_view{szScript}.substr(ullLineStart + 3, ullLineEnd - ullLineStart - 3);
+        if (szLine.starts_with(szName) && szLine.size() > szName.size() && szLine[szName.size()] == ' ')
+            return std::string{szLine.substr(szName.size() + 1)};
+
+        ullLineStart = szScript.find_first_not_of("\r\n", ullLineEnd);
+        if (ullLineStart == std::string::npos)
+            break;
+    }
+
+    return {};
+}
+
+/// @brief Parses the priority a script requests through the "--!priority interactive|background" directive.
+/// @return The priority requested by the script, if any.
+static std::optional<RbxStu::JobPriority> ParsePriorityDirective(const std::string &szScript) {
+    const auto szPriority = ParseDirective(szScript, "priority");
+    if (szPriority == "interactive")
+        return RbxStu::JobPriority::Interactive;
+    if (szPriority == "background")
+        return RbxStu::JobPriority::Background;
+
+    return {};
+}
+
+/// @brief Parses the time budget a script requests through the "--!budget <milliseconds>" directive. A script with a
+/// budget is preempted once it runs for longer than it on a single Scheduler step, and resumed on the next one.
+/// @return The budget requested by the script, if any.
+static std::optional<std::chrono::microseconds> ParseBudgetDirective(const std::string &szScript) {
+    const auto szBudget = ParseDirective(szScript, "budget");
+    if (!szBudget.has_value())
+        return {};
+
+    try {
+        if (const auto milliseconds = std::stod(szBudget.value()); milliseconds > 0.0 && milliseconds <= 60000.0)
+            return std::chrono::microseconds{static_cast<std::int64_t>(milliseconds * 1000.0)};
+    } catch (const std::exception &) {
+    }
+
+    Logger::GetSingleton()->PrintWarning(
+            RbxStu::Communication,
+            std::format("Invalid execution budget '{}', executing without a budget instead.", szBudget.value()));
+    return {};
+}
+
+/// @brief Parses the DataModel a script is to be executed on through the "--!target edit|client|server" directive.
+/// @return The DataModel type the script targets. Scripts that carry no valid target run on the client.
+static RBX::DataModelType ParseTargetDirective(const std::string &szScript) {
+    if (const auto szTarget = ParseDirective(szScript, "target"); szTarget.has_value()) {
+        if (const auto dataModelType = SchedulerManager::ParseTarget(szTarget.value()); dataModelType.has_value())
+            return dataModelType.value();
+
+        Logger::GetSingleton()->PrintWarning(
+                RbxStu::Communication,
+                std::format("Unknown execution target '{}', executing on the client instead.", szTarget.value()));
+    }
+
+    return RBX::DataModelType_PlayClient;
+}
+
+/// @brief Obtains the size of the directive lines at the start of a payload, including the line breaks after them.
+static std::size_t GetDirectivesSize(const std::string &szPayload) {
+    std::size_t ullLineStart = 0;
+    while (szPayload.compare(ullLineStart, 3, "--!") == 0) {
+        const auto ullLineEnd = szPayload.find('\n', ullLineStart);
+        if (ullLineEnd == std::string::npos)
+            return szPayload.size();
+
+        ullLineStart = ullLineEnd + 1;
+    }
+
+    return ullLineStart;
+}
+
+/// @brief Answers a request with a RequestResult message, if its client is listening.
+/// @param pChannel The channel to the client, or nullptr.
+/// @param ullRequestId The ID of the request.
+/// @param szRejection The reason the request was rejected, or an empty std::optional if it was accepted.
+/// @return The reason the request was rejected, as given.
+static std::optional<std::string> ReplyToRequest(const std::shared_ptr<RbxStu::ReplyChannel> &pChannel,
+                                                 const std::uint64_t ullRequestId,
+                                                 std::optional<std::string> szRejection) {
+    if (pChannel != nullptr)
+        pChannel->Send(RbxStu::Protocol::SerializeMessage(RbxStu::Protocol::MessageType::RequestResult, ullRequestId,
+                                                          szRejection.value_or("")));
+
+    return szRejection;
+}
+
+std::optional<std::string> Communication::SubmitMessage(RbxStu::Protocol::Message &message,
+                                                       const std::string &szClient,
+                                                       const std::chrono::steady_clock::time_point receivedAt,
+                                                       std::shared_ptr<RbxStu::ReplyChannel> pChannel) {
     const auto logger = Logger::GetSingleton();
-    const auto scheduler = Scheduler::GetSingleton();
-    DWORD Read{};
-    char BufferSize[999999];
-    std::string name = (R"(\\.\pipe\)" + szPipeName), Script{};
-    HANDLE hPipe = CreateNamedPipeA(name.c_str(), PIPE_ACCESS_DUPLEX | PIPE_TYPE_BYTE | PIPE_READMODE_BYTE, PIPE_WAIT,
-                                    1, 9999999, 9999999, NMPWAIT_USE_DEFAULT_WAIT, nullptr);
+    const auto type = message.header.type;
+    if (type == RbxStu::Protocol::MessageType::ExportTrace) {
+        if (message.header.flags != RbxStu::Protocol::MessageFlags::None)
+            return ReplyToRequest(pChannel, message.header.ullRequestId,
+                                  "The request sets flags this version of RbxStu does not understand.");
+
+        logger->PrintInformation(RbxStu::Communication,
+                                 std::format("Exporting the trace for request #{} of {}.", message.header.ullRequestId,
+                                             szClient));
+        if (pChannel != nullptr)
+            pChannel->Send(RbxStu::Protocol::SerializeMessage(RbxStu::Protocol::MessageType::TraceData,
+                                                              message.header.ullRequestId,
+                                                              TraceRecorder::GetSingleton()->ExportChromeTrace()));
 
+        return {};
+    }
+
+    if (type != RbxStu::Protocol::MessageType::ExecuteScript &&
+        type != RbxStu::Protocol::MessageType::ExecuteBytecode) {
+        logger->PrintWarning(RbxStu::Communication,
+                             std::format("Ignoring request #{} of {}, of unknown type {}.", message.header.ullRequestId,
+                                         szClient, static_cast<std::uint8_t>(type)));
+        return ReplyToRequest(pChannel, message.header.ullRequestId,
+                              "The request is of a type RbxStu does not accept.");
+    }
+
+    const auto bIsBytecode = type == RbxStu::Protocol::MessageType::ExecuteBytecode;
+    const auto bFlags = static_cast<std::uint8_t>(message.header.flags);
+    const auto bValidFlags =
+            static_cast<std::uint8_t>(bIsBytecode ? RbxStu::Protocol::MessageFlags::NativeCodeGen
+                                                  : RbxStu::Protocol::MessageFlags::None);
+    if ((bFlags & ~bValidFlags) != 0) {
+        logger->PrintWarning(RbxStu::Communication,
+                             std::format("Ignoring request #{} of {}, it sets flags this version does not understand.",
+                                         message.header.ullRequestId, szClient));
+        return ReplyToRequest(pChannel, message.header.ullRequestId,
+                              "The request sets flags this version of RbxStu does not understand.");
+    }
+
+    // Directives are read before the bytecode is stripped of them.
+    const auto dataModelType = ParseTargetDirective(message.szPayload);
+    const auto priority = ParsePriorityDirective(message.szPayload);
+    const auto budget = ParseBudgetDirective(message.szPayload);
+    if (bIsBytecode) {
+        const auto ullDirectivesSize = GetDirectivesSize(message.szPayload);
+        if (const auto szError =
+                    RbxStu::ValidateBytecode(std::string_view{message.szPayload}.substr(ullDirectivesSize));
+            szError.has_value()) {
+            logger->PrintError(RbxStu::Communication,
+                               std::format("Rejecting request #{} of {}, its bytecode is invalid: {}",
+                                           message.header.ullRequestId, szClient, szError.value()));
+            return ReplyToRequest(pChannel, message.header.ullRequestId, szError);
+        }
+
+        message.szPayload.erase(0, ullDirectivesSize);
+    }
+
+    const auto scheduler = SchedulerManager::GetSingleton()->GetScheduler(dataModelType).value();
     logger->PrintInformation(RbxStu::Communication,
-                             std::format("Created Named ANSI Pipe -> '{}' for obtaining Luau code.", name));
+                             std::format("Request #{} of {} received ({} bytes of {})! Scheduling on {}...",
+                                         message.header.ullRequestId, szClient, message.szPayload.size(),
+                                         bIsBytecode ? "bytecode" : "source",
+                                         RBX::DataModelTypeToString(dataModelType)));
+    if (!scheduler->IsInitialized())
+        logger->PrintWarning(RbxStu::Communication, "The targeted DataModel is not running yet, the script will be "
+                                                    "executed once its scheduler is initialized.");
+
+    // The script is handed over as-is, without copying it.
+    auto job = SchedulerJob(std::move(message.szPayload), priority);
+    job.luaJob.trace.received = receivedAt;
+    job.luaJob.budget = budget;
+
+    // The request is accepted before it is scheduled, so that its client hears of it before any of its events.
+    ReplyToRequest(pChannel, message.header.ullRequestId, {});
+    job.luaJob.ullReportId =
+            ExecutionReporter::GetSingleton()->Register(std::move(pChannel), message.header.ullRequestId);
+    if (bIsBytecode) {
+        job.luaJob.bIsBytecode = true;
+        job.luaJob.bNativeCodeGen =
+                (bFlags & static_cast<std::uint8_t>(RbxStu::Protocol::MessageFlags::NativeCodeGen)) != 0;
+    }
+
+    scheduler->ScheduleJob(std::move(job));
+    return {};
+}
+
+class PipeReplyChannel;
+
+/// @brief An instance of the Named Pipe, serving one client at a time.
+/// @remarks Only one read or connect is ever outstanding on an instance, so their completions are handled one after the
+/// other, even if by different worker threads, and require no locking. The same goes for reads resumed by the thread
+/// that dequeues a request of a client whose reads were paused. Writes are issued by whichever thread reports to the
+/// client, and may be outstanding alongside them.
+struct PipeInstance : std::enable_shared_from_this<PipeInstance> {
+    /// @brief The overlapped structure of reads and connects. Writes have their own.
+    OVERLAPPED overlapped;
+    HANDLE hPipe;
+    /// @brief True whilst waiting for a client to connect, false whilst reading from one.
+    bool bIsConnecting;
+    /// @brief Identifies the connected client, or zero if there is none. Only changed whilst holding writeMutex, so
+    /// that no write meant for a client may reach the next one.
+    std::atomic_uint64_t ullClientId;
+    /// @brief Guards issuing writes against the client disconnecting.
+    std::mutex writeMutex;
+    /// @brief The amount of bytes written to the instance that the client has not read yet.
+    std::atomic_size_t ullPendingWriteBytes;
+    /// @brief The channel to the connected client.
+    std::shared_ptr<PipeReplyChannel> pChannel;
+    RbxStu::Protocol::MessageReader reader;
+};
+
+/// @brief An overlapped write, which owns the message being written until it completes.
+struct PipeWrite {
+    OVERLAPPED overlapped;
+    std::string szMessage;
+};
+
+static std::atomic_uint64_t s_ullLastClientId;
+
+/// @brief Issues an overlapped write of a message to the given client, if it is still connected to the instance.
+/// @return False if the client has disconnected, or has too many bytes waiting to be read already.
+static bool BeginWrite(PipeInstance *pInstance, const std::uint64_t ullClientId, std::string szMessage) {
+    std::lock_guard lock{pInstance->writeMutex};
+    if (pInstance->ullClientId != ullClientId ||
+        pInstance->ullPendingWriteBytes + szMessage.size() > MaximumPendingWriteSize)
+        return false;
+
+    const auto dwSize = static_cast<DWORD>(szMessage.size());
+    const auto pWrite = new PipeWrite{{}, std::move(szMessage)};
+    pInstance->ullPendingWriteBytes += dwSize;
+    // Like reads, the completion is queued into the port even if the write completes right away.
+    if (!WriteFile(pInstance->hPipe, pWrite->szMessage.data(), dwSize, nullptr, &pWrite->overlapped) &&
+        GetLastError() != ERROR_IO_PENDING) {
+        pInstance->ullPendingWriteBytes -= dwSize;
+        delete pWrite;
+        return false;
+    }
+
+    return true;
+}
+
+static void BeginRead(PipeInstance *pInstance);
+
+/// @brief The channel to a client of the pipe, which writes to it for as long as it stays connected to its instance.
+/// @remarks Also keeps the client's requests that are waiting in the Scheduler's queues in check: reading from the
+/// client is paused whilst it has MaximumQueuedRequestsPerClient of them, and resumed once one leaves the queues.
+class PipeReplyChannel final : public RbxStu::ReplyChannel {
+    std::weak_ptr<PipeInstance> m_pInstance;
+    std::uint64_t m_ullClientId;
+    std::atomic_uint32_t m_dwQueuedRequests{0};
+    /// @brief Set whilst no read is issued on the instance as the client has too many requests queued. Whoever clears
+    /// it issues the next read.
+    std::atomic_bool m_bIsReadPaused{false};
+
+public:
+    PipeReplyChannel(std::weak_ptr<PipeInstance> pInstance, const std::uint64_t ullClientId)
+        : m_pInstance(std::move(pInstance)), m_ullClientId(ullClientId) {}
+
+    bool Send(std::string szMessage) override {
+        const auto pInstance = this->m_pInstance.lock();
+        return pInstance != nullptr && BeginWrite(pInstance.get(), this->m_ullClientId, std::move(szMessage));
+    }
+
+    [[nodiscard]] bool IsOpen() const override {
+        const auto pInstance = this->m_pInstance.lock();
+        return pInstance != nullptr && pInstance->ullClientId == this->m_ullClientId;
+    }
+
+    void OnRequestQueued() override { this->m_dwQueuedRequests++; }
+
+    void OnRequestDequeued() override {
+        if (--this->m_dwQueuedRequests >= MaximumQueuedRequestsPerClient || !this->m_bIsReadPaused.exchange(false))
+            return;
+
+        if (const auto pInstance = this->m_pInstance.lock(); pInstance != nullptr && this->IsOpen())
+            BeginRead(pInstance.get());
+    }
+
+    /// @brief Pauses reading from the client if it has too many requests queued.
+    /// @return True if reading has been paused, in which case the next read is issued once one of its requests leaves
+    /// the queues. False if the caller must issue the next read.
+    bool PauseReadingIfBusy() {
+        if (this->m_dwQueuedRequests < MaximumQueuedRequestsPerClient)
+            return false;
+
+        this->m_bIsReadPaused = true;
+        // A request may have left the queues before the flag was set, in which case nobody else would resume reading.
+        return this->m_dwQueuedRequests >= MaximumQueuedRequestsPerClient || !this->m_bIsReadPaused.exchange(false);
+    }
+};
+
+static void BeginConnect(PipeInstance *pInstance);
+
+/// @brief Disconnects the client of the given instance, and waits for the next one.
+static void Reconnect(PipeInstance *pInstance) {
+    {
+        std::lock_guard lock{pInstance->writeMutex};
+        pInstance->ullClientId = 0;
+        DisconnectNamedPipe(pInstance->hPipe);
+    }
+
+    pInstance->pChannel = nullptr;
+    BeginConnect(pInstance);
+}
+
+/// @brief Issues an overlapped read of the next bytes of the message being received, straight into its buffer.
+static void BeginRead(PipeInstance *pInstance) {
+    const auto [pBuffer, ullSize] = pInstance->reader.GetBuffer();
+    std::memset(&pInstance->overlapped, 0, sizeof(OVERLAPPED));
+    // The completion is queued into the port even if the read completes right away.
+    if (!ReadFile(pInstance->hPipe, pBuffer, static_cast<DWORD>(std::min<std::size_t>(ullSize, MAXDWORD)), nullptr,
+                  &pInstance->overlapped) &&
+        GetLastError() != ERROR_IO_PENDING) {
+        Logger::GetSingleton()->PrintInformation(
+                RbxStu::Communication, std::format("Client #{} disconnected.", pInstance->ullClientId.load()));
+        Reconnect(pInstance);
+    }
+}
+
+/// @brief Called once a client has connected to the given instance.
+static void OnConnected(PipeInstance *pInstance) {
+    const auto ullClientId = ++s_ullLastClientId;
+    pInstance->bIsConnecting = false;
+    pInstance->pChannel = std::make_shared<PipeReplyChannel>(pInstance->weak_from_this(), ullClientId);
+    pInstance->reader.Reset();
+    {
+        std::lock_guard lock{pInstance->writeMutex};
+        pInstance->ullClientId = ullClientId;
+    }
+
+    Logger::GetSingleton()->PrintInformation(RbxStu::Communication,
+                                             std::format("Client #{} connected! Awaiting Luau code!", ullClientId));
+    BeginRead(pInstance);
+}
+
+/// @brief Issues an overlapped wait for a client to connect to the given instance.
+static void BeginConnect(PipeInstance *pInstance) {
+    pInstance->bIsConnecting = true;
+    std::memset(&pInstance->overlapped, 0, sizeof(OVERLAPPED));
+    if (ConnectNamedPipe(pInstance->hPipe, &pInstance->overlapped))
+        return;
+
+    switch (GetLastError()) {
+        case ERROR_IO_PENDING:
+            break;
+        case ERROR_PIPE_CONNECTED:
+            // The client connected before we began waiting for it, no completion will be queued for it.
+            OnConnected(pInstance);
+            break;
+        default:
+            Logger::GetSingleton()->PrintError(
+                    RbxStu::Communication,
+                    std::format("Failed to wait for a client on a Named Pipe instance! Error: {}", GetLastError()));
+            break;
+    }
+}
+
+/// @brief Handles the completions of the operations issued on the pipe instances, until the port is closed.
+static void PipeWorker(const HANDLE hPort) {
+    const auto logger = Logger::GetSingleton();
+    while (true) {
+        DWORD dwTransferred{};
+        ULONG_PTR ullKey{};
+        OVERLAPPED *pOverlapped{};
+        const auto bSucceeded = GetQueuedCompletionStatus(hPort, &dwTransferred, &ullKey, &pOverlapped, INFINITE);
+        if (pOverlapped == nullptr) {
+            logger->PrintError(RbxStu::Communication,
+                               std::format("Failed to dequeue a pipe completion! Error: {}", GetLastError()));
+            return;
+        }
+
+        const auto pInstance = reinterpret_cast<PipeInstance *>(ullKey);
+        if (pOverlapped != &pInstance->overlapped) {
+            // A write has completed, whether the client has read it or has gone away.
+            const auto pWrite = CONTAINING_RECORD(pOverlapped, PipeWrite, overlapped);
+            pInstance->ullPendingWriteBytes -= pWrite->szMessage.size();
+            delete pWrite;
+            continue;
+        }
 
-    logger->PrintInformation(RbxStu::Communication, "Connecting to Named Pipe...");
-    ConnectNamedPipe(hPipe, nullptr);
+        if (pInstance->bIsConnecting) {
+            if (bSucceeded)
+                OnConnected(pInstance);
+            else
+                Reconnect(pInstance);
 
-    logger->PrintInformation(RbxStu::Communication, "Connected! Awaiting Luau code!");
-    while (hPipe != INVALID_HANDLE_VALUE && ReadFile(hPipe, BufferSize, sizeof(BufferSize) - 1, &Read, nullptr)) {
-        if (GetLastError() == ERROR_IO_PENDING) {
-            logger->PrintError(RbxStu::Communication, "RbxStu does not handle asynchronous IO requests. Pipe "
-                                                      "requests must be synchronous (This should not happen)");
-            _mm_pause();
             continue;
         }
-        BufferSize[Read] = '\0';
-        Script += BufferSize;
 
-        logger->PrintInformation(RbxStu::Communication, "Pipe request received! Scheduling...");
-        scheduler->ScheduleJob(SchedulerJob(Script));
-        Script.clear();
+        if (!bSucceeded) {
+            logger->PrintInformation(RbxStu::Communication,
+                                     std::format("Client #{} disconnected.", pInstance->ullClientId.load()));
+            Reconnect(pInstance);
+            continue;
+        }
+
+        // The reads of a client are issued one after the other, so its messages are processed in the order it sent
+        // them, whilst those of other clients are processed concurrently by the other workers.
+        switch (pInstance->reader.OnRead(dwTransferred)) {
+            case RbxStu::Protocol::ReadStatus::Success:
+                Communication::SubmitMessage(pInstance->reader.GetReceivedMessage(),
+                                             std::format("pipe client #{}", pInstance->ullClientId.load()),
+                                             std::chrono::steady_clock::now(), pInstance->pChannel);
+                if (pInstance->pChannel->PauseReadingIfBusy())
+                    continue;
+
+                break;
+            case RbxStu::Protocol::ReadStatus::Malformed:
+                logger->PrintError(RbxStu::Communication,
+                                   std::format("Client #{} sent a malformed message header! Dropping it, as the "
+                                               "stream cannot be resynchronized.",
+                                               pInstance->ullClientId.load()));
+                Reconnect(pInstance);
+                continue;
+            default:
+                break;
+        }
+
+        BeginRead(pInstance);
+    }
+}
+
+void Communication::HandlePipe(const std::string &szPipeName) {
+    const auto logger = Logger::GetSingleton();
+    const std::string name = (R"(\\.\pipe\)" + szPipeName);
+
+    const auto hPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 0);
+    if (hPort == nullptr) {
+        logger->PrintError(RbxStu::Communication,
+                           std::format("Failed to create the pipe completion port! Error: {}", GetLastError()));
+        return;
+    }
+
+    // The channels to the clients refer to their instances weakly, as they may outlive them.
+    std::vector<std::shared_ptr<PipeInstance>> instances;
+    for (DWORD dwInstance = 0; dwInstance < PipeInstanceCount; dwInstance++) {
+        // Only the first instance may create the pipe, should another process own the name we must not serve it.
+        const auto hPipe = CreateNamedPipeA(
+                name.c_str(),
+                PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | (instances.empty() ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0),
+                PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, PipeInstanceCount,
+                PipeBufferSize, PipeBufferSize, NMPWAIT_USE_DEFAULT_WAIT, nullptr);
+
+        if (hPipe == INVALID_HANDLE_VALUE) {
+            logger->PrintError(RbxStu::Communication,
+                               std::format("Failed to create Named Pipe '{}'! Error: {}", name, GetLastError()));
+            break;
+        }
+
+        auto pInstance = std::make_shared<PipeInstance>();
+        pInstance->hPipe = hPipe;
+        // The instance is the completion key, as writes complete with their own overlapped structures. An instance
+        // that is not associated with the port never completes any I/O, so it is not served at all.
+        if (CreateIoCompletionPort(hPipe, hPort, reinterpret_cast<ULONG_PTR>(pInstance.get()), 0) == nullptr) {
+            logger->PrintError(RbxStu::Communication,
+                               std::format("Failed to associate a pipe instance with the completion port! Error: {}",
+                                           GetLastError()));
+            CloseHandle(hPipe);
+            continue;
+        }
+
+        instances.emplace_back(std::move(pInstance));
+    }
+
+    if (instances.empty()) {
+        CloseHandle(hPort);
+        return;
     }
+
+    logger->PrintInformation(RbxStu::Communication,
+                             std::format("Created Named ANSI Pipe -> '{}' with {} instances for obtaining Luau code.",
+                                         name, instances.size()));
+
+    for (const auto &pInstance: instances)
+        BeginConnect(pInstance.get());
+
+    // The calling thread serves as a worker as well.
+    std::vector<std::thread> workers;
+    for (DWORD dwWorker = 1; dwWorker < PipeWorkerCount; dwWorker++)
+        workers.emplace_back(PipeWorker, hPort);
+
+    PipeWorker(hPort);
+    for (auto &worker: workers)
+        worker.join();
+
+    for (const auto &pInstance: instances) {
+        std::lock_guard lock{pInstance->writeMutex};
+        pInstance->ullClientId = 0;
+        CloseHandle(pInstance->hPipe);
+    }
+
+    CloseHandle(hPort);
 }
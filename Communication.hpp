@@ -1,10 +1,15 @@
 //
 // Created by Yoru on 8/16/2024.
 //
-
+#pragma once
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <string>
 
+#include "CommunicationProtocol.hpp"
+#include "ExecutionReporter.hpp"
+
 class Communication final {
     static std::shared_ptr<Communication> pInstance;
     bool m_bIsUnsafe = false;
@@ -28,7 +33,22 @@ public:
     bool IsCodeGenerationEnabled() const;
     void SetCodeGenerationEnabled(bool enableCodeGen);
 
+    /// @brief Acts upon a message received from a client, on any of the transports RbxStu serves.
+    /// @param message The message received. Its payload may be moved out of it.
+    /// @param szClient Describes the client that sent the message, for logging.
+    /// @param receivedAt When the message finished arriving.
+    /// @param pChannel The channel to answer the request and report what happens to it on, or nullptr if the client is
+    /// not listening.
+    /// @return The reason the message was rejected, or an empty std::optional if it was accepted.
+    static std::optional<std::string> SubmitMessage(RbxStu::Protocol::Message &message, const std::string &szClient,
+                                                    std::chrono::steady_clock::time_point receivedAt,
+                                                    std::shared_ptr<RbxStu::ReplyChannel> pChannel);
+
     /// @brief Swiftly handles the pipe used for executing Luau code.
     /// @param szPipeName The name of the pipe as a constant std::string.
+    /// @remarks Serves several clients at once through overlapped I/O on a completion port, waiting for a new client
+    /// whenever one disconnects. A client may only have a few requests waiting in the Scheduler's queues at once,
+    /// its following messages wait in the pipe until one of them runs, so that no client may crowd out the others.
+    /// Does not return unless the pipe cannot be served anymore.
     static void HandlePipe(const std::string &szPipeName);
 };
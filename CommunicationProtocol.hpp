@@ -0,0 +1,335 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <lz4frame.h>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace RbxStu::Protocol {
+    /// @brief Marks the start of every message, "RSTU" in little-endian.
+    constexpr std::uint32_t MessageMagic = 0x55545352;
+    /// @brief The largest payload a message may carry. Anything larger is considered malformed.
+    constexpr std::uint32_t MaximumPayloadSize = 256 * 1024 * 1024;
+
+    enum class MessageType : std::uint8_t {
+        /// @brief Sent by clients, the payload is Luau source code to execute.
+        ExecuteScript = 1,
+        /// @brief Sent by RbxStu in reply to a request, carrying its request ID. The payload is empty if the request
+        /// was accepted, else it is the reason it was rejected.
+        RequestResult = 2,
+        /// @brief Sent by RbxStu, the payload is output written to the RbxStu console.
+        ConsoleOutput = 3,
+        /// @brief Sent by clients, the payload is Luau bytecode to execute, as emitted by the Luau compiler. It may be
+        /// preceded by the same "--!" directive lines scripts may carry, each ending on a line feed.
+        ExecuteBytecode = 4,
+        /// @brief Sent by RbxStu, the payload is a batch of ExecutionEvent records on the requests of the client, each
+        /// being an ExecutionEventHeader followed by its data. The message itself carries no request ID.
+        ExecutionEvents = 5,
+        /// @brief Sent by clients, the payload is empty. Answered with a TraceData message carrying its request ID.
+        ExportTrace = 6,
+        /// @brief Sent by RbxStu in reply to ExportTrace, the payload is the spans recorded so far as a Chrome trace,
+        /// in the JSON format of the Trace Event Format. Spans are only recorded whilst tracing is enabled.
+        TraceData = 7,
+    };
+
+    /// @brief Modifies how the payload of a message is to be interpreted. Bits which are not defined are reserved and
+    /// must be zero, as must those not defined for the type of the message.
+    enum class MessageFlags : std::uint8_t {
+        None = 0,
+        /// @brief Valid on ExecuteBytecode. Compiles the bytecode into native code, if native code generation is
+        /// enabled. Bytecode is otherwise only interpreted, whilst source code is always compiled into native code
+        /// when enabled.
+        NativeCodeGen = 1 << 0,
+        /// @brief Valid on every message. The payload is an LZ4 frame, dwLength being its compressed size, which is
+        /// decompressed as it arrives. Decompressed payloads are capped to MaximumPayloadSize as well. RbxStu versions
+        /// that predate this flag reject such messages, clients may fall back to sending them uncompressed.
+        Lz4Compressed = 1 << 1,
+    };
+
+    /// @brief Obtains whether the given flag is set.
+    constexpr bool HasFlag(const MessageFlags flags, const MessageFlags flag) {
+        return (static_cast<std::uint8_t>(flags) & static_cast<std::uint8_t>(flag)) != 0;
+    }
+
+    /// @brief The header every message begins with, followed by dwLength bytes of payload. Every field is
+    /// little-endian.
+    struct MessageHeader {
+        /// @brief Must be MessageMagic.
+        std::uint32_t dwMagic;
+        /// @brief The length of the payload that follows the header, in bytes.
+        std::uint32_t dwLength;
+        /// @brief Chosen by the client to tell its requests apart. RbxStu does not interpret it.
+        std::uint64_t ullRequestId;
+        MessageType type;
+        MessageFlags flags;
+        std::uint16_t wReserved;
+        std::uint32_t dwReserved;
+    };
+    static_assert(sizeof(MessageHeader) == 24, "The layout of MessageHeader is part of the protocol!");
+
+    /// @brief What happened to a request that was accepted. Every request sees at most one Compiled and one Started
+    /// event, and ends on either an Error or a Completed event, after which no further events are sent on it.
+    enum class ExecutionEventKind : std::uint8_t {
+        /// @brief The code has been compiled and loaded. The data is empty.
+        Compiled = 1,
+        /// @brief The code has begun running. The data is empty.
+        Started = 2,
+        /// @brief The code has called print. The data is the line printed.
+        Output = 3,
+        /// @brief The code has called warn. The data is the line printed.
+        Warning = 4,
+        /// @brief The code failed to compile or load, or raised an error whilst running. The data is the error, with a
+        /// traceback if it was raised whilst running.
+        Error = 5,
+        /// @brief The code has returned. The data is empty.
+        Completed = 6,
+    };
+
+    /// @brief The header every record of an ExecutionEvents message begins with, followed by dwLength bytes of data.
+    /// Every field is little-endian.
+    struct ExecutionEventHeader {
+        /// @brief The ID of the request the event happened to, as given by the client.
+        std::uint64_t ullRequestId;
+        std::uint32_t dwLength;
+        ExecutionEventKind kind;
+        std::uint8_t bReserved;
+        std::uint16_t wReserved;
+    };
+    static_assert(sizeof(ExecutionEventHeader) == 16, "The layout of ExecutionEventHeader is part of the protocol!");
+
+    /// @brief Appends a record to the payload of an ExecutionEvents message.
+    /// @param szBatch The payload to append the record to.
+    /// @param ullRequestId The ID of the request the event happened to.
+    /// @param kind What happened to the request.
+    /// @param szData The data of the event.
+    inline void AppendExecutionEvent(std::string &szBatch, const std::uint64_t ullRequestId,
+                                     const ExecutionEventKind kind, const std::string_view szData) {
+        const ExecutionEventHeader header{ullRequestId, static_cast<std::uint32_t>(szData.size()), kind, 0, 0};
+        szBatch.append(reinterpret_cast<const char *>(&header), sizeof(ExecutionEventHeader));
+        szBatch.append(szData);
+    }
+
+    struct Message {
+        MessageHeader header;
+        /// @brief The payload of the message. Scripts are moved out of it into their job, so that they are not copied,
+        /// which leaves the next message to allocate its payload anew.
+        std::string szPayload;
+    };
+
+    enum class ReadStatus : std::uint8_t {
+        /// @brief A whole message was read.
+        Success,
+        /// @brief More bytes are needed before the message is whole.
+        Incomplete,
+        /// @brief The header is not valid, or the payload could not be decompressed, the stream cannot be trusted to be
+        /// in sync anymore.
+        Malformed,
+    };
+
+    /// @brief Decompresses an LZ4 frame as it arrives, chunk by chunk, into a buffer of the caller.
+    /// @remarks The output buffer grows geometrically, up to a limit, so that a small frame may not expand into more
+    /// memory than any message is allowed to take.
+    class PayloadDecompressor final {
+        LZ4F_dctx *m_pContext = nullptr;
+        /// @brief The amount of bytes decompressed into the output so far. The output may be larger, its tail being
+        /// unused.
+        std::size_t m_ullDecompressed = 0;
+        std::size_t m_ullLimit = 0;
+        bool m_bIsFinished = false;
+
+    public:
+        PayloadDecompressor() { LZ4F_createDecompressionContext(&this->m_pContext, LZ4F_VERSION); }
+        ~PayloadDecompressor() { LZ4F_freeDecompressionContext(this->m_pContext); }
+        PayloadDecompressor(const PayloadDecompressor &) = delete;
+        PayloadDecompressor &operator=(const PayloadDecompressor &) = delete;
+
+        /// @brief Readies the decompressor for a new frame.
+        /// @param szOutput The buffer to decompress into.
+        /// @param ullSizeHint The size the output is expected to take, which is reserved upfront.
+        /// @param ullLimit The largest the output may grow to.
+        void Begin(std::string &szOutput, const std::size_t ullSizeHint, const std::size_t ullLimit) {
+            LZ4F_resetDecompressionContext(this->m_pContext);
+            this->m_ullDecompressed = 0;
+            this->m_ullLimit = ullLimit;
+            this->m_bIsFinished = false;
+            szOutput.resize(std::min(std::max<std::size_t>(ullSizeHint, 64 * 1024), ullLimit));
+        }
+
+        /// @brief Decompresses the next chunk of the frame.
+        /// @return False if the frame is corrupted, continues past its end, or decompresses past the limit.
+        bool Feed(std::string_view szChunk, std::string &szOutput) {
+            auto bIsOutputFull = false;
+            while (!szChunk.empty() || bIsOutputFull) {
+                if (this->m_bIsFinished || this->m_pContext == nullptr)
+                    return szChunk.empty();
+
+                if (this->m_ullDecompressed == szOutput.size()) {
+                    if (szOutput.size() >= this->m_ullLimit)
+                        return false;
+
+                    szOutput.resize(std::min(std::max<std::size_t>(szOutput.size() * 2, 64 * 1024), this->m_ullLimit));
+                }
+
+                auto ullOutputSize = szOutput.size() - this->m_ullDecompressed;
+                auto ullInputSize = szChunk.size();
+                const auto ullHint = LZ4F_decompress(this->m_pContext, szOutput.data() + this->m_ullDecompressed,
+                                                     &ullOutputSize, szChunk.data(), &ullInputSize, nullptr);
+                if (LZ4F_isError(ullHint))
+                    return false;
+
+                this->m_ullDecompressed += ullOutputSize;
+                szChunk.remove_prefix(ullInputSize);
+                this->m_bIsFinished = ullHint == 0;
+                // A full output may mean that the decompressor holds more for us, which is only handed out once
+                // there is room for it.
+                bIsOutputFull = this->m_ullDecompressed == szOutput.size();
+            }
+
+            return true;
+        }
+
+        /// @brief Completes the frame, trimming the output down to what has been decompressed.
+        /// @return False if the frame has not ended.
+        bool End(std::string &szOutput) {
+            szOutput.resize(this->m_ullDecompressed);
+            return this->m_bIsFinished;
+        }
+    };
+
+    /// @brief Reassembles messages out of a stream, regardless of how it happens to be split up, without buffering
+    /// anything twice. Bytes are read straight into the header or payload of the message being received, wherever
+    /// GetBuffer points at, whilst compressed payloads are read in chunks and decompressed into the payload as they
+    /// arrive.
+    /// @remarks Suited for both blocking and overlapped reads, as it never performs the reads itself. Not thread-safe,
+    /// every stream must have its own reader.
+    class MessageReader final {
+        /// @brief The size of the chunks compressed payloads are read in.
+        static constexpr std::size_t CompressedChunkSize = 64 * 1024;
+
+        Message m_message{};
+        /// @brief The amount of bytes received of the part of the message currently being read, as sent over the wire.
+        std::size_t m_ullReceived = 0;
+        bool m_bIsReadingPayload = false;
+        bool m_bIsCompressed = false;
+        std::string m_szCompressedChunk;
+        PayloadDecompressor m_decompressor;
+
+    public:
+        /// @brief Obtains where the next bytes of the stream must be read into.
+        /// @return The buffer to read into, and the amount of bytes it may take. Never empty.
+        [[nodiscard]] std::pair<void *, std::size_t> GetBuffer() {
+            if (this->m_bIsReadingPayload && this->m_bIsCompressed) {
+                const std::size_t ullRemaining = this->m_message.header.dwLength - this->m_ullReceived;
+                return {this->m_szCompressedChunk.data(), std::min(this->m_szCompressedChunk.size(), ullRemaining)};
+            }
+
+            if (this->m_bIsReadingPayload)
+                return {this->m_message.szPayload.data() + this->m_ullReceived,
+                        this->m_message.szPayload.size() - this->m_ullReceived};
+
+            return {reinterpret_cast<char *>(&this->m_message.header) + this->m_ullReceived,
+                    sizeof(MessageHeader) - this->m_ullReceived};
+        }
+
+        /// @brief Accounts for bytes that have been read into the buffer obtained from GetBuffer.
+        /// @param ullRead The amount of bytes read.
+        /// @return Success once a whole message has been received, which is available through GetReceivedMessage until
+        /// the next call; Incomplete if more bytes are needed; Malformed if the header is not valid or the payload
+        /// cannot be decompressed.
+        ReadStatus OnRead(const std::size_t ullRead) {
+            if (this->m_bIsReadingPayload && this->m_bIsCompressed &&
+                !this->m_decompressor.Feed({this->m_szCompressedChunk.data(), ullRead}, this->m_message.szPayload))
+                return ReadStatus::Malformed;
+
+            this->m_ullReceived += ullRead;
+            if (!this->m_bIsReadingPayload) {
+                if (this->m_ullReceived < sizeof(MessageHeader))
+                    return ReadStatus::Incomplete;
+
+                auto &header = this->m_message.header;
+                if (header.dwMagic != MessageMagic || header.dwLength > MaximumPayloadSize)
+                    return ReadStatus::Malformed;
+
+                this->m_ullReceived = 0;
+                this->m_bIsReadingPayload = true;
+                this->m_bIsCompressed = HasFlag(header.flags, MessageFlags::Lz4Compressed);
+                if (this->m_bIsCompressed) {
+                    // Whoever handles the message receives it decompressed, so it must not see the flag.
+                    header.flags = static_cast<MessageFlags>(static_cast<std::uint8_t>(header.flags) &
+                                                             ~static_cast<std::uint8_t>(MessageFlags::Lz4Compressed));
+                    this->m_szCompressedChunk.resize(CompressedChunkSize);
+                    this->m_decompressor.Begin(this->m_message.szPayload, std::size_t{header.dwLength} * 4,
+                                               MaximumPayloadSize);
+                } else {
+                    this->m_message.szPayload.resize(header.dwLength);
+                }
+            }
+
+            if (this->m_ullReceived < this->m_message.header.dwLength)
+                return ReadStatus::Incomplete;
+
+            this->m_ullReceived = 0;
+            this->m_bIsReadingPayload = false;
+            if (this->m_bIsCompressed && !this->m_decompressor.End(this->m_message.szPayload))
+                return ReadStatus::Malformed;
+
+            return ReadStatus::Success;
+        }
+
+        /// @brief Obtains the last message received. Its payload may be moved out of it.
+        [[nodiscard]] Message &GetReceivedMessage() { return this->m_message; }
+
+        /// @brief Discards the message being received, readying the reader for a new stream.
+        void Reset() {
+            this->m_ullReceived = 0;
+            this->m_bIsReadingPayload = false;
+        }
+    };
+
+    /// @brief Parses a message that has been received whole, such as on a WebSocket frame.
+    /// @param szFrame The header of the message followed by its payload, and nothing else.
+    /// @param message The message to parse into.
+    /// @return Success, or Malformed if the header is not valid, does not match the size of the frame or the payload
+    /// cannot be decompressed.
+    inline ReadStatus ParseMessage(const std::string_view szFrame, Message &message) {
+        if (szFrame.size() < sizeof(MessageHeader))
+            return ReadStatus::Malformed;
+
+        std::memcpy(&message.header, szFrame.data(), sizeof(MessageHeader));
+        if (message.header.dwMagic != MessageMagic || message.header.dwLength > MaximumPayloadSize ||
+            message.header.dwLength != szFrame.size() - sizeof(MessageHeader))
+            return ReadStatus::Malformed;
+
+        const auto szPayload = szFrame.substr(sizeof(MessageHeader));
+        if (!HasFlag(message.header.flags, MessageFlags::Lz4Compressed)) {
+            message.szPayload.assign(szPayload);
+            return ReadStatus::Success;
+        }
+
+        message.header.flags = static_cast<MessageFlags>(static_cast<std::uint8_t>(message.header.flags) &
+                                                         ~static_cast<std::uint8_t>(MessageFlags::Lz4Compressed));
+        PayloadDecompressor decompressor;
+        decompressor.Begin(message.szPayload, szPayload.size() * 4, MaximumPayloadSize);
+        if (!decompressor.Feed(szPayload, message.szPayload) || !decompressor.End(message.szPayload))
+            return ReadStatus::Malformed;
+
+        return ReadStatus::Success;
+    }
+
+    /// @brief Serializes a message, ready to be written into a stream or sent as a frame.
+    /// @param type The type of the message.
+    /// @param ullRequestId The request the message relates to, or zero if none.
+    /// @param szPayload The payload of the message.
+    inline std::string SerializeMessage(const MessageType type, const std::uint64_t ullRequestId,
+                                        const std::string_view szPayload) {
+        const MessageHeader header{MessageMagic, static_cast<std::uint32_t>(szPayload.size()), ullRequestId, type,
+                                   MessageFlags::None, 0, 0};
+        std::string szMessage;
+        szMessage.reserve(sizeof(MessageHeader) + szPayload.size());
+        szMessage.append(reinterpret_cast<const char *>(&header), sizeof(MessageHeader));
+        szMessage.append(szPayload);
+        return szMessage;
+    }
+} // namespace RbxStu::Protocol
@@ -0,0 +1,194 @@
+#include "CoverageCollector.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <fstream>
+#include <vector>
+
+#include "Logger.hpp"
+
+std::shared_ptr<CoverageCollector> CoverageCollector::pInstance;
+
+static std::atomic_bool s_bIsEnabled{false};
+
+/// @brief Obtains the name of the file a source is dumped into, and which its coverage refers to.
+static std::string GetSourceName(const std::uint64_t ullSourceHash) {
+    return std::format("RbxStuV2-{:016x}.luau", ullSourceHash);
+}
+
+std::shared_ptr<CoverageCollector> CoverageCollector::GetSingleton() {
+    if (CoverageCollector::pInstance == nullptr)
+        CoverageCollector::pInstance = std::make_shared<CoverageCollector>();
+
+    return CoverageCollector::pInstance;
+}
+
+bool CoverageCollector::IsEnabled() { return s_bIsEnabled.load(std::memory_order_relaxed); }
+
+void CoverageCollector::SetEnabled(const bool bEnabled) {
+    CoverageCollector::GetSingleton();
+    s_bIsEnabled.store(bEnabled, std::memory_order_relaxed);
+}
+
+CoverageCollector::TrackedChunk CoverageCollector::Track(lua_State *L, const std::string_view szSource) {
+    auto ullSourceHash = static_cast<std::uint64_t>(std::hash<std::string_view>{}(szSource));
+    {
+        std::lock_guard lock{this->m_mutex};
+        // A source whose hash is taken by a different one moves on to the next free hash, so that two scripts are
+        // never merged into one.
+        auto source = this->m_mapSources.find(ullSourceHash);
+        while (source != this->m_mapSources.end() && source->second.szSource != szSource)
+            source = this->m_mapSources.find(++ullSourceHash);
+
+        if (source == this->m_mapSources.end())
+            this->m_mapSources[ullSourceHash].szSource = szSource;
+    }
+
+    return {lua_ref(L, -1), ullSourceHash};
+}
+
+void CoverageCollector::Collect(lua_State *L, const TrackedChunk &chunk) {
+    lua_getref(L, chunk.dwReference);
+    lua_unref(L, chunk.dwReference);
+    if (!lua_isLfunction(L, -1)) {
+        lua_pop(L, 1);
+        return;
+    }
+
+    std::lock_guard lock{this->m_mutex};
+    // The coverage may have been cleared whilst the function ran, in which case its run is not counted.
+    const auto coveredSource = this->m_mapSources.find(chunk.ullSourceHash);
+    if (coveredSource == this->m_mapSources.end()) {
+        lua_pop(L, 1);
+        return;
+    }
+
+    auto &source = coveredSource->second;
+    source.ullRuns++;
+
+    // Called for the function and every function nested in it. Lines holding no code have -1 hits.
+    lua_getcoverage(L, -1, &source,
+                    [](void *context, const char *function, const int linedefined, const int depth, const int *hits,
+                       const std::size_t size) {
+                        auto &source = *static_cast<CoveredSource *>(context);
+                        auto szName = depth == 0 ? std::string{"<main>"}
+                                                 : std::format("{}:{}", function != nullptr ? function : "<anonymous>",
+                                                               linedefined);
+
+                        bool bIsEntryCounted = false;
+                        for (std::size_t i = 0; i < size; i++) {
+                            if (hits[i] == -1)
+                                continue;
+
+                            // The first line holding code is run once per call of the function.
+                            if (!bIsEntryCounted) {
+                                source.mapFunctions[{linedefined, std::move(szName)}] += hits[i];
+                                bIsEntryCounted = true;
+                            }
+
+                            source.mapLines[static_cast<int>(i)] += hits[i];
+                        }
+                    });
+
+    lua_pop(L, 1);
+}
+
+void CoverageCollector::Clear() {
+    std::lock_guard lock{this->m_mutex};
+    this->m_mapSources.clear();
+}
+
+std::string CoverageCollector::ExportLcov(const std::filesystem::path &sourceDirectory) {
+    std::lock_guard lock{this->m_mutex};
+    std::string szTracefile = "TN:\n";
+    for (const auto &[ullSourceHash, source]: this->m_mapSources) {
+        if (source.ullRuns == 0)
+            continue;
+
+        szTracefile += std::format("SF:{}\n", (sourceDirectory / GetSourceName(ullSourceHash)).string());
+        for (const auto &[function, ullHits]: source.mapFunctions)
+            szTracefile += std::format("FN:{},{}\nFNDA:{},{}\n", function.first, function.second, ullHits,
+                                       function.second);
+
+        szTracefile += std::format(
+                "FNF:{}\nFNH:{}\n", source.mapFunctions.size(),
+                std::ranges::count_if(source.mapFunctions, [](const auto &function) { return function.second != 0; }));
+
+        for (const auto &[dwLine, ullHits]: source.mapLines)
+            szTracefile += std::format("DA:{},{}\n", dwLine, ullHits);
+
+        szTracefile += std::format(
+                "LF:{}\nLH:{}\nend_of_record\n", source.mapLines.size(),
+                std::ranges::count_if(source.mapLines, [](const auto &line) { return line.second != 0; }));
+    }
+
+    return szTracefile;
+}
+
+std::string CoverageCollector::ExportJson() {
+    std::lock_guard lock{this->m_mutex};
+    std::string szDocument = "{\"files\":[";
+    bool bIsFirstSource = true;
+    for (const auto &[ullSourceHash, source]: this->m_mapSources) {
+        if (source.ullRuns == 0)
+            continue;
+
+        // Function names are Luau identifiers, nothing in them needs to be escaped.
+        szDocument += std::format("{}{{\"name\":\"{}\",\"runs\":{},\"functions\":[", bIsFirstSource ? "" : ",",
+                                  GetSourceName(ullSourceHash), source.ullRuns);
+        bool bIsFirst = true;
+        for (const auto &[function, ullHits]: source.mapFunctions) {
+            szDocument += std::format("{}{{\"name\":\"{}\",\"line\":{},\"hits\":{}}}", bIsFirst ? "" : ",",
+                                      function.second, function.first, ullHits);
+            bIsFirst = false;
+        }
+
+        szDocument += "],\"lines\":{";
+        bIsFirst = true;
+        for (const auto &[dwLine, ullHits]: source.mapLines) {
+            szDocument += std::format("{}\"{}\":{}", bIsFirst ? "" : ",", dwLine, ullHits);
+            bIsFirst = false;
+        }
+
+        szDocument += "}}";
+        bIsFirstSource = false;
+    }
+
+    szDocument += "]}\n";
+    return szDocument;
+}
+
+bool CoverageCollector::DumpToFile(const std::filesystem::path &path, const RbxStu::CoverageFormat format) {
+    const auto sourceDirectory = path.parent_path() / (path.stem().string() + "-Sources");
+    std::vector<std::pair<std::uint64_t, std::string>> sources;
+    {
+        std::lock_guard lock{this->m_mutex};
+        for (const auto &[ullSourceHash, source]: this->m_mapSources) {
+            if (source.ullRuns != 0)
+                sources.emplace_back(ullSourceHash, source.szSource);
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(sourceDirectory, error);
+    if (error)
+        return false;
+
+    for (const auto &[ullSourceHash, szSource]: sources) {
+        std::ofstream file(sourceDirectory / GetSourceName(ullSourceHash),
+                           std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!file.is_open() || !(file << szSource))
+            return false;
+    }
+
+    std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    file << (format == RbxStu::CoverageFormat::Lcov ? this->ExportLcov(sourceDirectory) : this->ExportJson());
+    Logger::GetSingleton()->PrintInformation(
+            RbxStu::Coverage,
+            std::format("Dumped the coverage of {} sources into '{}'.", sources.size(), path.string()));
+    return file.good();
+}
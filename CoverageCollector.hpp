@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "lua.h"
+
+namespace RbxStu {
+    enum class CoverageFormat : std::uint8_t {
+        /// @brief The tracefile format of lcov, read by genhtml and most coverage tooling.
+        Lcov,
+        Json,
+    };
+} // namespace RbxStu
+
+/// @brief Collects the line coverage of the scripts executed through the Scheduler, merging the hits of every run of
+/// the same source, so that the coverage of a whole suite may be dumped at once.
+/// @remarks Scripts carry no name of their own, so they are told apart by their source: running the same script twice
+/// adds to the hits of a single file, named after the hash of its source.
+class CoverageCollector final {
+    /// @brief Private, Static shared pointer into the instance.
+    static std::shared_ptr<CoverageCollector> pInstance;
+
+    /// @brief The coverage of a source, merged across every run of it.
+    struct CoveredSource {
+        std::string szSource;
+        std::uint64_t ullRuns = 0;
+        /// @brief The hits of every line holding code, keyed by line.
+        std::map<int, std::uint64_t> mapLines;
+        /// @brief The times every function was entered, keyed by the line it is defined on and its name.
+        std::map<std::pair<int, std::string>, std::uint64_t> mapFunctions;
+    };
+
+    std::mutex m_mutex;
+    /// @brief The sources seen so far, keyed by the hash of their source, or the next free one should it be taken by
+    /// another source.
+    std::unordered_map<std::uint64_t, CoveredSource> m_mapSources;
+
+public:
+    /// @brief A function being tracked, until it is collected.
+    struct TrackedChunk {
+        /// @brief The registry reference that keeps the function alive until it is collected.
+        int dwReference;
+        std::uint64_t ullSourceHash;
+    };
+
+    /// @brief Obtains the shared pointer that points to the global singleton for the current class.
+    /// @return Singleton for CoverageCollector as a std::shared_ptr<CoverageCollector>.
+    static std::shared_ptr<CoverageCollector> GetSingleton();
+
+    /// @brief Obtains whether scripts are being compiled with coverage instrumentation.
+    static bool IsEnabled();
+
+    /// @brief Begins or stops instrumenting scripts. Only scripts compiled afterwards are affected, the coverage
+    /// collected so far is kept.
+    static void SetEnabled(bool bEnabled);
+
+    /// @brief Begins tracking the function on top of the stack of L, which must have been compiled from the given
+    /// source with a coverage level of 2.
+    /// @param L The lua_State the function is on. It is left on the stack.
+    /// @param szSource The Luau source the function was compiled from.
+    /// @return The chunk to collect once the script finishes.
+    TrackedChunk Track(lua_State *L, std::string_view szSource);
+
+    /// @brief Merges the hits of a tracked function into the coverage of its source, and stops tracking it.
+    /// @param L A thread of the VM the function was tracked on.
+    /// @param chunk The chunk returned by Track. It may not be collected twice.
+    /// @remarks The VM may only be read from the thread that runs it, so this must be called from a script or while
+    /// stepping.
+    void Collect(lua_State *L, const TrackedChunk &chunk);
+
+    /// @brief Discards the coverage collected so far.
+    void Clear();
+
+    /// @brief Generates an lcov tracefile with the coverage collected so far.
+    /// @param sourceDirectory The directory the sources are written into, which the tracefile points to.
+    [[nodiscard]] std::string ExportLcov(const std::filesystem::path &sourceDirectory);
+
+    /// @brief Generates a JSON document with the coverage collected so far, one object per source, holding the hits of
+    /// its lines and functions.
+    [[nodiscard]] std::string ExportJson();
+
+    /// @brief Writes the coverage collected so far into the given file, replacing its contents, and the sources it
+    /// covers into a directory next to it, named after the file with "-Sources" appended.
+    /// @return True if every file was written successfully.
+    bool DumpToFile(const std::filesystem::path &path, RbxStu::CoverageFormat format);
+};
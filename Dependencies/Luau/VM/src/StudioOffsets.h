@@ -63,4 +63,6 @@ using luaV_settable = void(__fastcall*)(lua_State* L, const void* t, const void*
  *  How to get this to compile when updating Luau?
  *      - Modify lobject.cpp and lobject.h to use Studios' luaO_nilobject, same thing with ltable.cpp and ltable.h and luaH_dummynode, as well as
  * modifying lvm.cpp to use luau_execute. You must use luau_load when compiling code, for anyone using this to develop anything.
+ *      - Every one of those modifications must be kept behind RBXSTU_STANDALONE_VM. Defining it builds the stock VM, which does not call into
+ * Studio, for tools that run the VM outside of it, such as Tools/SchedulerBenchmark.
  */
\ No newline at end of file
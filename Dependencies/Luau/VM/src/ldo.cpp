@@ -116,9 +116,11 @@ private:
 
 int luaD_rawrunprotected(lua_State* L, Pfunc f, void* ud)
 {
+#ifndef RBXSTU_STANDALONE_VM
     if (nullptr != RbxStuOffsets::GetSingleton()->GetOffset("luaD_rawrununprotected"))
         return reinterpret_cast<RBX::Studio::FunctionTypes::luaD_rawrununprotected>(RbxStuOffsets::GetSingleton()
                                                                                         ->GetOffset("luaD_rawrununprotected"))(L, f, ud);
+#endif
 
     int status = 0;
 
@@ -158,9 +160,13 @@ int luaD_rawrunprotected(lua_State* L, Pfunc f, void* ud)
 
 l_noret luaD_throw(lua_State* L, int errcode)
 {
+#ifdef RBXSTU_STANDALONE_VM
+    throw lua_exception(L, errcode);
+#else
     if (nullptr != RbxStuOffsets::GetSingleton()->GetOffset("luaD_throw"))
         return reinterpret_cast<RBX::Studio::FunctionTypes::luaD_throw>(RbxStuOffsets::GetSingleton()->GetOffset("luaD_throw"))(L, errcode);
     // throw lua_exception(L, errcode);
+#endif
 }
 #endif
 
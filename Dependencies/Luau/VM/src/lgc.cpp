@@ -1015,7 +1015,9 @@ static size_t getheaptrigger(global_State* g, size_t heapgoal)
 
 size_t luaC_step(lua_State* L, bool assist)
 {
+#ifndef RBXSTU_STANDALONE_VM
     return reinterpret_cast<RBX::Studio::FunctionTypes::luaC_Step>(RbxStuOffsets::GetSingleton()->GetOffset("luaC_Step"))(L, assist);
+#endif
 
     global_State* g = L->global;
 
@@ -14,7 +14,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef RBXSTU_STANDALONE_VM
+const TValue luaO_nilobject_ = {{NULL}, {0}, LUA_TNIL};
+#else
 #define luaO_nilobject_ = *luaO_nilobject;// {{NULL}, {0}, LUA_TNIL};
+#endif
 
 int luaO_log2(unsigned int x)
 {
@@ -489,7 +489,13 @@ typedef struct Table
 #define twoto(x) ((int)(1 << (x)))
 #define sizenode(t) (twoto((t)->lsizenode))
 
+#ifdef RBXSTU_STANDALONE_VM
+#define luaO_nilobject (&luaO_nilobject_)
+
+LUAI_DATA const TValue luaO_nilobject_;
+#else
 #define luaO_nilobject (reinterpret_cast<lua_TValue*>(RbxStuOffsets::GetSingleton()->GetOffset("luaO_nilobject")))
+#endif
 
 #define ceillog2(x) (luaO_log2((x)-1) + 1)
 
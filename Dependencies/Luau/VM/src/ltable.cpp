@@ -46,9 +46,18 @@ static_assert(TKey{{NULL}, {0}, LUA_TNIL, MAXSIZE - 1}.next == MAXSIZE - 1, "not
 static_assert(TKey{{NULL}, {0}, LUA_TNIL, -(MAXSIZE - 1)}.next == -(MAXSIZE - 1), "not enough bits for next");
 
 // empty hash data points to dummynode so that we can always dereference it
+#ifdef RBXSTU_STANDALONE_VM
+const LuaNode luaH_dummynode = {
+    {{NULL}, {0}, LUA_TNIL},   // value
+    {{NULL}, {0}, LUA_TNIL, 0} // key
+};
+
+#define dummynode (&luaH_dummynode)
+#else
 #define luaH_dummynode (*reinterpret_cast<LuaNode*>(RbxStuOffsets::GetSingleton()->GetOffset("luaH_dummynode")))
 
 #define dummynode (reinterpret_cast<LuaNode*>(RbxStuOffsets::GetSingleton()->GetOffset("luaH_dummynode")))
+#endif
 
 // hash is always reduced mod 2^k
 #define hashpow2(t, n) (gnode(t, lmod((n), sizenode(t))))
@@ -3041,7 +3041,9 @@ exit:;
 
 void luau_execute(lua_State* L)
 {
+#ifndef RBXSTU_STANDALONE_VM
     return reinterpret_cast<RBX::Studio::FunctionTypes::luau_execute>(RbxStuOffsets::GetSingleton()->GetOffset("luau_execute"))(L);
+#endif
 
     if (L->singlestep)
         luau_execute<true>(L);
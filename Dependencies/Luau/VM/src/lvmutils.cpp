@@ -98,8 +98,10 @@ static void callTM(lua_State* L, const TValue* f, const TValue* p1, const TValue
 
 void luaV_gettable(lua_State* L, const TValue* t, TValue* key, StkId val)
 {
+#ifndef RBXSTU_STANDALONE_VM
     if (nullptr != RbxStuOffsets::GetSingleton()->GetOffset("luaV_gettable"))
         return reinterpret_cast<RBX::Studio::FunctionTypes::luaV_gettable>(RbxStuOffsets::GetSingleton()->GetOffset("luaV_gettable"))(L, t, key, val);
+#endif
 
     int loop;
     for (loop = 0; loop < MAXTAGLOOP; loop++)
@@ -136,8 +138,10 @@ void luaV_gettable(lua_State* L, const TValue* t, TValue* key, StkId val)
 
 void luaV_settable(lua_State* L, const TValue* t, TValue* key, StkId val)
 {
+#ifndef RBXSTU_STANDALONE_VM
     if (nullptr != RbxStuOffsets::GetSingleton()->GetOffset("luaV_settable"))
         return reinterpret_cast<RBX::Studio::FunctionTypes::luaV_settable>(RbxStuOffsets::GetSingleton()->GetOffset("luaV_settable"))(L, t, key, val);
+#endif
 
     int loop;
     TValue temp;
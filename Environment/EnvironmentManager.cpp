@@ -4,10 +4,14 @@
 
 #include "EnvironmentManager.hpp"
 
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "Communication.hpp"
+#include "ExecutionReporter.hpp"
 #include "Libraries/Debug.hpp"
+#include "Libraries/Diagnostics.hpp"
 #include "Libraries/Filesystem.hpp"
 #include "Libraries/Globals.hpp"
 #include "Logger.hpp"
@@ -73,6 +77,39 @@ static std::vector<std::string> blockedFunctions = {"openvideosfolder",
                                                     "deletecapturesasync"};
 
 
+/// @brief Replaces print and warn on the executor environment, reporting every line printed by a script to its
+/// submitter before calling the original function, which is its first upvalue. The kind of event to report is the
+/// second.
+/// @remarks The arguments of a line that is reported are replaced by the strings they were converted into, so that
+/// the original function prints the very same text and no __tostring metamethod runs twice.
+static int ReportPrintedLine(lua_State *L) {
+    if (const auto reporter = ExecutionReporter::GetSingleton(); reporter->IsReportingOnChunks()) {
+        // The chunk of the caller tells the script that is printing apart, see ExecutionReporter::AttachChunk.
+        lua_Debug ar{};
+        if (lua_getinfo(L, 1, "s", &ar) != 0 && ar.source != nullptr) {
+            std::string szLine;
+            for (int dwArgument = 1; dwArgument <= lua_gettop(L); dwArgument++) {
+                std::size_t ullLength{};
+                const auto szArgument = luaL_tolstring(L, dwArgument, &ullLength);
+                if (dwArgument > 1)
+                    szLine += ' ';
+
+                szLine.append(szArgument, ullLength);
+                lua_replace(L, dwArgument);
+            }
+
+            reporter->ReportOnChunk(
+                    ar.source,
+                    static_cast<RbxStu::Protocol::ExecutionEventKind>(lua_tointeger(L, lua_upvalueindex(2))), szLine);
+        }
+    }
+
+    lua_pushvalue(L, lua_upvalueindex(1));
+    lua_insert(L, 1);
+    lua_call(L, lua_gettop(L) - 1, LUA_MULTRET);
+    return lua_gettop(L);
+}
+
 void EnvironmentManager::PushEnvironment(_In_ lua_State *L) {
     const auto logger = Logger::GetSingleton();
 
@@ -83,7 +120,8 @@ void EnvironmentManager::PushEnvironment(_In_ lua_State *L) {
     lua_pushvalue(L, LUA_GLOBALSINDEX);
     lua_setglobal(L, "shared");
 
-    for (const std::vector<Library *> libList = {new Debug{}, new Globals{}, new Filesystem()}; const auto &lib: libList) {
+    for (const std::vector<Library *> libList = {new Debug{}, new Globals{}, new Filesystem(), new Diagnostics{}};
+         const auto &lib: libList) {
         try {
             const auto envGlobals = lib->GetLibraryFunctions();
             lua_newtable(L);
@@ -105,6 +143,19 @@ void EnvironmentManager::PushEnvironment(_In_ lua_State *L) {
         delete lib;
     }
 
+    for (const auto &[szName, kind]: {std::pair{"print", RbxStu::Protocol::ExecutionEventKind::Output},
+                                      std::pair{"warn", RbxStu::Protocol::ExecutionEventKind::Warning}}) {
+        lua_getglobal(L, szName);
+        if (!lua_isfunction(L, -1)) {
+            lua_pop(L, 1);
+            continue;
+        }
+
+        lua_pushinteger(L, static_cast<int>(kind));
+        lua_pushcclosure(L, ReportPrintedLine, szName, 2);
+        lua_setglobal(L, szName);
+    }
+
     logger->PrintInformation(RbxStu::EnvironmentManager,
                              "Installing meta method hooks (for security and extra behaviour)!");
 
@@ -0,0 +1,182 @@
+#include "Diagnostics.hpp"
+
+#include <filesystem>
+#include <format>
+
+#include "CoverageCollector.hpp"
+#include "LatencyTracker.hpp"
+#include "Profiler.hpp"
+#include "Scheduler.hpp"
+#include "TraceRecorder.hpp"
+#include "Utilities.hpp"
+#include "ldebug.h"
+
+namespace RbxStu {
+    namespace Diagnostics {
+        int getschedulerlatency(lua_State *L) {
+            const auto latencyTracker = LatencyTracker::GetSingleton();
+            lua_createtable(L, 0, static_cast<int>(RbxStu::LatencyStage::Count));
+
+            for (std::uint8_t i = 0; i < static_cast<std::uint8_t>(RbxStu::LatencyStage::Count); i++) {
+                const auto stage = static_cast<RbxStu::LatencyStage>(i);
+                const auto snapshot = latencyTracker->GetHistogram(stage).GetSnapshot();
+
+                lua_createtable(L, 0, 6);
+                lua_pushnumber(L, static_cast<double>(snapshot.ullCount));
+                lua_setfield(L, -2, "count");
+                lua_pushnumber(L, snapshot.ullCount == 0 ? 0.0
+                                                         : static_cast<double>(snapshot.ullSum) / snapshot.ullCount);
+                lua_setfield(L, -2, "mean");
+                lua_pushnumber(L, static_cast<double>(snapshot.ullP50));
+                lua_setfield(L, -2, "p50");
+                lua_pushnumber(L, static_cast<double>(snapshot.ullP90));
+                lua_setfield(L, -2, "p90");
+                lua_pushnumber(L, static_cast<double>(snapshot.ullP99));
+                lua_setfield(L, -2, "p99");
+                lua_pushnumber(L, static_cast<double>(snapshot.ullMax));
+                lua_setfield(L, -2, "max");
+
+                lua_setfield(L, -2, RbxStu::LatencyStageToString(stage));
+            }
+
+            return 1;
+        }
+
+        int resetschedulerlatency(lua_State *L) {
+            LatencyTracker::GetSingleton()->Reset();
+            return 0;
+        }
+
+        RbxStu::Task<int> dumpschedulerlatency(lua_State *L) {
+            const auto directory = Utilities::GetDllDir();
+            if (directory.empty())
+                luaG_runerror(L, "Failed to get directory path of the dll!");
+
+            // The name is fixed, scripts must not be able to write wherever they want outside of the workspace.
+            const auto path = (std::filesystem::path(directory) / "RbxStu-SchedulerLatency.txt").string();
+            if (!co_await RbxStu::RunOnThreadPool([path] { return LatencyTracker::GetSingleton()->DumpToFile(path); }))
+                luaG_runerror(L, "Failed to write the scheduler latency report!");
+
+            lua_pushlstring(L, path.c_str(), path.size());
+            co_return 1;
+        }
+
+        int settracing(lua_State *L) {
+            luaL_checktype(L, 1, LUA_TBOOLEAN);
+            TraceRecorder::SetEnabled(lua_toboolean(L, 1));
+            return 0;
+        }
+
+        int cleartrace(lua_State *L) {
+            TraceRecorder::GetSingleton()->Clear();
+            return 0;
+        }
+
+        RbxStu::Task<int> dumptrace(lua_State *L) {
+            const auto directory = Utilities::GetDllDir();
+            if (directory.empty())
+                luaG_runerror(L, "Failed to get directory path of the dll!");
+
+            // Opened with chrome://tracing or https://ui.perfetto.dev.
+            const auto path = (std::filesystem::path(directory) / "RbxStu-Trace.json").string();
+            if (!co_await RbxStu::RunOnThreadPool([path] { return TraceRecorder::GetSingleton()->DumpToFile(path); }))
+                luaG_runerror(L, "Failed to write the trace!");
+
+            lua_pushlstring(L, path.c_str(), path.size());
+            co_return 1;
+        }
+
+        int startprofiler(lua_State *L) {
+            const auto dwFrequency = luaL_optinteger(L, 1, ::Profiler::DefaultFrequency);
+            if (dwFrequency < 1 || dwFrequency > static_cast<int>(::Profiler::MaximumFrequency))
+                luaL_argerror(L, 1, std::format("must be between 1 and {}", ::Profiler::MaximumFrequency).c_str());
+
+            if (!::Profiler::GetSingleton()->Start(static_cast<std::uint32_t>(dwFrequency)))
+                luaG_runerror(L, "The profiler is running already!");
+
+            return 0;
+        }
+
+        int stopprofiler(lua_State *L) {
+            lua_pushboolean(L, ::Profiler::GetSingleton()->Stop());
+            return 1;
+        }
+
+        int clearprofile(lua_State *L) {
+            ::Profiler::GetSingleton()->Clear();
+            return 0;
+        }
+
+        RbxStu::Task<int> dumpprofile(lua_State *L) {
+            const auto directory = Utilities::GetDllDir();
+            if (directory.empty())
+                luaG_runerror(L, "Failed to get directory path of the dll!");
+
+            // Folded stacks, rendered with flamegraph.pl, inferno-flamegraph or https://www.speedscope.app.
+            const auto path = (std::filesystem::path(directory) / "RbxStu-Profile.folded").string();
+            if (!co_await RbxStu::RunOnThreadPool([path] { return ::Profiler::GetSingleton()->DumpToFile(path); }))
+                luaG_runerror(L, "Failed to write the profile!");
+
+            lua_pushlstring(L, path.c_str(), path.size());
+            co_return 1;
+        }
+
+        int setcoverage(lua_State *L) {
+            luaL_checktype(L, 1, LUA_TBOOLEAN);
+            CoverageCollector::SetEnabled(lua_toboolean(L, 1));
+            return 0;
+        }
+
+        int clearcoverage(lua_State *L) {
+            CoverageCollector::GetSingleton()->Clear();
+            return 0;
+        }
+
+        RbxStu::Task<int> dumpcoverage(lua_State *L) {
+            const std::string_view szFormat = luaL_optstring(L, 1, "lcov");
+            if (szFormat != "lcov" && szFormat != "json")
+                luaL_argerror(L, 1, "format must be either 'lcov' or 'json'");
+
+            const auto directory = Utilities::GetDllDir();
+            if (directory.empty())
+                luaG_runerror(L, "Failed to get directory path of the dll!");
+
+            // The sources are written next to the report, into RbxStu-Coverage-Sources, which the report refers to.
+            const auto format = szFormat == "lcov" ? RbxStu::CoverageFormat::Lcov : RbxStu::CoverageFormat::Json;
+            const auto szFileName =
+                    format == RbxStu::CoverageFormat::Lcov ? "RbxStu-Coverage.info" : "RbxStu-Coverage.json";
+            const auto path = (std::filesystem::path(directory) / szFileName).string();
+            if (!co_await RbxStu::RunOnThreadPool(
+                        [path, format] { return CoverageCollector::GetSingleton()->DumpToFile(path, format); }))
+                luaG_runerror(L, "Failed to write the coverage!");
+
+            lua_pushlstring(L, path.c_str(), path.size());
+            co_return 1;
+        }
+    } // namespace Diagnostics
+} // namespace RbxStu
+
+std::string Diagnostics::GetLibraryName() { return "diagnostics"; }
+
+luaL_Reg *Diagnostics::GetLibraryFunctions() {
+    // WARNING: you MUST add nullptr at the end of luaL_Reg declarations, else, Luau will choke.
+    auto *reg = new luaL_Reg[]{
+            {"getschedulerlatency", RbxStu::Diagnostics::getschedulerlatency},
+            {"resetschedulerlatency", RbxStu::Diagnostics::resetschedulerlatency},
+            {"dumpschedulerlatency", RbxStu::YieldingCFunction<RbxStu::Diagnostics::dumpschedulerlatency>},
+            {"settracing", RbxStu::Diagnostics::settracing},
+            {"cleartrace", RbxStu::Diagnostics::cleartrace},
+            {"dumptrace", RbxStu::YieldingCFunction<RbxStu::Diagnostics::dumptrace>},
+            {"startprofiler", RbxStu::Diagnostics::startprofiler},
+            {"stopprofiler", RbxStu::Diagnostics::stopprofiler},
+            {"clearprofile", RbxStu::Diagnostics::clearprofile},
+            {"dumpprofile", RbxStu::YieldingCFunction<RbxStu::Diagnostics::dumpprofile>},
+            {"setcoverage", RbxStu::Diagnostics::setcoverage},
+            {"clearcoverage", RbxStu::Diagnostics::clearcoverage},
+            {"dumpcoverage", RbxStu::YieldingCFunction<RbxStu::Diagnostics::dumpcoverage>},
+
+            {nullptr, nullptr},
+    };
+
+    return reg;
+}
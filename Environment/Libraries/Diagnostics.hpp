@@ -0,0 +1,10 @@
+#pragma once
+#include <lua.h>
+#include <string>
+#include "Environment/EnvironmentManager.hpp"
+
+class Diagnostics final : public Library {
+public:
+    std::string GetLibraryName() override;
+    luaL_Reg *GetLibraryFunctions() override;
+};
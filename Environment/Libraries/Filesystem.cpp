@@ -6,11 +6,16 @@
 #include <Windows.h>
 #include <filesystem>
 #include <fstream>
+#include <optional>
 #include <unordered_set>
 
 #include "Logger.hpp"
+#include "MetricsRegistry.hpp"
 #include "RobloxManager.hpp"
 #include "Scheduler.hpp"
+#include "SchedulerManager.hpp"
+#include "TraceRecorder.hpp"
+#include "Utilities.hpp"
 #include "ldebug.h"
 
 namespace fs = std::filesystem;
@@ -21,21 +26,6 @@ std::unordered_set<std::string> blacklistedExtensions = {
     ".exe", ".dll", ".bat", ".cmd", ".vbs", ".js", ".wsf", ".msi", ".com", ".lnk", ".ps1", ".py"
 };
 
-std::string GetDllDir() {
-    char path[MAX_PATH];
-    HMODULE hModule = NULL;
-
-    if (GetModuleHandleEx(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
-                          GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
-                          (LPCSTR)&GetDllDir, &hModule)) {
-        if (GetModuleFileNameA(hModule, path, sizeof(path))) {
-            std::filesystem::path fullPath(path);
-            return fullPath.parent_path().string();
-        }
-                          }
-    return "";
-}
-
 bool IsPathSafe(const std::string& relativePath) {
     fs::path base = fs::absolute(workspaceDir);
     fs::path combined = base / relativePath;
@@ -76,6 +66,57 @@ std::filesystem::path CheckPath(lua_State *L) {
     return workspaceDir / relativePath;
 }
 
+/// @brief Obtains the counter of the bytes the library has read from or written to the workspace.
+/// @param direction Either "read" or "write".
+RbxStu::Metrics::Counter& GetTransferredBytes(const char* direction) {
+    return MetricsRegistry::GetSingleton()->GetCounter(
+        "rbxstu_filesystem_bytes_total", "The bytes the Filesystem library has read from or written to the workspace.",
+        {{"direction", direction}});
+}
+
+std::optional<std::string> ReadWholeFile(const std::filesystem::path& absolutePath) {
+    const RbxStu::TraceSpan span{RbxStu::Env_Filesystem, "ReadWholeFile"};
+    std::ifstream file(absolutePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return {};
+    }
+
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    std::string buffer(size, '\0');
+    if (!file.read(buffer.data(), size)) {
+        return {};
+    }
+
+    static auto& bytesRead = GetTransferredBytes("read");
+    bytesRead.Increment(buffer.size());
+    return buffer;
+}
+
+const char* WriteWholeFile(const std::filesystem::path& absolutePath, const std::string& content, bool append) {
+    const RbxStu::TraceSpan span{RbxStu::Env_Filesystem, "WriteWholeFile"};
+    fs::create_directories(absolutePath.parent_path());
+
+    std::ofstream file(absolutePath, append ? std::ios::binary | std::ios::app : std::ios::binary);
+    if (!file.is_open()) {
+        return "Failed to open the file!";
+    }
+
+    file.write(content.data(), content.size());
+    if (file.fail()) {
+        return "Failed to write the content!";
+    }
+
+    file.close();
+    if (file.fail()) {
+        return "Failed to close the file!";
+    }
+
+    static auto& bytesWritten = GetTransferredBytes("write");
+    bytesWritten.Increment(content.size());
+    return nullptr;
+}
+
 namespace RbxStu {
     namespace Filesystem {
         int isfile(lua_State* L) {
@@ -119,7 +160,7 @@ namespace RbxStu {
             return 1;
         }
 
-        int readfile(lua_State* L) {
+        RbxStu::Task<int> readfile(lua_State* L) {
             luaL_checkstring(L, 1);
             CanBeUsed(L);
 
@@ -129,24 +170,17 @@ namespace RbxStu {
                 luaG_runerror(L, "This file doesn't exist or it's not a file!");
             }
 
-            std::ifstream file(absolutePath, std::ios::binary | std::ios::ate);
-            if (!file.is_open()) {
-                luaG_runerror(L, "Failed to open the file!");
-            }
-
-            std::streamsize size = file.tellg();
-            file.seekg(0, std::ios::beg);
-            std::vector<char> buffer(size);
-            if (!file.read(buffer.data(), size)) {
+            // The read itself is done on the thread pool, big files should not stall Roblox's scheduler.
+            const auto content = co_await RbxStu::RunOnThreadPool([absolutePath] { return ReadWholeFile(absolutePath); });
+            if (!content.has_value()) {
                 luaG_runerror(L, "Failed to read file!");
             }
 
-            lua_pushlstring(L, buffer.data(), size);
-
-            return 1;
+            lua_pushlstring(L, content->data(), content->size());
+            co_return 1;
         }
 
-        int writefile(lua_State* L) {
+        RbxStu::Task<int> writefile(lua_State* L) {
             luaL_checkstring(L, 1);
             luaL_checkstring(L, 2);
             CanBeUsed(L);
@@ -169,24 +203,15 @@ namespace RbxStu {
                 luaG_runerror(L, "This file extension is not allowed");
             }
 
-            fs::create_directories(absolutePath.parent_path());
-
-            std::ofstream file(absolutePath, std::ios::binary);
-            if (!file.is_open()) {
-                luaG_runerror(L, "Failed to open the file!");
-            }
-
-            file.write(fileContent, contentLength);
-            if (file.fail()) {
-                luaG_runerror(L, "Failed to write the content!");
+            const auto szError = co_await RbxStu::RunOnThreadPool(
+                    [absolutePath, content = std::string(fileContent, contentLength)] {
+                        return WriteWholeFile(absolutePath, content, false);
+                    });
+            if (szError != nullptr) {
+                luaG_runerror(L, "%s", szError);
             }
 
-            file.close();
-            if (file.fail()) {
-                luaG_runerror(L, "Failed to close the file!");
-            }
-
-            return 0;
+            co_return 0;
         }
 
         int makefolder(lua_State* L) {
@@ -243,55 +268,57 @@ namespace RbxStu {
             luaL_checkstring(L, 1);
             CanBeUsed(L);
 
-            auto relativePath = lua_tostring(L, 1);
             auto absolutePath = CheckPath(L);
 
             if (!fs::exists(absolutePath) || !fs::is_regular_file(absolutePath)) {
                 luaG_runerror(L, "This file doesn't exist or it's not a file!");
             }
 
-            lua_pushcfunction(L, RbxStu::Filesystem::readfile, "DoFile");
-            lua_pushstring(L, relativePath);
-            lua_call(L, 1, 1);
-            auto scriptContent = lua_tostring(L, -1);
-            Scheduler::GetSingleton()->ScheduleJob(SchedulerJob(scriptContent));
-            lua_pop(L, 1);
+            const auto scriptContent = ReadWholeFile(absolutePath);
+            if (!scriptContent.has_value()) {
+                luaG_runerror(L, "Failed to read file!");
+            }
+
+            // The file is executed on the same DataModel as the script that requested it.
+            const auto scheduler = SchedulerManager::GetSingleton()->GetSchedulerForState(L);
+            if (!scheduler.has_value()) {
+                luaG_runerror(L, "Cannot execute file, the thread does not belong to any DataModel RbxStu executes "
+                                 "on!");
+            }
+
+            scheduler.value()->ScheduleJob(SchedulerJob(scriptContent.value()));
 
             return 0;
         }
 
-        int appendfile(lua_State* L) {
+        RbxStu::Task<int> appendfile(lua_State* L) {
             luaL_checkstring(L, 1);
             luaL_checkstring(L, 2);
             CanBeUsed(L);
 
-            auto relativePath = lua_tostring(L, 1);
-            auto contentToAppend = lua_tostring(L, 2);
+            size_t contentLength;
+            auto contentToAppend = lua_tolstring(L, 2, &contentLength);
             auto absolutePath = CheckPath(L);
 
             if (!fs::exists(absolutePath) || !fs::is_regular_file(absolutePath)) {
                 luaG_runerror(L, "This file doesn't exist or it's not a file!");
             }
 
-            lua_pushcfunction(L, RbxStu::Filesystem::readfile, "AppendFile");
-            lua_pushstring(L, relativePath);
-            lua_call(L, 1, 1);
-            auto currentContent = _strdup(lua_tostring(L, -1)); // Clone string bc it will get GC'ed once we pop it
-            lua_pop(L, 1);
-            auto newContent = std::format("{}{}", currentContent, contentToAppend).c_str();
-            lua_pushcfunction(L, RbxStu::Filesystem::writefile, "AppendFile");
-            lua_pushstring(L, relativePath);
-            lua_pushstring(L, newContent);
-            lua_call(L, 2, 0);
+            const auto szError = co_await RbxStu::RunOnThreadPool(
+                    [absolutePath, content = std::string(contentToAppend, contentLength)] {
+                        return WriteWholeFile(absolutePath, content, true);
+                    });
+            if (szError != nullptr) {
+                luaG_runerror(L, "%s", szError);
+            }
 
-            return 0;
+            co_return 0;
         }
 
         int loadfile(lua_State* L) {
             luaL_checkstring(L, 1);
             CanBeUsed(L);
 
-            auto relativePath = lua_tostring(L, 1);
             auto absolutePath = CheckPath(L);
             const char* sectionName = "";
             if (!lua_isnil(L, 2)) {
@@ -303,14 +330,13 @@ namespace RbxStu {
             }
 
 
-            lua_pushcfunction(L, RbxStu::Filesystem::readfile, "loadfile");
-            lua_pushstring(L, relativePath);
-            lua_call(L, 1, 1);
-            auto codeContent = _strdup(lua_tostring(L, -1)); // Copy bc once we pop, it's going to get GC'ed
-            lua_pop(L, 1);
+            const auto codeContent = ReadWholeFile(absolutePath);
+            if (!codeContent.has_value()) {
+                luaG_runerror(L, "Failed to read file!");
+            }
 
             lua_getglobal(L, "loadstring");
-            lua_pushstring(L, codeContent);
+            lua_pushlstring(L, codeContent->data(), codeContent->size());
             lua_pushstring(L, sectionName);
             if (lua_pcall(L, 2, 1, 0) != LUA_OK) {
                 lua_pushnil(L);
@@ -327,7 +353,7 @@ std::string Filesystem::GetLibraryName() { return "fs"; }
 
 luaL_Reg *Filesystem::GetLibraryFunctions() {
     const auto logger = Logger::GetSingleton();
-    auto currentDirectory = fs::path(GetDllDir());
+    auto currentDirectory = fs::path(Utilities::GetDllDir());
     if (!currentDirectory.empty()) {
         logger->PrintInformation(RbxStu::Env_Filesystem, std::format("Current path: {}", currentDirectory.string()));
         canBeUsed = true;
@@ -349,13 +375,13 @@ luaL_Reg *Filesystem::GetLibraryFunctions() {
                               {"isfile", RbxStu::Filesystem::isfile},
                               {"isfolder", RbxStu::Filesystem::isfolder},
                               {"listfiles", RbxStu::Filesystem::listfiles},
-                              {"readfile", RbxStu::Filesystem::readfile},
-                              {"writefile", RbxStu::Filesystem::writefile},
+                              {"readfile", RbxStu::YieldingCFunction<RbxStu::Filesystem::readfile>},
+                              {"writefile", RbxStu::YieldingCFunction<RbxStu::Filesystem::writefile>},
                               {"makefolder", RbxStu::Filesystem::makefolder},
                               {"delfile", RbxStu::Filesystem::delfile},
                               {"delfolder", RbxStu::Filesystem::delfolder},
                               {"dofile", RbxStu::Filesystem::dofile},
-                              {"appendfile", RbxStu::Filesystem::appendfile},
+                              {"appendfile", RbxStu::YieldingCFunction<RbxStu::Filesystem::appendfile>},
                               {"loadfile", RbxStu::Filesystem::loadfile},
 
                               {nullptr, nullptr},
@@ -12,7 +12,9 @@
 #include "Luau/Compiler.h"
 #include "RobloxManager.hpp"
 #include "Scheduler.hpp"
+#include "SchedulerManager.hpp"
 #include "Security.hpp"
+#include "TraceRecorder.hpp"
 #include "cpr/api.h"
 #include "lgc.h"
 #include "lmem.h"
@@ -151,38 +153,29 @@ namespace RbxStu {
         return 1;
     }
 
-    int httpget(lua_State *L) {
+    RbxStu::Task<int> httpget(lua_State *L) {
         const std::string url = luaL_checkstring(L, 1);
 
         if (url.find("http://") == std::string::npos && url.find("https://") == std::string::npos)
             luaG_runerror(L, "Invalid protocol (expected 'http://' or 'https://')");
 
-        const auto scheduler = Scheduler::GetSingleton();
+        const auto output = co_await RbxStu::RunOnThreadPool([url](const RbxStu::CancellationToken &token) {
+            const RbxStu::TraceSpan span{RbxStu::EnvironmentManager, "HttpGet"};
+            // Let the request expire together with the yield, no point in keeping the connection up past it.
+            const auto response = cpr::Get(cpr::Url{url}, cpr::Header{{"User-Agent", "Roblox/WinInet"}},
+                                           cpr::Timeout{token.GetRemainingTime()});
 
-        scheduler->ScheduleJob(SchedulerJob(
-                L, [url](lua_State *L, std::shared_future<std::function<int(lua_State *)>> *callbackToExecute) {
-                    const auto response = cpr::Get(cpr::Url{url}, cpr::Header{{"User-Agent", "Roblox/WinInet"}});
-
-                    auto output = std::string("");
-
-                    if (HttpStatus::IsError(response.status_code)) {
-                        output = std::format(
-                                "HttpGet failed\nResponse {} - {}. {}", std::to_string(response.status_code),
-                                HttpStatus::ReasonPhrase(response.status_code), std::string(response.error.message));
-                    } else {
-                        output = response.text;
-                    }
+            if (HttpStatus::IsError(response.status_code)) {
+                return std::format("HttpGet failed\nResponse {} - {}. {}", std::to_string(response.status_code),
+                                   HttpStatus::ReasonPhrase(response.status_code),
+                                   std::string(response.error.message));
+            }
 
-                    *callbackToExecute = std::async(std::launch::async, [output]() -> std::function<int(lua_State *)> {
-                        return [output](lua_State *L) -> int {
-                            lua_pushlstring(L, output.c_str(), output.size());
-                            return 1;
-                        };
-                    });
-                }));
+            return response.text;
+        });
 
-        L->ci->flags |= 1;
-        return lua_yield(L, 1);
+        lua_pushlstring(L, output.c_str(), output.size());
+        co_return 1;
     }
 
     int checkcaller(lua_State *L) {
@@ -260,9 +253,17 @@ namespace RbxStu {
         const auto luauCode = luaL_checkstring(L, 1);
         const auto chunkName = luaL_optstring(L, 2, "RbxStuV2_LoadString");
         constexpr auto compileOpts = Luau::CompileOptions{2, 2};
-        const auto bytecode = Luau::compile(luauCode, compileOpts);
+        std::string bytecode;
+        {
+            const RbxStu::TraceSpan span{RbxStu::EnvironmentManager, "Luau::compile"};
+            const auto compileStart = std::chrono::steady_clock::now();
+            bytecode = Luau::compile(luauCode, compileOpts);
+            RbxStu::RecordCompilation("loadstring", std::strlen(luauCode), bytecode.size(),
+                                      std::chrono::steady_clock::now() - compileStart);
+        }
 
-        if (luau_load(L, chunkName, bytecode.c_str(), bytecode.size(), 0) != lua_Status::LUA_OK) {
+        if (const RbxStu::TraceSpan span{RbxStu::EnvironmentManager, "luau_load"};
+            luau_load(L, chunkName, bytecode.c_str(), bytecode.size(), 0) != lua_Status::LUA_OK) {
             lua_pushnil(L);
             lua_pushvalue(L, -2);
             return 2;
@@ -272,6 +273,7 @@ namespace RbxStu {
             const Luau::CodeGen::CompilationOptions opts{0};
             Logger::GetSingleton()->PrintInformation(RbxStu::Scheduler,
                                      "Native Code Generation is enabled! Compiling Luau Bytecode -> Native");
+            const RbxStu::TraceSpan span{RbxStu::EnvironmentManager, "CodeGen::compile"};
             Luau::CodeGen::compile(L, -1, opts);
         }
 
@@ -309,24 +311,31 @@ namespace RbxStu {
         return 1;
     }
 
-    int messagebox(lua_State *L) {
-        const auto text = luaL_checkstring(L, 1);
-        const auto caption = luaL_checkstring(L, 2);
+    RbxStu::Task<int> sleep(lua_State *L) {
+        // Capped at a day, anything longer is better off being a loop.
+        const auto seconds = std::clamp(luaL_optnumber(L, 1, 0.0), 0.0, 86400.0);
+        const auto startedAt = std::chrono::steady_clock::now();
+
+        co_await RbxStu::Sleep(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(seconds)));
+
+        lua_pushnumber(L, std::chrono::duration<double>(std::chrono::steady_clock::now() - startedAt).count());
+        co_return 1;
+    }
+
+    RbxStu::Task<int> messagebox(lua_State *L) {
+        // Copy the strings, the ones on the stack may be collected before the dialog is closed.
+        const auto text = std::string(luaL_checkstring(L, 1));
+        const auto caption = std::string(luaL_checkstring(L, 2));
         const auto type = luaL_checkinteger(L, 3);
-        Scheduler::GetSingleton()->ScheduleJob(SchedulerJob(
-                L, [text, caption, type](lua_State *L, std::shared_future<std::function<int(lua_State *)>> *future) {
-                    const int lMessageboxReturn = MessageBoxA(nullptr, text, caption, type);
-
-                    *future = std::async(std::launch::async, [lMessageboxReturn]() -> std::function<int(lua_State *)> {
-                        return [lMessageboxReturn](lua_State *L) -> int {
-                            lua_pushinteger(L, lMessageboxReturn);
-                            return 1;
-                        };
-                    });
-                }));
-
-        L->ci->flags |= 1;
-        return lua_yield(L, 1);
+
+        // The user may take as long as they want to close the dialog.
+        const int lMessageboxReturn = co_await RbxStu::RunOnThreadPool(
+                [&text, &caption, type] { return MessageBoxA(nullptr, text.c_str(), caption.c_str(), type); },
+                RbxStu::NoTimeout);
+
+        lua_pushinteger(L, lMessageboxReturn);
+        co_return 1;
     }
 
     int require(lua_State *L) {
@@ -334,7 +343,11 @@ namespace RbxStu {
 
         auto moduleScript = *static_cast<RBX::ModuleScript **>(lua_touserdata(L, 1));
         moduleScript->m_bIsRobloxScriptModule = true;
-        auto robloxState = Scheduler::GetSingleton()->GetGlobalRobloxState().value();
+        const auto scheduler = SchedulerManager::GetSingleton()->GetSchedulerForState(L);
+        if (!scheduler.has_value())
+            luaG_runerror(L, "Cannot require, the thread does not belong to any DataModel RbxStu executes on!");
+
+        auto robloxState = scheduler.value()->GetGlobalRobloxState().value();
         lua_getglobal(robloxState, "require");
         lua_xmove(robloxState, L, 1);
         lua_pushvalue(L, 1);
@@ -347,7 +360,7 @@ namespace RbxStu {
         return 1;
     }
 
-    int setidentity(lua_State *L) {
+    RbxStu::Task<int> setidentity(lua_State *L) {
         luaL_checkinteger(L, 1);
         auto newIdentity = lua_tointeger(L, 1);
         const auto security = Security::GetSingleton();
@@ -362,17 +375,9 @@ namespace RbxStu {
         }
 
         // Capabilities and identity are applied next resumption cycle, we need to yield!
-        const auto scheduler = Scheduler::GetSingleton();
-        scheduler->ScheduleJob(SchedulerJob(
-                L, [](lua_State *L, std::shared_future<std::function<int(lua_State *)>> *callbackToExecute) {
-                    *callbackToExecute = std::async(std::launch::async, [L]() -> std::function<int(lua_State *)> {
-                        Sleep(1);
-                        return [](lua_State *L) { return 0; };
-                    });
-                }));
-
+        co_await RbxStu::NextSchedulerStep{};
 
-        return lua_yield(L, 0);
+        co_return 0;
     }
 
     int getidentity(lua_State *L) {
@@ -454,7 +459,7 @@ luaL_Reg *Globals::GetLibraryFunctions() {
                                {"setreadonly", RbxStu::setreadonly},
                                {"isreadonly", RbxStu::isreadonly},
                                {"isluau", RbxStu::isluau},
-                               {"httpget", RbxStu::httpget},
+                               {"httpget", RbxStu::YieldingCFunction<RbxStu::httpget>},
                                {"gethui", RbxStu::gethui},
                                {"checkcaller", RbxStu::checkcaller},
                                {"setrawmetatable", RbxStu::setrawmetatable},
@@ -464,10 +469,11 @@ luaL_Reg *Globals::GetLibraryFunctions() {
                                {"loadstring", RbxStu::loadstring},
                                {"lz4compress", RbxStu::lz4compress},
                                {"lz4decompress", RbxStu::lz4decompress},
-                               {"messagebox", RbxStu::messagebox},
-                               {"setidentity", RbxStu::setidentity},
-                               {"setthreadcontext", RbxStu::setidentity},
-                               {"setthreadidentity", RbxStu::setidentity},
+                               {"messagebox", RbxStu::YieldingCFunction<RbxStu::messagebox>},
+                               {"sleep", RbxStu::YieldingCFunction<RbxStu::sleep>},
+                               {"setidentity", RbxStu::YieldingCFunction<RbxStu::setidentity>},
+                               {"setthreadcontext", RbxStu::YieldingCFunction<RbxStu::setidentity>},
+                               {"setthreadidentity", RbxStu::YieldingCFunction<RbxStu::setidentity>},
                                {"setclipboard", RbxStu::setclipboard},
 
                                {"getidentity", RbxStu::getidentity},
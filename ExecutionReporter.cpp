@@ -0,0 +1,162 @@
+#include "ExecutionReporter.hpp"
+
+#include <format>
+#include <vector>
+
+#include "Logger.hpp"
+
+std::shared_ptr<ExecutionReporter> ExecutionReporter::pInstance;
+
+std::shared_ptr<ExecutionReporter> ExecutionReporter::GetSingleton() {
+    if (ExecutionReporter::pInstance == nullptr)
+        ExecutionReporter::pInstance = std::make_shared<ExecutionReporter>();
+
+    return ExecutionReporter::pInstance;
+}
+
+void ExecutionReporter::AppendEvent(const Submission &submission, const RbxStu::Protocol::ExecutionEventKind kind,
+                                    const std::string_view szData) {
+    auto &batch = this->m_mapPendingBatches[submission.pChannel.get()];
+    if (batch.pChannel == nullptr)
+        batch.pChannel = submission.pChannel;
+
+    if ((kind == RbxStu::Protocol::ExecutionEventKind::Output ||
+         kind == RbxStu::Protocol::ExecutionEventKind::Warning) &&
+        batch.szBatch.size() + szData.size() > ExecutionReporter::MaximumBatchSize) {
+        this->m_ullDroppedEvents++;
+        return;
+    }
+
+    RbxStu::Protocol::AppendExecutionEvent(batch.szBatch, submission.ullRequestId, kind, szData);
+}
+
+void ExecutionReporter::EraseSubmission(const std::unordered_map<std::uint64_t, Submission>::iterator submission) {
+    if (!submission->second.szChunkName.empty()) {
+        this->m_mapChunks.erase(submission->second.szChunkName);
+        this->m_ullChunkCount--;
+    }
+
+    this->m_mapSubmissions.erase(submission);
+}
+
+std::uint64_t ExecutionReporter::Register(std::shared_ptr<RbxStu::ReplyChannel> pChannel,
+                                          const std::uint64_t ullRequestId) {
+    if (pChannel == nullptr)
+        return 0;
+
+    pChannel->OnRequestQueued();
+    std::lock_guard lock{this->m_mutex};
+    const auto ullReportId = ++this->m_ullLastReportId;
+    this->m_mapSubmissions.emplace(ullReportId, Submission{ullRequestId, std::move(pChannel), {}});
+    return ullReportId;
+}
+
+void ExecutionReporter::AttachChunk(const std::uint64_t ullReportId, const std::string &szChunkName) {
+    std::lock_guard lock{this->m_mutex};
+    const auto submission = this->m_mapSubmissions.find(ullReportId);
+    if (submission == this->m_mapSubmissions.end() || !submission->second.szChunkName.empty())
+        return;
+
+    submission->second.szChunkName = szChunkName;
+    this->m_mapChunks.emplace(szChunkName, ullReportId);
+    this->m_ullChunkCount++;
+}
+
+void ExecutionReporter::Report(const std::uint64_t ullReportId, const RbxStu::Protocol::ExecutionEventKind kind,
+                               const std::string_view szData) {
+    if (ullReportId == 0)
+        return;
+
+    // The first event on a request is reported as it leaves the Scheduler's queues.
+    std::shared_ptr<RbxStu::ReplyChannel> pDequeuedChannel;
+    {
+        std::lock_guard lock{this->m_mutex};
+        const auto submission = this->m_mapSubmissions.find(ullReportId);
+        if (submission == this->m_mapSubmissions.end())
+            return;
+
+        if (submission->second.bIsQueued) {
+            submission->second.bIsQueued = false;
+            pDequeuedChannel = submission->second.pChannel;
+        }
+
+        this->AppendEvent(submission->second, kind, szData);
+        if (kind == RbxStu::Protocol::ExecutionEventKind::Error ||
+            kind == RbxStu::Protocol::ExecutionEventKind::Completed)
+            this->EraseSubmission(submission);
+    }
+
+    // Called outside the lock, as the transports may take their own.
+    if (pDequeuedChannel != nullptr)
+        pDequeuedChannel->OnRequestDequeued();
+}
+
+void ExecutionReporter::ReportOnChunk(const std::string_view szChunkName,
+                                      const RbxStu::Protocol::ExecutionEventKind kind,
+                                      const std::string_view szData) {
+    if (!this->IsReportingOnChunks())
+        return;
+
+    std::lock_guard lock{this->m_mutex};
+    const auto chunk = this->m_mapChunks.find(std::string{szChunkName});
+    if (chunk == this->m_mapChunks.end())
+        return;
+
+    if (const auto submission = this->m_mapSubmissions.find(chunk->second);
+        submission != this->m_mapSubmissions.end())
+        this->AppendEvent(submission->second, kind, szData);
+}
+
+bool ExecutionReporter::IsReportingOnChunks() const {
+    return this->m_ullChunkCount.load(std::memory_order_relaxed) != 0;
+}
+
+void ExecutionReporter::Flush() {
+    // Schedulers may step concurrently, the batches of one flush must be sent before those of the next.
+    std::lock_guard flushLock{this->m_flushMutex};
+    std::vector<PendingBatch> batches;
+    std::vector<std::shared_ptr<RbxStu::ReplyChannel>> dequeuedChannels;
+    {
+        std::lock_guard lock{this->m_mutex};
+        if (this->m_mapSubmissions.empty() && this->m_mapPendingBatches.empty())
+            return;
+
+        batches.reserve(this->m_mapPendingBatches.size());
+        for (auto &[_, batch]: this->m_mapPendingBatches) {
+            if (!batch.szBatch.empty())
+                batches.emplace_back(std::move(batch));
+        }
+
+        this->m_mapPendingBatches.clear();
+
+        // The requests of clients that are gone will never be read, even if they are still running.
+        for (auto submission = this->m_mapSubmissions.begin(); submission != this->m_mapSubmissions.end();) {
+            const auto current = submission++;
+            if (current->second.pChannel->IsOpen())
+                continue;
+
+            if (current->second.bIsQueued)
+                dequeuedChannels.emplace_back(current->second.pChannel);
+
+            this->EraseSubmission(current);
+        }
+    }
+
+    for (const auto &pChannel: dequeuedChannels)
+        pChannel->OnRequestDequeued();
+
+    // The batches are sent outside the lock, as the transports may take their own.
+    for (auto &batch: batches) {
+        if (!batch.pChannel->IsOpen())
+            continue;
+
+        if (!batch.pChannel->Send(RbxStu::Protocol::SerializeMessage(RbxStu::Protocol::MessageType::ExecutionEvents, 0,
+                                                                     batch.szBatch)))
+            Logger::GetSingleton()->PrintWarning(
+                    RbxStu::ExecutionReporter,
+                    std::format("Dropped {} bytes of execution events, as their client is not keeping up.",
+                                batch.szBatch.size()));
+    }
+}
+
+std::uint64_t ExecutionReporter::GetDroppedEventCount() const { return this->m_ullDroppedEvents; }
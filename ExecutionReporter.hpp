@@ -0,0 +1,128 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "CommunicationProtocol.hpp"
+
+namespace RbxStu {
+    /// @brief The way back to the client that submitted a request, implemented by every transport RbxStu serves.
+    class ReplyChannel {
+    public:
+        virtual ~ReplyChannel() = default;
+
+        /// @brief Sends a whole message to the client, without blocking.
+        /// @param szMessage The message, as serialized by SerializeMessage.
+        /// @return False if the message was dropped, as the client has disconnected or is not keeping up.
+        virtual bool Send(std::string szMessage) = 0;
+
+        /// @brief Obtains whether the client is still connected. Once it is not, it never will be again.
+        [[nodiscard]] virtual bool IsOpen() const = 0;
+
+        /// @brief Called once a request of the client is registered with the ExecutionReporter, before it is queued on
+        /// the Scheduler.
+        virtual void OnRequestQueued() {}
+
+        /// @brief Called once a registered request of the client leaves the Scheduler's queues, as it begins executing
+        /// or is dropped, or once it is forgotten as the client has disconnected. Called at most once per request.
+        virtual void OnRequestDequeued() {}
+    };
+} // namespace RbxStu
+
+/// @brief Reports what happens to the requests of clients back to them, as ExecutionEvents messages.
+/// @remarks Events are appended to a batch per client as they happen, and every batch is sent as a single message
+/// once per Scheduler step, so that a script printing on every iteration of a loop costs a copy into a buffer instead
+/// of a write per line.
+class ExecutionReporter final {
+    /// @brief Private, Static shared pointer into the instance.
+    static std::shared_ptr<ExecutionReporter> pInstance;
+
+    /// @brief The amount of events that may be waiting for a client before Output and Warning events are dropped.
+    /// Compiled, Started, Error and Completed events are never dropped.
+    static constexpr std::size_t MaximumBatchSize = 4 * 1024 * 1024;
+
+    struct Submission {
+        /// @brief The ID of the request, as given by the client.
+        std::uint64_t ullRequestId;
+        std::shared_ptr<RbxStu::ReplyChannel> pChannel;
+        /// @brief The name of the chunk the request has been loaded as, empty until then.
+        std::string szChunkName;
+        /// @brief Whether the request is still waiting in the Scheduler's queues, which it is until its first event.
+        bool bIsQueued = true;
+    };
+
+    struct PendingBatch {
+        std::shared_ptr<RbxStu::ReplyChannel> pChannel;
+        /// @brief The payload of the ExecutionEvents message to send on the next Scheduler step.
+        std::string szBatch;
+    };
+
+    /// @brief Guards the submissions and the pending batches.
+    std::mutex m_mutex;
+    /// @brief Held for the whole of a flush, so that the events of a client are sent in the order they happened.
+    std::mutex m_flushMutex;
+    std::uint64_t m_ullLastReportId = 0;
+    /// @brief The requests that have not ended yet, keyed by their report ID.
+    std::unordered_map<std::uint64_t, Submission> m_mapSubmissions;
+    /// @brief The report IDs of the submissions that have been loaded, keyed by the name of their chunk.
+    std::unordered_map<std::string, std::uint64_t> m_mapChunks;
+    /// @brief The amount of loaded submissions, checked without the lock so that print and warn cost nothing more when
+    /// no client is listening.
+    std::atomic_size_t m_ullChunkCount;
+    std::unordered_map<RbxStu::ReplyChannel *, PendingBatch> m_mapPendingBatches;
+    /// @brief The amount of Output and Warning events dropped as their client was not keeping up.
+    std::atomic_uint64_t m_ullDroppedEvents;
+
+    /// @brief Appends an event to the batch of the client of a submission. Requires the lock.
+    void AppendEvent(const Submission &submission, RbxStu::Protocol::ExecutionEventKind kind,
+                     std::string_view szData);
+
+    /// @brief Forgets a submission. Requires the lock.
+    void EraseSubmission(std::unordered_map<std::uint64_t, Submission>::iterator submission);
+
+public:
+    /// @brief Obtains the shared pointer that points to the global singleton for the current class.
+    /// @return Singleton for ExecutionReporter as a std::shared_ptr<ExecutionReporter>.
+    static std::shared_ptr<ExecutionReporter> GetSingleton();
+
+    /// @brief Begins reporting on a request that has been accepted.
+    /// @param pChannel The channel to the client that submitted it.
+    /// @param ullRequestId The ID of the request, as given by the client.
+    /// @return The report ID the request is to be reported through, or zero if there is no channel to report it on.
+    std::uint64_t Register(std::shared_ptr<RbxStu::ReplyChannel> pChannel, std::uint64_t ullRequestId);
+
+    /// @brief Associates a request with the chunk it has been loaded as, so that the output of the functions of the
+    /// chunk may be attributed to it.
+    /// @param ullReportId The report ID of the request.
+    /// @param szChunkName The name the chunk has been loaded with.
+    void AttachChunk(std::uint64_t ullReportId, const std::string &szChunkName);
+
+    /// @brief Reports an event on a request. Error and Completed events end the reporting on it.
+    /// @param ullReportId The report ID of the request. Events on report ID zero, or on requests that have ended, are
+    /// ignored.
+    /// @param kind What happened to the request.
+    /// @param szData The data of the event.
+    void Report(std::uint64_t ullReportId, RbxStu::Protocol::ExecutionEventKind kind, std::string_view szData = {});
+
+    /// @brief Reports an event on the request that has been loaded as the given chunk, if any.
+    /// @param szChunkName The source of the chunk of the function the event happened on.
+    /// @param kind What happened to the request.
+    /// @param szData The data of the event.
+    void ReportOnChunk(std::string_view szChunkName, RbxStu::Protocol::ExecutionEventKind kind,
+                       std::string_view szData);
+
+    /// @brief Obtains whether any request may be reported through ReportOnChunk, so that callers may skip building its
+    /// data otherwise.
+    [[nodiscard]] bool IsReportingOnChunks() const;
+
+    /// @brief Sends the events of every client as a single message each, forgetting the requests of clients that have
+    /// disconnected. Called by the Scheduler on every step.
+    void Flush();
+
+    /// @brief Obtains the amount of Output and Warning events dropped as their client was not keeping up.
+    [[nodiscard]] std::uint64_t GetDroppedEventCount() const;
+};
@@ -0,0 +1,107 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+/// @brief A lock-free histogram of unsigned integer samples, such as latencies in microseconds.
+/// @remarks Buckets are log-linear: values below 16 get a bucket each, and every power of two above that is split into
+/// eight buckets, so any reported percentile is within 12.5% of the real value. Recording a sample costs a handful of
+/// relaxed atomic operations, so it is safe to do from any thread, including Roblox's.
+class Histogram final {
+public:
+    /// @brief A point-in-time view of the histogram.
+    struct Snapshot {
+        std::uint64_t ullCount;
+        std::uint64_t ullSum;
+        std::uint64_t ullMax;
+        std::uint64_t ullP50;
+        std::uint64_t ullP90;
+        std::uint64_t ullP99;
+    };
+
+private:
+    static constexpr std::size_t LinearBuckets = 16;
+    static constexpr std::size_t SubBucketBits = 3;
+    static constexpr std::size_t SubBuckets = 1 << SubBucketBits;
+    static constexpr std::size_t BucketCount = LinearBuckets + (64 - 4) * SubBuckets;
+
+    std::array<std::atomic_uint64_t, BucketCount> m_aBuckets{};
+    std::atomic_uint64_t m_ullCount = 0;
+    std::atomic_uint64_t m_ullSum = 0;
+    std::atomic_uint64_t m_ullMax = 0;
+
+    static std::size_t GetBucketIndex(const std::uint64_t ullValue) {
+        if (ullValue < LinearBuckets)
+            return static_cast<std::size_t>(ullValue);
+
+        const auto dwMsb = static_cast<std::size_t>(std::bit_width(ullValue)) - 1;
+        const auto dwSubBucket = static_cast<std::size_t>(ullValue >> (dwMsb - SubBucketBits)) & (SubBuckets - 1);
+        return LinearBuckets + (dwMsb - 4) * SubBuckets + dwSubBucket;
+    }
+
+    /// @brief Obtains the largest value that falls into the given bucket.
+    static std::uint64_t GetBucketUpperBound(const std::size_t ullIndex) {
+        if (ullIndex < LinearBuckets)
+            return ullIndex;
+
+        const auto dwMsb = (ullIndex - LinearBuckets) / SubBuckets + 4;
+        const auto dwSubBucket = (ullIndex - LinearBuckets) % SubBuckets;
+        const auto ullWidth = std::uint64_t{1} << (dwMsb - SubBucketBits);
+        return ((SubBuckets + dwSubBucket) << (dwMsb - SubBucketBits)) + ullWidth - 1;
+    }
+
+public:
+    /// @brief Records a sample into the histogram.
+    void Record(const std::uint64_t ullValue) {
+        this->m_aBuckets[GetBucketIndex(ullValue)].fetch_add(1, std::memory_order_relaxed);
+        this->m_ullCount.fetch_add(1, std::memory_order_relaxed);
+        this->m_ullSum.fetch_add(ullValue, std::memory_order_relaxed);
+
+        auto ullMax = this->m_ullMax.load(std::memory_order_relaxed);
+        while (ullValue > ullMax && !this->m_ullMax.compare_exchange_weak(ullMax, ullValue, std::memory_order_relaxed)) {
+        }
+    }
+
+    /// @brief Obtains an approximation of the given percentile of the recorded samples.
+    /// @param dPercentile The percentile to obtain, in the range [0, 1].
+    /// @return The upper bound of the bucket the percentile falls into, clamped to the largest recorded sample.
+    [[nodiscard]] std::uint64_t GetPercentile(const double dPercentile) const {
+        const auto ullCount = this->m_ullCount.load(std::memory_order_relaxed);
+        if (ullCount == 0)
+            return 0;
+
+        const auto ullRank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(dPercentile * ullCount)));
+        std::uint64_t ullSeen = 0;
+        for (std::size_t i = 0; i < BucketCount; i++) {
+            ullSeen += this->m_aBuckets[i].load(std::memory_order_relaxed);
+            if (ullSeen >= ullRank)
+                return std::min(GetBucketUpperBound(i), this->m_ullMax.load(std::memory_order_relaxed));
+        }
+
+        return this->m_ullMax.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Obtains a snapshot of the histogram.
+    /// @remarks Samples recorded whilst the snapshot is being taken may or may not be part of it.
+    [[nodiscard]] Snapshot GetSnapshot() const {
+        return Snapshot{this->m_ullCount.load(std::memory_order_relaxed),
+                        this->m_ullSum.load(std::memory_order_relaxed),
+                        this->m_ullMax.load(std::memory_order_relaxed),
+                        this->GetPercentile(0.50),
+                        this->GetPercentile(0.90),
+                        this->GetPercentile(0.99)};
+    }
+
+    /// @brief Discards every recorded sample.
+    void Reset() {
+        for (auto &bucket: this->m_aBuckets)
+            bucket.store(0, std::memory_order_relaxed);
+
+        this->m_ullCount.store(0, std::memory_order_relaxed);
+        this->m_ullSum.store(0, std::memory_order_relaxed);
+        this->m_ullMax.store(0, std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,156 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace RbxStu {
+    /// @brief The lane a job is queued into. Lanes are drained in this order, each one receiving a share of every step
+    /// proportional to its weight.
+    enum class JobPriority : std::uint8_t {
+        /// @brief Resumptions of threads that yielded on a C function.
+        Resumption,
+        /// @brief Code sent by the user to be executed right away.
+        Interactive,
+        /// @brief Large scripts and bulk execution, which may wait for the lanes above it.
+        Background,
+    };
+
+    /// @brief The prioritized queues of jobs the Scheduler works through when stepping.
+    /// @tparam TJob The type of job queued. It must expose a RbxStu::JobPriority priority and a
+    /// std::chrono::steady_clock::time_point enqueuedAt, as well as GetCost(), returning the credits executing it
+    /// costs, and IsWaiting(), which returns true if the job may not be executed yet.
+    /// @remarks The lanes are drained using deficit round-robin, so every lane makes progress in proportion to its
+    /// weight. Kept free of any Roblox or Windows dependency so it may be exercised outside of Studio.
+    template<typename TJob>
+    class JobLanes final {
+        struct JobLane {
+            /// @brief The jobs queued on the lane, in order of arrival.
+            std::deque<TJob> qJobs;
+            /// @brief The credits the lane receives on every step.
+            std::uint32_t dwWeight;
+            /// @brief The credits the lane has left to spend, carried over between steps while the lane is not empty.
+            std::uint32_t dwDeficit;
+        };
+
+        std::array<JobLane, 3> m_aJobLanes{JobLane{{}, 8, 0}, JobLane{{}, 4, 0}, JobLane{{}, 1, 0}};
+        /// @brief The time after which a queued job is executed regardless of its lane's credits.
+        std::chrono::milliseconds m_msStarvationThreshold{1000};
+        /// @brief Guards the lanes, jobs may be enqueued from any thread.
+        mutable std::mutex m_mutex;
+
+        /// @brief Dequeues the next job the given lane may execute on this step.
+        /// @param lane The lane to dequeue from.
+        /// @param ullVisits The amount of jobs that may still be looked at on the lane, decremented for every job
+        /// visited.
+        /// @param bMayOverdraw Whether the lane may execute a job it cannot afford, as no more important lane has work.
+        /// @return The job to execute, if any. Jobs that are waiting are rotated to the back of the lane.
+        /// @remarks The lock must be held by the caller.
+        std::optional<TJob> Dequeue(JobLane &lane, std::size_t &ullVisits, const bool bMayOverdraw) {
+            const auto now = std::chrono::steady_clock::now();
+            while (ullVisits > 0 && !lane.qJobs.empty()) {
+                ullVisits--;
+                auto job = std::move(lane.qJobs.front());
+                lane.qJobs.pop_front();
+
+                if (job.IsWaiting()) {
+                    // Skipping over a job that may not run yet costs nothing.
+                    lane.qJobs.push_back(std::move(job));
+                    continue;
+                }
+
+                // A job the lane cannot afford waits for the credits of later steps, unless it has waited for too long
+                // already, or nothing more important wants to run.
+                const auto dwCost = job.GetCost();
+                if (const auto bIsStarving = now - job.enqueuedAt >= this->m_msStarvationThreshold;
+                    dwCost > lane.dwDeficit && !bMayOverdraw && !bIsStarving) {
+                    lane.qJobs.push_front(std::move(job));
+                    return {};
+                }
+
+                lane.dwDeficit -= std::min(dwCost, lane.dwDeficit);
+                return job;
+            }
+
+            return {};
+        }
+
+    public:
+        /// @brief Queues a job on the lane matching its priority.
+        /// @remarks Thread-safe.
+        void Enqueue(TJob job) {
+            std::lock_guard lock{this->m_mutex};
+            job.enqueuedAt = std::chrono::steady_clock::now();
+            this->m_aJobLanes[static_cast<std::size_t>(job.priority)].qJobs.emplace_back(std::move(job));
+        }
+
+        /// @brief Executes the jobs every lane may run on this step.
+        /// @param execute Invoked with every job to execute, as a TJob &. It is invoked without the lock held, so it
+        /// may enqueue new jobs.
+        /// @return The amount of jobs executed.
+        template<typename Fn>
+        std::size_t Step(Fn &&execute) {
+            // Every lane with work receives its credits for this step, empty lanes lose whatever they had left, so that
+            // they cannot save up credits to burst later on. A lane only ever looks at the jobs it had when the step
+            // began, as jobs that are executed may enqueue new ones.
+            std::size_t ullExecuted = 0;
+            auto bHigherLanesBusy = false;
+            for (auto &lane: this->m_aJobLanes) {
+                std::size_t ullVisits;
+                {
+                    std::lock_guard lock{this->m_mutex};
+                    if (lane.qJobs.empty()) {
+                        lane.dwDeficit = 0;
+                        continue;
+                    }
+
+                    lane.dwDeficit += lane.dwWeight;
+                    ullVisits = lane.qJobs.size();
+                }
+
+                auto bExecutedAny = false;
+                while (true) {
+                    std::unique_lock lock{this->m_mutex};
+                    auto job = this->Dequeue(lane, ullVisits, !bHigherLanesBusy && !bExecutedAny);
+                    lock.unlock();
+
+                    if (!job.has_value())
+                        break;
+
+                    bExecutedAny = true;
+                    ullExecuted++;
+                    execute(job.value());
+                }
+
+                bHigherLanesBusy |= bExecutedAny;
+            }
+
+            return ullExecuted;
+        }
+
+        /// @brief Removes every queued job from the lanes, in priority order.
+        std::vector<TJob> Clear() {
+            std::lock_guard lock{this->m_mutex};
+            std::vector<TJob> jobs;
+            for (auto &lane: this->m_aJobLanes) {
+                for (auto &job: lane.qJobs)
+                    jobs.emplace_back(std::move(job));
+
+                lane.qJobs.clear();
+                lane.dwDeficit = 0;
+            }
+
+            return jobs;
+        }
+
+        /// @brief Obtains the amount of jobs queued on the lane of the given priority.
+        [[nodiscard]] std::size_t GetQueueDepth(const JobPriority priority) const {
+            std::lock_guard lock{this->m_mutex};
+            return this->m_aJobLanes[static_cast<std::size_t>(priority)].qJobs.size();
+        }
+    };
+} // namespace RbxStu
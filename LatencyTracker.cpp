@@ -0,0 +1,99 @@
+#include "LatencyTracker.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+
+std::shared_ptr<LatencyTracker> LatencyTracker::pInstance;
+
+const char *RbxStu::LatencyStageToString(const LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::Submission:
+            return "Submission";
+        case LatencyStage::QueueWait:
+            return "QueueWait";
+        case LatencyStage::Compile:
+            return "Compile";
+        case LatencyStage::Load:
+            return "Load";
+        case LatencyStage::Handoff:
+            return "Handoff";
+        case LatencyStage::DeferWait:
+            return "DeferWait";
+        case LatencyStage::Execution:
+            return "Execution";
+        case LatencyStage::EndToEnd:
+            return "EndToEnd";
+        case LatencyStage::YieldOperation:
+            return "YieldOperation";
+        case LatencyStage::YieldResumption:
+            return "YieldResumption";
+        default:
+            return "Unknown";
+    }
+}
+
+std::shared_ptr<LatencyTracker> LatencyTracker::GetSingleton() {
+    if (LatencyTracker::pInstance == nullptr)
+        LatencyTracker::pInstance = std::make_shared<LatencyTracker>();
+
+    return LatencyTracker::pInstance;
+}
+
+void LatencyTracker::Record(const RbxStu::LatencyStage stage, const std::chrono::steady_clock::duration duration) {
+    const auto ullMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    this->m_aHistograms[static_cast<std::size_t>(stage)].Record(
+            static_cast<std::uint64_t>(std::max<std::int64_t>(ullMicroseconds, 0)));
+}
+
+void LatencyTracker::Record(const RbxStu::LatencyStage stage, const std::chrono::steady_clock::time_point begin,
+                            const std::chrono::steady_clock::time_point end) {
+    if (begin == std::chrono::steady_clock::time_point{} || end == std::chrono::steady_clock::time_point{})
+        return;
+
+    this->Record(stage, end - begin);
+}
+
+void LatencyTracker::RecordJob(const RbxStu::JobTrace &trace) {
+    this->Record(RbxStu::LatencyStage::Submission, trace.received, trace.queued);
+    this->Record(RbxStu::LatencyStage::QueueWait, trace.queued, trace.compileStart);
+    this->Record(RbxStu::LatencyStage::Compile, trace.compileStart, trace.compileEnd);
+    this->Record(RbxStu::LatencyStage::Load, trace.compileEnd, trace.loaded);
+    this->Record(RbxStu::LatencyStage::Handoff, trace.loaded, trace.handedOff);
+    this->Record(RbxStu::LatencyStage::DeferWait, trace.handedOff, trace.firstResume);
+    this->Record(RbxStu::LatencyStage::Execution, trace.firstResume, trace.completed);
+    this->Record(RbxStu::LatencyStage::EndToEnd, trace.received, trace.completed);
+}
+
+const Histogram &LatencyTracker::GetHistogram(const RbxStu::LatencyStage stage) const {
+    return this->m_aHistograms[static_cast<std::size_t>(stage)];
+}
+
+void LatencyTracker::Reset() {
+    for (auto &histogram: this->m_aHistograms)
+        histogram.Reset();
+}
+
+std::string LatencyTracker::GenerateReport() const {
+    auto szReport = std::format("{:<16} {:>10} {:>12} {:>12} {:>12} {:>12} {:>12}\n", "Stage (us)", "Count", "Mean",
+                                "p50", "p90", "p99", "Max");
+
+    for (std::size_t i = 0; i < this->m_aHistograms.size(); i++) {
+        const auto snapshot = this->m_aHistograms[i].GetSnapshot();
+        szReport += std::format("{:<16} {:>10} {:>12} {:>12} {:>12} {:>12} {:>12}\n",
+                                RbxStu::LatencyStageToString(static_cast<RbxStu::LatencyStage>(i)), snapshot.ullCount,
+                                snapshot.ullCount == 0 ? 0 : snapshot.ullSum / snapshot.ullCount, snapshot.ullP50,
+                                snapshot.ullP90, snapshot.ullP99, snapshot.ullMax);
+    }
+
+    return szReport;
+}
+
+bool LatencyTracker::DumpToFile(const std::filesystem::path &path) const {
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    file << this->GenerateReport();
+    return file.good();
+}
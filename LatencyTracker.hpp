@@ -0,0 +1,92 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "Histogram.hpp"
+
+namespace RbxStu {
+    /// @brief A stage of the Scheduler's pipeline whose latency is tracked.
+    enum class LatencyStage : std::uint8_t {
+        /// @brief From the job being received (i.e. read from the pipe) to it being queued.
+        Submission,
+        /// @brief From the job being queued to the Scheduler picking it up.
+        QueueWait,
+        /// @brief Compiling the Luau source into bytecode.
+        Compile,
+        /// @brief Loading the bytecode into the VM, including native code generation.
+        Load,
+        /// @brief From the closure being loaded to it being handed off to task.defer.
+        Handoff,
+        /// @brief From the handoff to Roblox resuming the thread for the first time.
+        DeferWait,
+        /// @brief From the first resumption to the script completing, including any time spent yielded.
+        Execution,
+        /// @brief From the job being received to the script completing.
+        EndToEnd,
+        /// @brief The time a yielded thread spent waiting on its operation to complete.
+        YieldOperation,
+        /// @brief From a yielding operation completing to the Scheduler resuming the yielded thread.
+        YieldResumption,
+
+        Count,
+    };
+
+    /// @brief Obtains the name of a stage, as used in reports and on the Luau side.
+    const char *LatencyStageToString(LatencyStage stage);
+
+    /// @brief The timestamps of a Luau code job as it goes through the Scheduler.
+    /// @remarks Timestamps that were never taken are left at their default value. Must stay trivially destructible, as
+    /// a copy of it is kept in a Luau userdata until the script completes.
+    struct JobTrace {
+        std::chrono::steady_clock::time_point received;
+        std::chrono::steady_clock::time_point queued;
+        std::chrono::steady_clock::time_point compileStart;
+        std::chrono::steady_clock::time_point compileEnd;
+        std::chrono::steady_clock::time_point loaded;
+        std::chrono::steady_clock::time_point handedOff;
+        std::chrono::steady_clock::time_point firstResume;
+        std::chrono::steady_clock::time_point completed;
+    };
+} // namespace RbxStu
+
+/// @brief Aggregates the latency of every stage of the Scheduler's pipeline into histograms, in microseconds.
+class LatencyTracker final {
+    /// @brief Private, Static shared pointer into the instance.
+    static std::shared_ptr<LatencyTracker> pInstance;
+
+    std::array<Histogram, static_cast<std::size_t>(RbxStu::LatencyStage::Count)> m_aHistograms;
+
+public:
+    /// @brief Obtains the shared pointer that points to the global singleton for the current class.
+    /// @return Singleton for LatencyTracker as a std::shared_ptr<LatencyTracker>.
+    static std::shared_ptr<LatencyTracker> GetSingleton();
+
+    /// @brief Records the latency of a stage.
+    /// @remarks Lock-free, may be called from any thread.
+    void Record(RbxStu::LatencyStage stage, std::chrono::steady_clock::duration duration);
+
+    /// @brief Records the latency of a stage given the timestamps it begins and ends at. If either of them was never
+    /// taken, nothing is recorded.
+    void Record(RbxStu::LatencyStage stage, std::chrono::steady_clock::time_point begin,
+                std::chrono::steady_clock::time_point end);
+
+    /// @brief Records every stage of a completed Luau code job.
+    void RecordJob(const RbxStu::JobTrace &trace);
+
+    /// @brief Obtains the histogram of a stage.
+    [[nodiscard]] const Histogram &GetHistogram(RbxStu::LatencyStage stage) const;
+
+    /// @brief Discards every sample recorded so far.
+    void Reset();
+
+    /// @brief Generates a human-readable table with the count, mean, p50, p90, p99 and max of every stage.
+    [[nodiscard]] std::string GenerateReport() const;
+
+    /// @brief Writes the report generated by GenerateReport into the given file, replacing its contents.
+    /// @return True if the file was written successfully.
+    bool DumpToFile(const std::filesystem::path &path) const;
+};
@@ -0,0 +1,165 @@
+#include "LogFileSink.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+
+/// @brief Truncates a segment that was left untruncated, as happens if the process crashed, to its contents.
+static void TrimSegment(const std::filesystem::path &path) {
+    const auto hFile = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING,
+                                   FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return;
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(hFile, &size) || size.QuadPart == 0) {
+        CloseHandle(hFile);
+        return;
+    }
+
+    auto ullContents = static_cast<std::size_t>(size.QuadPart);
+    if (const auto hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr); hMapping != nullptr) {
+        if (const auto pView = static_cast<const char *>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+            pView != nullptr) {
+            while (ullContents != 0 && pView[ullContents - 1] == '\0')
+                ullContents--;
+
+            UnmapViewOfFile(pView);
+        }
+        CloseHandle(hMapping);
+    }
+
+    LARGE_INTEGER end{};
+    end.QuadPart = static_cast<LONGLONG>(ullContents);
+    if (ullContents != static_cast<std::size_t>(size.QuadPart) && SetFilePointerEx(hFile, end, nullptr, FILE_BEGIN))
+        SetEndOfFile(hFile);
+
+    CloseHandle(hFile);
+}
+
+LogFileSink::LogFileSink(std::filesystem::path directory, std::string szName, const RbxStu::LogFileFormat format,
+                         const std::size_t ullSegmentSize, const std::uint32_t dwSegmentCount)
+    : m_directory(std::move(directory)), m_szName(std::move(szName)), m_format(format),
+      m_ullSegmentSize(std::max(ullSegmentSize, sizeof(RbxStu::BinaryLog::FileHeader) + 1)),
+      m_dwSegmentCount(std::max<std::uint32_t>(dwSegmentCount, 1)) {}
+
+LogFileSink::~LogFileSink() { this->CloseSegment(); }
+
+std::filesystem::path LogFileSink::GetSegmentPath(const std::uint32_t dwIndex) const {
+    const auto szExtension = this->m_format == RbxStu::LogFileFormat::Binary ? "rbxlog" : "log";
+    if (dwIndex == 0)
+        return this->m_directory / std::format("{}.{}", this->m_szName, szExtension);
+
+    return this->m_directory / std::format("{}.{}.{}", this->m_szName, dwIndex, szExtension);
+}
+
+bool LogFileSink::OpenSegment() {
+    const auto hFile = CreateFileW(this->GetSegmentPath(0).c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                                   nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+
+    // The mapping sizes the file, the pages past what has been written being zeroes.
+    const auto ullSize = static_cast<std::uint64_t>(this->m_ullSegmentSize);
+    const auto hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READWRITE, static_cast<DWORD>(ullSize >> 32),
+                                             static_cast<DWORD>(ullSize), nullptr);
+    const auto pView =
+            hMapping != nullptr ? MapViewOfFile(hMapping, FILE_MAP_WRITE, 0, 0, this->m_ullSegmentSize) : nullptr;
+    if (pView == nullptr) {
+        if (hMapping != nullptr)
+            CloseHandle(hMapping);
+
+        CloseHandle(hFile);
+        return false;
+    }
+
+    this->m_hFile = hFile;
+    this->m_hMapping = hMapping;
+    this->m_pView = static_cast<char *>(pView);
+    this->m_ullWritten = 0;
+    if (this->m_format == RbxStu::LogFileFormat::Binary) {
+        constexpr RbxStu::BinaryLog::FileHeader header{RbxStu::BinaryLog::BinaryLogMagic,
+                                                       RbxStu::BinaryLog::BinaryLogVersion, 0};
+        std::memcpy(this->m_pView, &header, sizeof(header));
+        this->m_ullWritten = sizeof(header);
+    }
+
+    return true;
+}
+
+void LogFileSink::CloseSegment() {
+    if (this->m_pView == nullptr)
+        return;
+
+    UnmapViewOfFile(this->m_pView);
+    CloseHandle(this->m_hMapping);
+
+    LARGE_INTEGER end{};
+    end.QuadPart = static_cast<LONGLONG>(this->m_ullWritten);
+    if (SetFilePointerEx(this->m_hFile, end, nullptr, FILE_BEGIN))
+        SetEndOfFile(this->m_hFile);
+
+    CloseHandle(this->m_hFile);
+    this->m_pView = nullptr;
+    this->m_hMapping = nullptr;
+    this->m_hFile = INVALID_HANDLE_VALUE;
+}
+
+void LogFileSink::RotateSegments() const {
+    std::error_code error;
+    std::filesystem::remove(this->GetSegmentPath(this->m_dwSegmentCount - 1), error);
+    for (auto dwIndex = this->m_dwSegmentCount - 1; dwIndex > 0; dwIndex--)
+        std::filesystem::rename(this->GetSegmentPath(dwIndex - 1), this->GetSegmentPath(dwIndex), error);
+}
+
+bool LogFileSink::Open() {
+    std::error_code error;
+    std::filesystem::create_directories(this->m_directory, error);
+    if (error)
+        return false;
+
+    // The segment of the previous session is kept, with whatever it got to write before it ended.
+    if (const auto current = this->GetSegmentPath(0); std::filesystem::exists(current, error)) {
+        if (this->m_format == RbxStu::LogFileFormat::Text)
+            TrimSegment(current);
+
+        this->RotateSegments();
+    }
+
+    return this->OpenSegment();
+}
+
+bool LogFileSink::Write(std::string_view szBytes) {
+    while (!szBytes.empty()) {
+        if (this->m_pView == nullptr)
+            return false;
+
+        if (this->m_ullWritten == this->m_ullSegmentSize && !this->Rotate())
+            return false;
+
+        const auto ullCopied = std::min(szBytes.size(), this->m_ullSegmentSize - this->m_ullWritten);
+        std::memcpy(this->m_pView + this->m_ullWritten, szBytes.data(), ullCopied);
+        this->m_ullWritten += ullCopied;
+        szBytes.remove_prefix(ullCopied);
+    }
+
+    return true;
+}
+
+bool LogFileSink::HasRoomFor(const std::size_t ullSize) const {
+    return this->m_pView != nullptr && this->m_ullSegmentSize - this->m_ullWritten >= ullSize;
+}
+
+bool LogFileSink::Rotate() {
+    this->CloseSegment();
+    this->RotateSegments();
+    return this->OpenSegment();
+}
+
+void LogFileSink::Flush() const {
+    if (this->m_pView == nullptr)
+        return;
+
+    FlushViewOfFile(this->m_pView, this->m_ullWritten);
+    FlushFileBuffers(this->m_hFile);
+}
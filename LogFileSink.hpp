@@ -0,0 +1,72 @@
+#pragma once
+#include <Windows.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "Logger.hpp"
+
+/// @brief Writes the log into pre-sized, memory-mapped segments on disk, rotating them once full.
+/// @remarks The segment being written is "<name>.log", and the ones before it are "<name>.1.log" for the newest up to
+/// "<name>.<count - 1>.log" for the oldest, binary segments using ".rbxlog" instead. Writing into a segment is a copy
+/// into its view, and what was written survives the process crashing, as the pages belong to the file rather than to
+/// the process. Everything past what was written is zeroes until the segment is closed, at which point it is truncated
+/// to its contents; text segments left untruncated by a crash are truncated when the sink is opened again. Binary
+/// segments are not, as their contents may end in zeroes; their readers stop at the first record with a zero type.
+class LogFileSink final {
+    std::filesystem::path m_directory;
+    std::string m_szName;
+    RbxStu::LogFileFormat m_format;
+    std::size_t m_ullSegmentSize;
+    std::uint32_t m_dwSegmentCount;
+
+    HANDLE m_hFile = INVALID_HANDLE_VALUE;
+    HANDLE m_hMapping = nullptr;
+    char *m_pView = nullptr;
+    /// @brief The amount of bytes written into the current segment.
+    std::size_t m_ullWritten = 0;
+
+    /// @brief Obtains the path of the segment with the given index, zero being the one written into.
+    [[nodiscard]] std::filesystem::path GetSegmentPath(std::uint32_t dwIndex) const;
+
+    /// @brief Creates the current segment, sized and mapped.
+    bool OpenSegment();
+
+    /// @brief Unmaps the current segment and truncates it to what was written into it.
+    void CloseSegment();
+
+    /// @brief Shifts every segment one index up, removing the oldest one.
+    void RotateSegments() const;
+
+public:
+    /// @param directory The directory the segments are written into, which is created if missing.
+    /// @param szName The name of the segments, without extension.
+    /// @param format The format of the segments, binary segments begin with a RbxStu::BinaryLog::FileHeader.
+    /// @param ullSegmentSize The size of a segment, the current one is rotated once it is this big.
+    /// @param dwSegmentCount The amount of segments kept, counting the current one.
+    LogFileSink(std::filesystem::path directory, std::string szName, RbxStu::LogFileFormat format,
+                std::size_t ullSegmentSize, std::uint32_t dwSegmentCount);
+    ~LogFileSink();
+
+    LogFileSink(const LogFileSink &) = delete;
+    LogFileSink &operator=(const LogFileSink &) = delete;
+
+    /// @brief Rotates the segments of the previous session and opens a new one.
+    /// @return False if the directory or the segment could not be created.
+    bool Open();
+
+    /// @brief Writes the given bytes, rotating as many segments as necessary.
+    /// @return False if a new segment could not be opened, in which case the sink stops writing.
+    bool Write(std::string_view szBytes);
+
+    /// @brief Obtains whether the given amount of bytes can be written without rotating the current segment.
+    [[nodiscard]] bool HasRoomFor(std::size_t ullSize) const;
+
+    /// @brief Closes the current segment and opens a new one, regardless of how full it is.
+    /// @return False if a new segment could not be opened, in which case the sink stops writing.
+    bool Rotate();
+
+    /// @brief Asks the system to write what was written so far to disk, for it to survive the system going down too.
+    void Flush() const;
+};
@@ -5,16 +5,96 @@
 #include "Logger.hpp"
 
 #include <Termcolor.hpp>
+#include <Windows.h>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstring>
 #include <format>
 #include <iostream>
-#include <mutex>
+#include <map>
+#include <optional>
 #include <shared_mutex>
+#include <thread>
 
+#include "LogFileSink.hpp"
+#include "MetricsRegistry.hpp"
 #include "Roblox/TypeDefinitions.hpp"
 
-std::shared_mutex mutex;
 std::shared_ptr<Logger> Logger::pInstance; // Static var.
 
+/// @brief A fixed-size piece of a message, as copied by the thread that logged it. Messages longer than a record are
+/// carried by several consecutive ones.
+struct LogRecord {
+    RbxStu::LogLevel level;
+    /// @brief Whether the message is only to be written into the binary log files.
+    bool bIsTrace;
+    /// @brief Whether the next record carries the rest of the message.
+    bool bContinues;
+    std::uint16_t wLength;
+    char szText[122];
+};
+static_assert(sizeof(LogRecord) == 128, "Records are meant to span two cache lines exactly!");
+
+/// @brief The level of the sections without a level of their own.
+static std::atomic<RbxStu::LogLevel> s_logLevel{RbxStu::LogLevel::Debug};
+/// @brief Set once any section has a level of its own, so that the levels are only looked up if they may be there.
+static std::atomic_bool s_bHasSectionLogLevels{false};
+static std::shared_mutex s_sectionLogLevelsMutex;
+static std::map<std::string, RbxStu::LogLevel, std::less<>> s_mapSectionLogLevels;
+
+/// @brief The rate limit and sampling of a section, see Logger::SetSectionRateLimit and Logger::SetSectionSampling.
+struct SectionLimit {
+    std::mutex mutex;
+    /// @brief The messages admitted per second, zero if unlimited.
+    double dRate = 0;
+    /// @brief The messages that may be admitted at once, after the section was quiet for a while.
+    double dBurst = 0;
+    double dTokens = 0;
+    std::chrono::steady_clock::time_point lastRefill;
+    /// @brief One in how many messages is admitted, one if all of them are.
+    std::uint32_t dwSampleEvery = 1;
+    std::uint64_t ullSampled = 0;
+    /// @brief The messages seen and suppressed since they were last reported.
+    std::uint64_t ullSeen = 0;
+    std::uint64_t ullSuppressed = 0;
+    /// @brief Every message ever suppressed, exported as rbxstu_log_records_dropped_total.
+    RbxStu::Metrics::Counter *pDropped = nullptr;
+};
+
+/// @brief Set once any section has a limit, so that the limits are only looked up if they may be there.
+static std::atomic_bool s_bHasSectionLimits{false};
+static std::shared_mutex s_sectionLimitsMutex;
+/// @brief Limits are never removed, only lifted, so that their suppressed messages are still reported.
+static std::map<std::string, std::unique_ptr<SectionLimit>, std::less<>> s_mapSectionLimits;
+
+/// @brief Set whilst binary log files are being written.
+static std::atomic_bool s_bIsTracing{false};
+
+static_assert(std::size(RbxStu::BinaryLog::LevelNames) == static_cast<std::size_t>(RbxStu::LogLevel::None),
+              "Every level must have a name in binary log files!");
+
+/// @brief A single-producer, single-consumer ring of records, written by a single thread and read by whichever thread
+/// holds the write lock of the Logger.
+struct Logger::ThreadBuffer {
+    /// @brief The amount of records in the ring, a power of two.
+    static constexpr std::size_t Capacity = 512;
+
+    /// @brief Written by the thread only, once the records before it have been copied.
+    alignas(64) std::atomic_size_t ullWriteIndex;
+    /// @brief Written by the reader only, once the records before it have been written out.
+    alignas(64) std::atomic_size_t ullReadIndex;
+    /// @brief Set once the thread has exited. The buffer is dropped once it has been written out.
+    std::atomic_bool bIsAbandoned;
+    /// @brief The ID of the thread.
+    std::uint32_t dwThreadId;
+    /// @brief The message being reassembled from records, should its records not have arrived whole yet. Only accessed
+    /// by the reader.
+    std::string szPartialLine;
+    std::array<LogRecord, Capacity> records;
+};
+
 std::shared_ptr<Logger> Logger::GetSingleton() {
     if (Logger::pInstance == nullptr)
         Logger::pInstance = std::make_shared<Logger>();
@@ -22,33 +102,201 @@ std::shared_ptr<Logger> Logger::GetSingleton() {
     return Logger::pInstance;
 }
 
+Logger::ThreadBuffer *Logger::GetThreadBuffer() {
+    struct ThreadBufferOwner {
+        std::shared_ptr<ThreadBuffer> pBuffer;
+        ~ThreadBufferOwner() {
+            if (this->pBuffer != nullptr)
+                this->pBuffer->bIsAbandoned.store(true, std::memory_order_release);
+        }
+    };
+    thread_local ThreadBufferOwner owner;
+
+    if (owner.pBuffer == nullptr) {
+        owner.pBuffer = std::make_shared<ThreadBuffer>();
+        owner.pBuffer->dwThreadId = GetCurrentThreadId();
+        std::lock_guard lock{this->m_buffersMutex};
+        this->m_threadBuffers.emplace_back(owner.pBuffer);
+    }
+
+    return owner.pBuffer.get();
+}
+
+void Logger::WakeWriter() {
+    // Pairs with the fence of the logging thread, either it sees the records or we see it waiting.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!this->m_bIsWriterWaiting.load(std::memory_order_relaxed))
+        return;
+
+    this->m_dwWakeSequence.fetch_add(1, std::memory_order_release);
+    this->m_dwWakeSequence.notify_one();
+}
+
+std::int64_t Logger::GetTimestamp() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+}
+
+void Logger::Enqueue(const RbxStu::LogLevel level, const bool bIsTrace,
+                     const std::span<const std::string_view> pieces) {
+    if (!this->m_bInitialized)
+        throw std::exception(
+                std::format("The logger instance @ {} is not initialized!", reinterpret_cast<uintptr_t>(this)).c_str());
+
+    const auto pBuffer = this->GetThreadBuffer();
+    auto ullWriteIndex = pBuffer->ullWriteIndex.load(std::memory_order_relaxed);
+    LogRecord *pRecord = nullptr;
+
+    for (auto szPiece: pieces) {
+        while (!szPiece.empty()) {
+            if (pRecord == nullptr || pRecord->wLength == sizeof(LogRecord::szText)) {
+                if (pRecord != nullptr) {
+                    pRecord->bContinues = true;
+                    ullWriteIndex++;
+                }
+
+                // Messages are never dropped, the thread waits for the logging thread to make room instead.
+                while (ullWriteIndex - pBuffer->ullReadIndex.load(std::memory_order_acquire) ==
+                       ThreadBuffer::Capacity) {
+                    pBuffer->ullWriteIndex.store(ullWriteIndex, std::memory_order_release);
+                    this->WakeWriter();
+                    std::this_thread::yield();
+                }
+
+                pRecord = &pBuffer->records[ullWriteIndex & (ThreadBuffer::Capacity - 1)];
+                pRecord->level = level;
+                pRecord->bIsTrace = bIsTrace;
+                pRecord->wLength = 0;
+                pRecord->bContinues = false;
+            }
+
+            const auto ullCopied = std::min(szPiece.size(), sizeof(LogRecord::szText) - pRecord->wLength);
+            std::memcpy(pRecord->szText + pRecord->wLength, szPiece.data(), ullCopied);
+            pRecord->wLength += static_cast<std::uint16_t>(ullCopied);
+            szPiece.remove_prefix(ullCopied);
+        }
+    }
+
+    pBuffer->ullWriteIndex.store(ullWriteIndex + 1, std::memory_order_release);
+    this->WakeWriter();
+}
+
+void Logger::EnqueueText(const RbxStu::LogLevel level, const bool bIsTrace, const std::string_view sectionName,
+                         const std::string_view msg) {
+    const MessageHeader header{nullptr, nullptr, nullptr, 0, static_cast<std::uint32_t>(sectionName.size()),
+                               Logger::GetTimestamp()};
+    const std::string_view pieces[] = {{reinterpret_cast<const char *>(&header), sizeof(header)}, sectionName, msg};
+    this->Enqueue(level, bIsTrace, pieces);
+}
+
+void Logger::WriteLine(const RbxStu::LogLevel level, const std::string &szLine) {
+    auto messageType = RBX::Console::MessageType::Standard;
+    if (level == RbxStu::LogLevel::Information)
+        messageType = RBX::Console::MessageType::InformationBlue;
+    else if (level == RbxStu::LogLevel::Warning)
+        messageType = RBX::Console::MessageType::Warning;
+    else if (level == RbxStu::LogLevel::Error)
+        messageType = RBX::Console::MessageType::Error;
+
+    if (this->m_pFileSink != nullptr && this->m_fileFormat == RbxStu::LogFileFormat::Text) {
+        this->m_szFileBatch.append(szLine);
+        this->m_szFileBatch.push_back('\n');
+    }
 
-void Logger::Flush(const RBX::Console::MessageType messageType) {
-    // TODO: Implement flushing to file.
     switch (messageType) {
         case RBX::Console::MessageType::Error:
-            std::cout << termcolor::bright_red << this->m_szMessageBuffer << termcolor::reset << std::endl;
+            std::cout << termcolor::bright_red << szLine << termcolor::reset << '\n';
             break;
         case RBX::Console::MessageType::InformationBlue:
-            std::cout << termcolor::bright_blue << this->m_szMessageBuffer << termcolor::reset << std::endl;
+            std::cout << termcolor::bright_blue << szLine << termcolor::reset << '\n';
             break;
         case RBX::Console::MessageType::Warning:
-            std::cout << termcolor::bright_yellow << this->m_szMessageBuffer << termcolor::reset << std::endl;
+            std::cout << termcolor::bright_yellow << szLine << termcolor::reset << '\n';
             break;
         case RBX::Console::MessageType::Standard:
-            std::cout << this->m_szMessageBuffer << std::endl;
+            std::cout << szLine << '\n';
             break;
     }
-    this->m_szMessageBuffer.clear();
+
+    for (const auto &listener: this->m_outputListeners)
+        listener(messageType, szLine);
 }
 
-void Logger::FlushIfFull(const RBX::Console::MessageType messageType) {
-    if (!this->m_bInitialized)
-        throw std::exception(
-                std::format("The logger instance @ {} is not initialized!", reinterpret_cast<uintptr_t>(this)).c_str());
+bool Logger::WritePending() {
+    {
+        std::lock_guard lock{this->m_buffersMutex};
+        std::erase_if(this->m_threadBuffers, [](const std::shared_ptr<ThreadBuffer> &pBuffer) {
+            return pBuffer->bIsAbandoned.load(std::memory_order_acquire) &&
+                   pBuffer->ullReadIndex.load(std::memory_order_relaxed) ==
+                           pBuffer->ullWriteIndex.load(std::memory_order_acquire);
+        });
+        this->m_writingBuffers = this->m_threadBuffers;
+    }
+
+    // Messages are in order for every thread, but not across threads.
+    bool bWritten = false;
+    for (const auto &pBuffer: this->m_writingBuffers) {
+        const auto ullFirstIndex = pBuffer->ullReadIndex.load(std::memory_order_relaxed);
+        const auto ullWriteIndex = pBuffer->ullWriteIndex.load(std::memory_order_acquire);
+        for (auto ullReadIndex = ullFirstIndex; ullReadIndex != ullWriteIndex; ullReadIndex++) {
+            const auto &record = pBuffer->records[ullReadIndex & (ThreadBuffer::Capacity - 1)];
+            pBuffer->szPartialLine.append(record.szText, record.wLength);
+            if (!record.bContinues) {
+                if (this->m_pFileSink != nullptr && this->m_fileFormat == RbxStu::LogFileFormat::Binary)
+                    this->WriteBinaryMessage(record.level, pBuffer->dwThreadId, pBuffer->szPartialLine);
+
+                if (!record.bIsTrace)
+                    this->WriteLine(record.level, Logger::FormatMessage(record.level, pBuffer->szPartialLine));
+
+                pBuffer->szPartialLine.clear();
+            }
+        }
+
+        if (ullWriteIndex != ullFirstIndex) {
+            pBuffer->ullReadIndex.store(ullWriteIndex, std::memory_order_release);
+            bWritten = true;
+        }
+    }
+
+    // The file sink gets the batch in a single write.
+    if (!this->m_szFileBatch.empty()) {
+        if (this->m_pFileSink != nullptr && !this->m_pFileSink->Write(this->m_szFileBatch))
+            this->DisableFileSink();
+
+        this->m_szFileBatch.clear();
+    }
 
-    if (this->m_bInstantFlush || this->m_szMessageBuffer.length() >= this->m_dwBufferSize)
-        this->Flush(messageType);
+    if (bWritten && this->m_bInstantFlush)
+        std::cout.flush();
+
+    return bWritten;
+}
+
+void Logger::WriterThread() {
+    while (true) {
+        {
+            std::lock_guard lock{this->m_writeMutex};
+            if (this->WritePending())
+                continue;
+        }
+
+        const auto dwWakeSequence = this->m_dwWakeSequence.load(std::memory_order_acquire);
+        this->m_bIsWriterWaiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        // Records may have arrived before the threads could see us waiting.
+        bool bWritten;
+        {
+            std::lock_guard lock{this->m_writeMutex};
+            bWritten = this->WritePending();
+        }
+
+        if (!bWritten)
+            this->m_dwWakeSequence.wait(dwWakeSequence, std::memory_order_acquire);
+
+        this->m_bIsWriterWaiting.store(false, std::memory_order_relaxed);
+    }
 }
 
 void Logger::Initialize(const bool bInstantFlush) {
@@ -58,32 +306,383 @@ void Logger::Initialize(const bool bInstantFlush) {
     freopen_s(reinterpret_cast<FILE **>(stdout), "CONOUT$", "w", stdout);
     freopen_s(reinterpret_cast<FILE **>(stdin), "CONIN$", "r", stdin);
     freopen_s(reinterpret_cast<FILE **>(stderr), "CONOUT$", "w", stderr);
-    this->m_dwBufferSize = 0xffff;
-    this->m_szMessageBuffer = std::string("");
-    this->m_szMessageBuffer.reserve(this->m_dwBufferSize);
     this->m_bInstantFlush = bInstantFlush;
     this->m_bInitialized = true;
-    std::atexit([] {
-        const auto logger = Logger::GetSingleton();
-        logger->Flush(RBX::Console::Standard);
-        logger->m_szMessageBuffer.clear();
+    std::thread([this] { this->WriterThread(); }).detach();
+    std::atexit([] { Logger::GetSingleton()->Flush(); });
+}
+
+bool Logger::IsEnabled(const RbxStu::LogLevel level, const std::string_view sectionName) {
+    if (s_bHasSectionLogLevels.load(std::memory_order_acquire)) {
+        std::shared_lock lock{s_sectionLogLevelsMutex};
+        if (const auto sectionLevel = s_mapSectionLogLevels.find(sectionName);
+            sectionLevel != s_mapSectionLogLevels.end())
+            return level >= sectionLevel->second;
+    }
+
+    return level >= s_logLevel.load(std::memory_order_relaxed);
+}
+
+void Logger::SetLogLevel(const RbxStu::LogLevel level) { s_logLevel.store(level, std::memory_order_relaxed); }
+
+void Logger::SetSectionLogLevel(const std::string_view sectionName, const RbxStu::LogLevel level) {
+    std::unique_lock lock{s_sectionLogLevelsMutex};
+    s_mapSectionLogLevels.insert_or_assign(std::string{sectionName}, level);
+    s_bHasSectionLogLevels.store(true, std::memory_order_release);
+}
+
+bool Logger::ShouldLog(const RbxStu::LogLevel level, const std::string_view sectionName) {
+    if (!Logger::IsEnabled(level, sectionName))
+        return false;
+
+    if (!s_bHasSectionLimits.load(std::memory_order_acquire))
+        return true;
+
+    std::shared_lock lock{s_sectionLimitsMutex};
+    const auto sectionLimit = s_mapSectionLimits.find(sectionName);
+    if (sectionLimit == s_mapSectionLimits.end())
+        return true;
+
+    auto &limit = *sectionLimit->second;
+    std::lock_guard limitLock{limit.mutex};
+    limit.ullSeen++;
+    if (limit.dwSampleEvery > 1 && limit.ullSampled++ % limit.dwSampleEvery != 0) {
+        limit.ullSuppressed++;
+        limit.pDropped->Increment();
+        return false;
+    }
+
+    if (limit.dRate > 0) {
+        const auto now = std::chrono::steady_clock::now();
+        const auto dElapsed = std::chrono::duration<double>(now - limit.lastRefill).count();
+        limit.dTokens = std::min(limit.dBurst, limit.dTokens + dElapsed * limit.dRate);
+        limit.lastRefill = now;
+        if (limit.dTokens < 1) {
+            limit.ullSuppressed++;
+            limit.pDropped->Increment();
+            return false;
+        }
+
+        limit.dTokens -= 1;
+    }
+
+    return true;
+}
+
+/// @brief Obtains the limit of a section, creating it if it has none. Requires s_sectionLimitsMutex, exclusively.
+static SectionLimit &GetSectionLimit(const std::string_view sectionName) {
+    auto sectionLimit = s_mapSectionLimits.find(sectionName);
+    if (sectionLimit == s_mapSectionLimits.end()) {
+        sectionLimit = s_mapSectionLimits.emplace(sectionName, std::make_unique<SectionLimit>()).first;
+        sectionLimit->second->pDropped = &MetricsRegistry::GetSingleton()->GetCounter(
+                "rbxstu_log_records_dropped_total",
+                "The log messages suppressed, as their section is rate limited or sampled.",
+                {{"section", std::string{sectionName}}});
+    }
+
+    s_bHasSectionLimits.store(true, std::memory_order_release);
+    return *sectionLimit->second;
+}
+
+void Logger::StartSuppressionReports() {
+    static std::once_flag startFlag;
+    std::call_once(startFlag, [] {
+        std::thread([] {
+            while (true) {
+                std::this_thread::sleep_for(Logger::SuppressionReportInterval);
+                Logger::GetSingleton()->ReportSuppressedMessages();
+            }
+        }).detach();
     });
 }
 
-void Logger::PrintInformation(const std::string &sectionName, const std::string &msg) {
-    std::lock_guard lock{mutex};
-    this->m_szMessageBuffer.append(std::format("[INFO/{}] {}", sectionName, msg));
-    this->FlushIfFull(RBX::Console::InformationBlue);
+void Logger::ReportSuppressedMessages() {
+    if (!this->m_bInitialized)
+        return;
+
+    std::vector<std::tuple<std::string, std::uint64_t, std::uint64_t>> reports;
+    {
+        std::shared_lock lock{s_sectionLimitsMutex};
+        for (const auto &[sectionName, pLimit]: s_mapSectionLimits) {
+            std::lock_guard limitLock{pLimit->mutex};
+            if (pLimit->ullSuppressed != 0)
+                reports.emplace_back(sectionName, pLimit->ullSuppressed, pLimit->ullSeen);
+
+            pLimit->ullSuppressed = 0;
+            pLimit->ullSeen = 0;
+        }
+    }
+
+    // Reports bypass the limits, as they are what keeps the suppressed messages from going unnoticed.
+    for (const auto &[sectionName, ullSuppressed, ullSeen]: reports) {
+        this->EnqueueText(RbxStu::LogLevel::Warning, false, sectionName,
+                          std::format("Suppressed {} of the {} messages logged in the last {} seconds, as the section "
+                                      "is rate limited or sampled.",
+                                      ullSuppressed, ullSeen, Logger::SuppressionReportInterval.count()));
+    }
+}
+
+void Logger::SetSectionRateLimit(const std::string_view sectionName, const double dMessagesPerSecond,
+                                 const std::uint32_t dwBurst) {
+    {
+        std::unique_lock lock{s_sectionLimitsMutex};
+        auto &limit = GetSectionLimit(sectionName);
+        std::lock_guard limitLock{limit.mutex};
+        limit.dRate = std::max(dMessagesPerSecond, 0.0);
+        limit.dBurst = dwBurst != 0 ? dwBurst : std::max(limit.dRate, 1.0);
+        limit.dTokens = limit.dBurst;
+        limit.lastRefill = std::chrono::steady_clock::now();
+    }
+
+    Logger::StartSuppressionReports();
+}
+
+void Logger::SetSectionSampling(const std::string_view sectionName, const std::uint32_t dwSampleEvery) {
+    {
+        std::unique_lock lock{s_sectionLimitsMutex};
+        auto &limit = GetSectionLimit(sectionName);
+        std::lock_guard limitLock{limit.mutex};
+        limit.dwSampleEvery = std::max<std::uint32_t>(dwSampleEvery, 1);
+        limit.ullSampled = 0;
+    }
+
+    Logger::StartSuppressionReports();
+}
+
+bool Logger::ConfigureLogLimits(const std::string_view szConfiguration) {
+    struct ParsedLimit {
+        std::string_view sectionName;
+        std::optional<double> dRate;
+        std::optional<std::uint32_t> dwSampleEvery;
+    };
+    std::vector<ParsedLimit> limits;
+
+    for (std::size_t ullStart = 0; ullStart <= szConfiguration.size();) {
+        const auto ullEnd = std::min(szConfiguration.find(',', ullStart), szConfiguration.size());
+        const auto szPart = szConfiguration.substr(ullStart, ullEnd - ullStart);
+        ullStart = ullEnd + 1;
+        if (szPart.empty())
+            continue;
+
+        const auto ullEquals = szPart.rfind('=');
+        if (ullEquals == std::string_view::npos || ullEquals == 0)
+            return false;
+
+        const auto sectionName = szPart.substr(0, ullEquals);
+        const auto szLimit = szPart.substr(ullEquals + 1);
+        if (szLimit == "off") {
+            limits.push_back({sectionName, 0.0, 1});
+            continue;
+        }
+
+        // "<rate>/s" limits the rate, "1/<n>" samples one in n messages.
+        const auto ullSlash = szLimit.find('/');
+        if (ullSlash == std::string_view::npos)
+            return false;
+
+        const auto szNumerator = szLimit.substr(0, ullSlash);
+        const auto szDenominator = szLimit.substr(ullSlash + 1);
+        if (szDenominator == "s") {
+            double dRate = 0;
+            if (const auto [pEnd, error] = std::from_chars(szNumerator.data(), szNumerator.data() + szNumerator.size(),
+                                                           dRate);
+                error != std::errc{} || pEnd != szNumerator.data() + szNumerator.size() || dRate <= 0)
+                return false;
+
+            limits.push_back({sectionName, dRate, {}});
+        } else {
+            std::uint32_t dwSampleEvery = 0;
+            if (const auto [pEnd, error] = std::from_chars(
+                        szDenominator.data(), szDenominator.data() + szDenominator.size(), dwSampleEvery);
+                szNumerator != "1" || error != std::errc{} || pEnd != szDenominator.data() + szDenominator.size() ||
+                dwSampleEvery == 0)
+                return false;
+
+            limits.push_back({sectionName, {}, dwSampleEvery});
+        }
+    }
+
+    for (const auto &[sectionName, dRate, dwSampleEvery]: limits) {
+        if (dRate.has_value())
+            Logger::SetSectionRateLimit(sectionName, dRate.value());
+        if (dwSampleEvery.has_value())
+            Logger::SetSectionSampling(sectionName, dwSampleEvery.value());
+    }
+
+    return true;
+}
+
+/// @brief Parses the name of a level, as written in a level configuration.
+static std::optional<RbxStu::LogLevel> ParseLogLevel(const std::string_view szLevel) {
+    static const std::map<std::string_view, RbxStu::LogLevel> levels{{"Debug", RbxStu::LogLevel::Debug},
+                                                                     {"Information", RbxStu::LogLevel::Information},
+                                                                     {"Warning", RbxStu::LogLevel::Warning},
+                                                                     {"Error", RbxStu::LogLevel::Error},
+                                                                     {"None", RbxStu::LogLevel::None}};
+    if (const auto level = levels.find(szLevel); level != levels.end())
+        return level->second;
+
+    return {};
+}
+
+bool Logger::ConfigureLogLevels(const std::string_view szConfiguration) {
+    std::optional<RbxStu::LogLevel> defaultLevel;
+    std::vector<std::pair<std::string_view, RbxStu::LogLevel>> sectionLevels;
+
+    for (std::size_t ullStart = 0; ullStart <= szConfiguration.size();) {
+        const auto ullEnd = std::min(szConfiguration.find(',', ullStart), szConfiguration.size());
+        const auto szPart = szConfiguration.substr(ullStart, ullEnd - ullStart);
+        ullStart = ullEnd + 1;
+        if (szPart.empty())
+            continue;
+
+        if (const auto ullEquals = szPart.find('='); ullEquals != std::string_view::npos) {
+            const auto level = ParseLogLevel(szPart.substr(ullEquals + 1));
+            if (!level.has_value() || ullEquals == 0)
+                return false;
+
+            sectionLevels.emplace_back(szPart.substr(0, ullEquals), level.value());
+        } else {
+            defaultLevel = ParseLogLevel(szPart);
+            if (!defaultLevel.has_value())
+                return false;
+        }
+    }
+
+    if (defaultLevel.has_value())
+        Logger::SetLogLevel(defaultLevel.value());
+
+    for (const auto &[sectionName, level]: sectionLevels)
+        Logger::SetSectionLogLevel(sectionName, level);
+
+    return true;
+}
+
+std::string Logger::FormatMessage(const RbxStu::LogLevel level, const std::string_view szMessage) {
+    MessageHeader header;
+    std::memcpy(&header, szMessage.data(), sizeof(header));
+    const auto szSection = szMessage.substr(sizeof(header), header.dwSectionLength);
+    const auto szArguments = szMessage.substr(sizeof(header) + header.dwSectionLength);
+    if (header.pFormatter == nullptr)
+        return std::format("[{}/{}] {}", Logger::GetLevelName(level), szSection, szArguments);
+
+    std::string szText;
+    try {
+        szText = header.pFormatter({header.pFormat, header.dwFormatLength}, szArguments);
+    } catch (const std::format_error &ex) {
+        szText = std::format("<failed to format '{}': {}>", std::string_view{header.pFormat, header.dwFormatLength},
+                             ex.what());
+    }
+
+    return std::format("[{}/{}] {}", Logger::GetLevelName(level), szSection, szText);
+}
+
+std::uint32_t Logger::GetBinaryStringId(const std::string_view szString) {
+    if (const auto string = this->m_mapBinaryStrings.find(szString); string != this->m_mapBinaryStrings.end())
+        return string->second;
+
+    const auto dwId = static_cast<std::uint32_t>(this->m_mapBinaryStrings.size());
+    this->m_mapBinaryStrings.emplace(szString, dwId);
+    RbxStu::BinaryLog::AppendStringRecord(this->m_szBinaryRecords, dwId, szString);
+    return dwId;
+}
+
+void Logger::WriteBinaryMessage(const RbxStu::LogLevel level, const std::uint32_t dwThreadId,
+                                const std::string_view szMessage) {
+    using namespace RbxStu::BinaryLog;
+    MessageHeader header;
+    std::memcpy(&header, szMessage.data(), sizeof(header));
+    const auto szSection = szMessage.substr(sizeof(header), header.dwSectionLength);
+    const auto szArguments = szMessage.substr(sizeof(header) + header.dwSectionLength);
+
+    // Files are decoded on their own, so a message must never refer to strings written into the file before it.
+    for (auto bHasRotated = false;; bHasRotated = true) {
+        this->m_szBinaryRecords.clear();
+        const auto dwSectionId = this->GetBinaryStringId(szSection);
+        const auto dwFormatId = this->GetBinaryStringId(
+                header.pEncoder != nullptr ? std::string_view{header.pFormat, header.dwFormatLength} : "{}");
+
+        const auto ullRecord = BeginRecord(this->m_szBinaryRecords, RecordType::Message);
+        const auto ullMessage = this->m_szBinaryRecords.size();
+        AppendValue(this->m_szBinaryRecords, MessageRecord{static_cast<std::uint8_t>(level), 0, 0, dwThreadId,
+                                                           dwSectionId, dwFormatId, header.llTimestamp});
+        std::uint8_t bArgumentCount = 1;
+        if (header.pEncoder != nullptr)
+            bArgumentCount = header.pEncoder(szArguments, this->m_szBinaryRecords);
+        else
+            AppendStringArgument(this->m_szBinaryRecords, szArguments);
+
+        this->m_szBinaryRecords[ullMessage + offsetof(MessageRecord, bArgumentCount)] =
+                static_cast<char>(bArgumentCount);
+        EndRecord(this->m_szBinaryRecords, ullRecord);
+
+        if (bHasRotated || this->m_pFileSink->HasRoomFor(this->m_szBinaryRecords.size()))
+            break;
+
+        if (!this->m_pFileSink->Rotate()) {
+            this->DisableFileSink();
+            return;
+        }
+
+        this->m_mapBinaryStrings.clear();
+    }
+
+    if (!this->m_pFileSink->Write(this->m_szBinaryRecords))
+        this->DisableFileSink();
+}
+
+void Logger::DisableFileSink() {
+    // We must not log, as we are the ones writing.
+    std::cout << termcolor::bright_red
+              << "[ERROR/RbxStu::Logger] Failed to open a new log file, no longer writing into log files!"
+              << termcolor::reset << '\n';
+    this->m_pFileSink = nullptr;
+    s_bIsTracing.store(false, std::memory_order_relaxed);
 }
 
-void Logger::PrintWarning(const std::string &sectionName, const std::string &msg) {
-    std::lock_guard lock{mutex};
-    this->m_szMessageBuffer.append(std::format("[WARN/{}] {}", sectionName, msg));
-    this->FlushIfFull(RBX::Console::Warning);
+void Logger::PrintInformation(const std::string_view sectionName, const std::string_view msg) {
+    if (Logger::ShouldLog(RbxStu::LogLevel::Information, sectionName))
+        this->EnqueueText(RbxStu::LogLevel::Information, false, sectionName, msg);
 }
 
-void Logger::PrintError(const std::string &sectionName, const std::string &msg) {
-    std::lock_guard lock{mutex};
-    this->m_szMessageBuffer.append(std::format("[ERROR/{}] {}", sectionName, msg));
-    this->FlushIfFull(RBX::Console::Error);
+void Logger::PrintWarning(const std::string_view sectionName, const std::string_view msg) {
+    if (Logger::ShouldLog(RbxStu::LogLevel::Warning, sectionName))
+        this->EnqueueText(RbxStu::LogLevel::Warning, false, sectionName, msg);
+}
+
+void Logger::PrintError(const std::string_view sectionName, const std::string_view msg) {
+    if (Logger::ShouldLog(RbxStu::LogLevel::Error, sectionName))
+        this->EnqueueText(RbxStu::LogLevel::Error, false, sectionName, msg);
+}
+
+void Logger::Flush() {
+    std::unique_lock lock{this->m_writeMutex, std::defer_lock};
+    if (!lock.try_lock_for(std::chrono::seconds{1}))
+        return;
+
+    this->WritePending();
+    std::cout.flush();
+    if (this->m_pFileSink != nullptr)
+        this->m_pFileSink->Flush();
+}
+
+bool Logger::EnableFileSink(const std::filesystem::path &directory, const RbxStu::LogFileFormat format,
+                            const std::size_t ullSegmentSize, const std::uint32_t dwSegmentCount) {
+    const auto pFileSink = std::make_shared<LogFileSink>(directory, "RbxStu", format, ullSegmentSize, dwSegmentCount);
+    if (!pFileSink->Open())
+        return false;
+
+    std::lock_guard lock{this->m_writeMutex};
+    this->m_pFileSink = pFileSink;
+    this->m_fileFormat = format;
+    this->m_mapBinaryStrings.clear();
+    s_bIsTracing.store(format == RbxStu::LogFileFormat::Binary, std::memory_order_relaxed);
+    return true;
+}
+
+bool Logger::IsTracing() { return s_bIsTracing.load(std::memory_order_relaxed); }
+
+void Logger::AddOutputListener(OutputListener listener) {
+    std::lock_guard lock{this->m_writeMutex};
+    this->m_outputListeners.emplace_back(std::move(listener));
 }
@@ -3,55 +3,408 @@
 //
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <span>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
+#include "BinaryLogFormat.hpp"
 #include "Roblox/TypeDefinitions.hpp"
 
+namespace RbxStu {
+    /// @brief The severity of a message. Messages below the minimum level, be it the one RbxStu was compiled with or
+    /// the one configured at runtime, are never logged.
+    /// @remarks Trace is the level of the messages logged through RbxStuTrace, which are not subject to the levels.
+    enum class LogLevel : std::uint8_t { Trace = 0, Debug = 1, Information = 2, Warning = 3, Error = 4, None = 5 };
+
+    /// @brief The format log files are written in.
+    enum class LogFileFormat : std::uint8_t {
+        /// @brief The messages as printed to the standard output, a line each.
+        Text,
+        /// @brief The messages with their arguments, unformatted, see BinaryLogFormat.hpp. Enables RbxStuTrace.
+        Binary,
+    };
+} // namespace RbxStu
+
+#ifndef RBXSTU_MINIMUM_LOG_LEVEL
+#if _DEBUG
+#define RBXSTU_MINIMUM_LOG_LEVEL Debug
+#else
+#define RBXSTU_MINIMUM_LOG_LEVEL Information
+#endif
+#endif
+
+namespace RbxStu {
+    /// @brief The lowest level compiled in. Calls through RbxStuLog below it are removed entirely, arguments included.
+    constexpr auto MinimumLogLevel = LogLevel::RBXSTU_MINIMUM_LOG_LEVEL;
+} // namespace RbxStu
+
+/// @brief Logs a message, formatted on the logging thread, if its level is compiled in and enabled at runtime, and if
+/// the limits of its section admit it. Otherwise, neither the message nor its arguments are evaluated.
+/// @remarks Usage: RbxStuLog(Debug, RbxStu::Scheduler, "Lua State = {}", static_cast<void *>(L));
+#define RbxStuLog(level, sectionName, ...)                                                                             \
+    do {                                                                                                               \
+        if constexpr (RbxStu::LogLevel::level >= RbxStu::MinimumLogLevel) {                                            \
+            if (::Logger::ShouldLog(RbxStu::LogLevel::level, sectionName))                                             \
+                ::Logger::GetSingleton()->Log(RbxStu::LogLevel::level, sectionName, __VA_ARGS__);                      \
+        }                                                                                                              \
+    } while (false)
+
+/// @brief Traces a message into the binary log files, if they are being written, without ever formatting it. Meant for
+/// diagnostics too frequent to be logged as text, which are kept in every build.
+/// @remarks Usage: RbxStuTrace(RbxStu::RobloxManager, "Resuming thread {}", static_cast<void *>(L));
+#define RbxStuTrace(sectionName, ...)                                                                                  \
+    do {                                                                                                               \
+        if (::Logger::IsTracing())                                                                                     \
+            ::Logger::GetSingleton()->Trace(sectionName, __VA_ARGS__);                                                 \
+    } while (false)
+
+class LogFileSink;
+
 class Logger final {
+public:
+    /// @brief Invoked with the type and content of everything the Logger flushes.
+    using OutputListener = std::function<void(RBX::Console::MessageType messageType, const std::string &szOutput)>;
+
+private:
     /// @brief Private, Static shared pointer into the instance.
     static std::shared_ptr<Logger> pInstance;
 
-    /// @brief Disables buffering.
+    /// @brief The ring of log records of a single thread, defined in Logger.cpp.
+    struct ThreadBuffer;
+
+    /// @brief Flushes the standard output after every batch of messages written.
     bool m_bInstantFlush;
     /// @brief Defines whether the Logger instance is initialized or not.
     bool m_bInitialized;
-    /// @brief The size of the buffer.
-    std::uint32_t m_dwBufferSize;
-    /// @brief The buffer used to store messages..
-    std::string m_szMessageBuffer;
+    /// @brief Guards the list of thread buffers.
+    std::mutex m_buffersMutex;
+    /// @brief The buffers of every thread that has logged, the ones of threads that have exited are removed once they
+    /// have been written out.
+    std::vector<std::shared_ptr<ThreadBuffer>> m_threadBuffers;
+    /// @brief Held whilst records are written out, be it by the logging thread or by Flush.
+    std::timed_mutex m_writeMutex;
+    /// @brief The buffers being written out. Requires m_writeMutex.
+    std::vector<std::shared_ptr<ThreadBuffer>> m_writingBuffers;
+    /// @brief Invoked on every message written, after writing it to the standard output. Requires m_writeMutex.
+    std::vector<OutputListener> m_outputListeners;
+    /// @brief The file the messages are written into alongside the standard output, if any. Requires m_writeMutex.
+    std::shared_ptr<LogFileSink> m_pFileSink;
+    /// @brief The format of the file sink. Requires m_writeMutex.
+    RbxStu::LogFileFormat m_fileFormat = RbxStu::LogFileFormat::Text;
+    /// @brief The messages written in the current batch, handed to a text file sink at once. Requires m_writeMutex.
+    std::string m_szFileBatch;
+    /// @brief The records of the binary message being written. Requires m_writeMutex.
+    std::string m_szBinaryRecords;
+    /// @brief The IDs of the strings written into the current binary log file. Requires m_writeMutex.
+    std::map<std::string, std::uint32_t, std::less<>> m_mapBinaryStrings;
+    /// @brief Set whilst the logging thread waits for records, so that threads only wake it when it is asleep.
+    std::atomic_bool m_bIsWriterWaiting;
+    /// @brief Incremented to wake the logging thread.
+    std::atomic_uint32_t m_dwWakeSequence;
+
+    /// @brief Obtains the buffer of the calling thread, creating it on the first message it logs.
+    ThreadBuffer *GetThreadBuffer();
+
+    /// @brief Wakes the logging thread, if it is waiting for records.
+    void WakeWriter();
+
+    /// @brief Formats a deferred message from its arguments, as copied by Log.
+    using DeferredFormatter = std::string (*)(std::string_view szFormat, std::string_view szArguments);
+    /// @brief Appends the arguments of a deferred message to a binary log message, see BinaryLogFormat.hpp.
+    /// @return The amount of arguments appended.
+    using DeferredEncoder = std::uint8_t (*)(std::string_view szArguments, std::string &szOutput);
+
+    /// @brief Leads the bytes of every message, followed by the section name and then by the arguments of the message,
+    /// or by its text if it has no formatter.
+    struct MessageHeader {
+        DeferredFormatter pFormatter;
+        DeferredEncoder pEncoder;
+        /// @brief The format string, which always has static storage, as it is checked at compile time.
+        const char *pFormat;
+        std::uint32_t dwFormatLength;
+        std::uint32_t dwSectionLength;
+        /// @brief When the message was logged, in nanoseconds since the UNIX epoch.
+        std::int64_t llTimestamp;
+    };
+
+    /// @brief Strings are copied by their contents, prefixed by their length.
+    template<typename T>
+    static constexpr bool IsStringArgument = std::is_convertible_v<const T &, std::string_view>;
+
+    /// @brief Arguments that may be copied into a record and formatted later. Messages with other arguments are
+    /// formatted on the calling thread.
+    template<typename T>
+    static constexpr bool IsDeferrableArgument = IsStringArgument<T> || (std::is_trivially_copyable_v<T> &&
+                                                                          !std::is_pointer_v<std::decay_t<T>>) ||
+                                                 std::is_same_v<T, void *> || std::is_same_v<T, const void *>;
+
+    template<typename T>
+    using DeferredArgument = std::conditional_t<IsStringArgument<T>, std::string_view, T>;
+
+    template<typename T>
+    static DeferredArgument<T> ReadDeferredArgument(std::string_view &szArguments) {
+        if constexpr (IsStringArgument<T>) {
+            std::uint32_t dwLength;
+            std::memcpy(&dwLength, szArguments.data(), sizeof(dwLength));
+            const auto szArgument = szArguments.substr(sizeof(dwLength), dwLength);
+            szArguments.remove_prefix(sizeof(dwLength) + dwLength);
+            return szArgument;
+        } else {
+            std::array<char, sizeof(T)> bytes;
+            std::memcpy(bytes.data(), szArguments.data(), sizeof(T));
+            szArguments.remove_prefix(sizeof(T));
+            return std::bit_cast<T>(bytes);
+        }
+    }
+
+    template<typename... Args>
+    static std::string FormatDeferred(const std::string_view szFormat, std::string_view szArguments) {
+        // Braced initialization reads the arguments in order.
+        const std::tuple<DeferredArgument<Args>...> arguments{Logger::ReadDeferredArgument<Args>(szArguments)...};
+        return std::apply(
+                [szFormat](const auto &...values) { return std::vformat(szFormat, std::make_format_args(values...)); },
+                arguments);
+    }
+
+    template<typename T>
+    static void EncodeArgument(std::string &szOutput, const T &value) {
+        using namespace RbxStu::BinaryLog;
+        if constexpr (std::is_same_v<T, std::string_view>) {
+            AppendStringArgument(szOutput, value);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            AppendValue(szOutput, ArgumentType::Boolean);
+            AppendValue(szOutput, static_cast<std::uint8_t>(value));
+        } else if constexpr (std::is_same_v<T, char>) {
+            AppendValue(szOutput, ArgumentType::Character);
+            AppendValue(szOutput, value);
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            AppendValue(szOutput, ArgumentType::SignedInteger);
+            AppendValue(szOutput, static_cast<std::int64_t>(value));
+        } else if constexpr (std::is_integral_v<T>) {
+            AppendValue(szOutput, ArgumentType::UnsignedInteger);
+            AppendValue(szOutput, static_cast<std::uint64_t>(value));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            AppendValue(szOutput, ArgumentType::Float);
+            AppendValue(szOutput, static_cast<double>(value));
+        } else if constexpr (std::is_pointer_v<T> || std::is_null_pointer_v<T>) {
+            AppendValue(szOutput, ArgumentType::Pointer);
+            AppendValue(szOutput, static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(value)));
+        } else {
+            AppendStringArgument(szOutput, std::format("{}", value));
+        }
+    }
+
+    template<typename... Args>
+    static std::uint8_t EncodeDeferred(std::string_view szArguments, std::string &szOutput) {
+        const std::tuple<DeferredArgument<Args>...> arguments{Logger::ReadDeferredArgument<Args>(szArguments)...};
+        std::apply([&szOutput](const auto &...values) { (Logger::EncodeArgument(szOutput, values), ...); },
+                   arguments);
+        return sizeof...(Args);
+    }
+
+    /// @brief Obtains the name a level is printed with.
+    static constexpr std::string_view GetLevelName(const RbxStu::LogLevel level) {
+        return RbxStu::BinaryLog::LevelNames[std::min(static_cast<std::size_t>(level),
+                                                      std::size(RbxStu::BinaryLog::LevelNames) - 1)];
+    }
+
+    /// @brief Obtains the current time, in nanoseconds since the UNIX epoch.
+    static std::int64_t GetTimestamp();
 
-    /// @brief Flushes the buffer into the standard output.
-    void Flush(RBX::Console::MessageType messageType);
+    /// @brief Copies the bytes of a message into the buffer of the calling thread, waiting for room only if it is full.
+    /// @param level The level of the message.
+    /// @param bIsTrace Whether the message is only to be written into the binary log files.
+    /// @param pieces The bytes of the message, see MessageHeader, in pieces, copied one after the other.
+    void Enqueue(RbxStu::LogLevel level, bool bIsTrace, std::span<const std::string_view> pieces);
 
-    /// @brief Flushes the buffer only if the buffer is full.
-    void FlushIfFull(RBX::Console::MessageType messageType);
+    /// @brief Copies an already formatted message into the buffer of the calling thread.
+    void EnqueueText(RbxStu::LogLevel level, bool bIsTrace, std::string_view sectionName, std::string_view msg);
+
+    /// @brief Copies a message into the buffer of the calling thread, with its arguments, for it to be formatted by the
+    /// logging thread, unless it has arguments which cannot be copied for later, such as containers.
+    template<typename... Args>
+    void EnqueueFormat(const RbxStu::LogLevel level, const bool bIsTrace, const std::string_view sectionName,
+                       const std::format_string<Args...> fmt, Args &&...args) {
+        if constexpr ((Logger::IsDeferrableArgument<std::remove_cvref_t<Args>> && ...)) {
+            const MessageHeader header{&Logger::FormatDeferred<std::remove_cvref_t<Args>...>,
+                                       &Logger::EncodeDeferred<std::remove_cvref_t<Args>...>,
+                                       fmt.get().data(),
+                                       static_cast<std::uint32_t>(fmt.get().size()),
+                                       static_cast<std::uint32_t>(sectionName.size()),
+                                       Logger::GetTimestamp()};
+            std::array<std::uint32_t, sizeof...(Args) + 1> lengths{};
+            std::array<std::string_view, 2 + 2 * sizeof...(Args)> pieces{};
+            std::size_t ullPieces = 0;
+            std::size_t ullLengths = 0;
+            pieces[ullPieces++] = {reinterpret_cast<const char *>(&header), sizeof(header)};
+            pieces[ullPieces++] = sectionName;
+            (
+                    [&] {
+                        if constexpr (Logger::IsStringArgument<std::remove_cvref_t<Args>>) {
+                            const std::string_view szArgument{args};
+                            lengths[ullLengths] = static_cast<std::uint32_t>(szArgument.size());
+                            pieces[ullPieces++] = {reinterpret_cast<const char *>(&lengths[ullLengths++]),
+                                                   sizeof(std::uint32_t)};
+                            pieces[ullPieces++] = szArgument;
+                        } else {
+                            pieces[ullPieces++] = {reinterpret_cast<const char *>(std::addressof(args)), sizeof(args)};
+                        }
+                    }(),
+                    ...);
+            this->Enqueue(level, bIsTrace, {pieces.data(), ullPieces});
+        } else {
+            this->EnqueueText(level, bIsTrace, sectionName, std::format(fmt, std::forward<Args>(args)...));
+        }
+    }
+
+    /// @brief Writes every record in the thread buffers out. Requires m_writeMutex.
+    /// @return True if any record was written.
+    bool WritePending();
+
+    /// @brief Formats a reassembled message into the line it is printed as.
+    static std::string FormatMessage(RbxStu::LogLevel level, std::string_view szMessage);
+
+    /// @brief Obtains the ID of a string in the current binary log file, appending its String record to
+    /// m_szBinaryRecords if it has none yet. Requires m_writeMutex.
+    std::uint32_t GetBinaryStringId(std::string_view szString);
+
+    /// @brief Writes a reassembled message into the binary log file. Requires m_writeMutex.
+    void WriteBinaryMessage(RbxStu::LogLevel level, std::uint32_t dwThreadId, std::string_view szMessage);
+
+    /// @brief Stops writing into log files, as the file sink has failed. Requires m_writeMutex.
+    void DisableFileSink();
+
+    /// @brief Writes a reassembled message out, into the standard output and to the listeners. Requires m_writeMutex.
+    void WriteLine(RbxStu::LogLevel level, const std::string &szLine);
+
+    /// @brief The body of the logging thread.
+    void WriterThread();
+
+    /// @brief How often the messages suppressed by the limits of the sections are reported.
+    static constexpr std::chrono::seconds SuppressionReportInterval{5};
+
+    /// @brief Starts reporting the messages suppressed by the limits of the sections, once any section has a limit.
+    static void StartSuppressionReports();
+
+    /// @brief Logs how many messages each limited section suppressed since the last report, if any.
+    void ReportSuppressedMessages();
 
 public:
     /// @brief Obtains the Singleton for the Logger instance.
     /// @return Returns a shared pointer to the global Logger singleton instance.
     static std::shared_ptr<Logger> GetSingleton();
 
-    /// @brief Initializes the Logger instance by opening the standard pipes, setting up the buffer and its size.
-    /// @param bInstantFlush Whether the logger should keep no buffer, and let the underlying implementation for stdio
-    /// and files handle it.
+    /// @brief Initializes the Logger instance by opening the standard pipes and starting the logging thread.
+    /// @param bInstantFlush Whether the standard output should be flushed as soon as the messages logged so far are
+    /// written, instead of letting the underlying implementation for stdio and files handle it.
     void Initialize(bool bInstantFlush);
 
+    /// @brief Obtains whether messages of the given level and section are logged, as configured at runtime.
+    /// @remarks Does not account for RbxStu::MinimumLogLevel, RbxStuLog does.
+    static bool IsEnabled(RbxStu::LogLevel level, std::string_view sectionName);
+
+    /// @brief Sets the minimum level of the messages logged, for sections without a level of their own.
+    static void SetLogLevel(RbxStu::LogLevel level);
+
+    /// @brief Sets the minimum level of the messages logged by the given section.
+    static void SetSectionLogLevel(std::string_view sectionName, RbxStu::LogLevel level);
+
+    /// @brief Sets up the levels from a configuration such as "Warning,RbxStu::Scheduler=Debug", a default level
+    /// followed by the levels of specific sections, every part being optional.
+    /// @return False if any part of the configuration was not understood, in which case it is ignored.
+    static bool ConfigureLogLevels(std::string_view szConfiguration);
+
+    /// @brief Obtains whether a message of the given level and section is to be logged, taking it into account for the
+    /// limits of the section, if it has any.
+    /// @remarks Unlike IsEnabled, this is meant to be called once for every message, right before logging it.
+    static bool ShouldLog(RbxStu::LogLevel level, std::string_view sectionName);
+
+    /// @brief Limits the rate of the messages logged by the given section, messages past it being suppressed.
+    /// @param dMessagesPerSecond The messages admitted per second, or zero to lift the limit.
+    /// @param dwBurst The messages admitted at once after the section was quiet, by default a second worth of them.
+    static void SetSectionRateLimit(std::string_view sectionName, double dMessagesPerSecond, std::uint32_t dwBurst = 0);
+
+    /// @brief Samples the messages logged by the given section, admitting one in every dwSampleEvery of them, or all
+    /// of them if it is one. Sampled messages are then subject to the rate limit of the section, if any.
+    static void SetSectionSampling(std::string_view sectionName, std::uint32_t dwSampleEvery);
+
+    /// @brief Sets up the limits of sections from a configuration like "RbxStu::Scheduler=100/s,RbxStu::Security=1/4",
+    /// where "<rate>/s" limits the rate of a section, "1/<n>" samples it and "off" lifts both.
+    /// @return False if any part of the configuration was not understood, in which case it is ignored.
+    /// @remarks Suppressed messages are counted and reported as a warning of their section every few seconds.
+    static bool ConfigureLogLimits(std::string_view szConfiguration);
+
+    /// @brief Emits a message with the given level and section name into the Logger's buffer, formatting it on the
+    /// logging thread, unless it has arguments which cannot be copied for later, such as containers.
+    /// @remarks Prefer RbxStuLog, which skips the call altogether if the level is not enabled.
+    template<typename... Args>
+    void Log(const RbxStu::LogLevel level, const std::string_view sectionName, const std::format_string<Args...> fmt,
+             Args &&...args) {
+        this->EnqueueFormat(level, false, sectionName, fmt, std::forward<Args>(args)...);
+    }
+
+    /// @brief Obtains whether binary log files are being written, and thus whether Trace does anything.
+    static bool IsTracing();
+
+    /// @brief Emits a message with the given section name into the binary log files, with its arguments, unformatted.
+    /// @remarks Prefer RbxStuTrace, which skips the call altogether if binary log files are not being written.
+    template<typename... Args>
+    void Trace(const std::string_view sectionName, const std::format_string<Args...> fmt, Args &&...args) {
+        this->EnqueueFormat(RbxStu::LogLevel::Trace, true, sectionName, fmt, std::forward<Args>(args)...);
+    }
+
     /// @brief Emits an Information with the given section name into the Logger's buffer.
     /// @param sectionName The name of the section that the code is running at
     /// @param msg The content to write into the buffer, as an information.
-    void PrintInformation(const std::string &sectionName, const std::string &msg);
+    void PrintInformation(std::string_view sectionName, std::string_view msg);
 
     /// @brief Emits a Warning with the given section name into the Logger's buffer.
     /// @param sectionName The name of the section that the code is running at
     /// @param msg The content to write into the buffer, as a warning.
-    void PrintWarning(const std::string &sectionName, const std::string &msg);
+    void PrintWarning(std::string_view sectionName, std::string_view msg);
 
     /// @brief Emits an error with the given section name into the Logger's buffer.
     /// @param sectionName The name of the section that the code is running at
     /// @param msg The content to write into the buffer, as an error.
-    void PrintError(const std::string &sectionName, const std::string &msg);
+    void PrintError(std::string_view sectionName, std::string_view msg);
+
+    /// @brief Begins writing every message into log files, alongside the standard output, see LogFileSink.
+    /// @param directory The directory the log files are written into.
+    /// @param format The format to write the log files in.
+    /// @param ullSegmentSize The size of a log file, after which a new one is begun.
+    /// @param dwSegmentCount The amount of log files kept, counting the one being written.
+    /// @return False if the log files could not be created.
+    bool EnableFileSink(const std::filesystem::path &directory,
+                        RbxStu::LogFileFormat format = RbxStu::LogFileFormat::Text,
+                        std::size_t ullSegmentSize = 16 * 1024 * 1024, std::uint32_t dwSegmentCount = 8);
+
+    /// @brief Writes out everything logged so far, on the calling thread, without waiting for the logging thread.
+    /// @remarks Meant for crash handlers, so that what was logged right before a crash is not lost with the process.
+    /// The log files, if any, are flushed to disk too.
+    /// Gives up after a second should the logging thread be stuck writing, as it may be the thread that crashed.
+    void Flush();
+
+    /// @brief Registers a listener that is handed everything the Logger flushes from now on.
+    /// @param listener The listener to register.
+    /// @remarks The listener is invoked on the logging thread, it must not log, and it must return swiftly, as no
+    /// message is written whilst it runs.
+    void AddOutputListener(OutputListener listener);
 };
 
 
@@ -71,7 +424,15 @@ namespace RbxStu {
     DefineSectionName(Hooked_RBXCrash, "RbxStu::HookedFunctions<RBX::RBXCRASH>");
 
     DefineSectionName(Scheduler, "RbxStu::Scheduler");
+    DefineSectionName(ThreadPool, "RbxStu::ThreadPool");
+    DefineSectionName(Preemption, "RbxStu::Preemption");
+    DefineSectionName(Profiler, "RbxStu::Profiler");
+    DefineSectionName(Coverage, "RbxStu::Coverage");
     DefineSectionName(Communication, "RbxStu::Communication");
+    DefineSectionName(WebSocketEndpoint, "RbxStu::WebSocketEndpoint");
+    DefineSectionName(SharedMemoryEndpoint, "RbxStu::SharedMemoryEndpoint");
+    DefineSectionName(MetricsEndpoint, "RbxStu::MetricsEndpoint");
+    DefineSectionName(ExecutionReporter, "RbxStu::ExecutionReporter");
     DefineSectionName(Env_Filesystem, "Env::Filesystem");
 
 #undef DefineSectionName
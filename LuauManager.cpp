@@ -73,6 +73,9 @@ namespace RbxStu {
 } // namespace RbxStu
 
 static void luau__freeblock(lua_State *L, uint32_t sizeClass, void *block) {
+    static auto &invocations = RobloxManager::GetHookInvocations("freeblock");
+    invocations.Increment();
+
     if (reinterpret_cast<std::uintptr_t>(block) > 0x00007FF000000000)
         return;
 
@@ -107,11 +110,7 @@ static void* luaE__newthread(lua_State* on) {
             LuauManager::GetSingleton()->GetHookOriginal("luaE_newthread"));
     auto newLuaThread = originalFunction(on);
 
-    const auto logger = Logger::GetSingleton();
-
-    std::stringstream ss;
-    ss << "New lua thread got opened: 0x" << std::hex << std::uppercase << reinterpret_cast<uintptr_t>(newLuaThread);
-    logger->PrintInformation("RbxStu::luaE_newthread_hook", ss.str());
+    RbxStuTrace("RbxStu::luaE_newthread_hook", "New lua thread got opened: {}", static_cast<void *>(newLuaThread));
 
     std::thread([newLuaThread](){
         newThreadAfter(newLuaThread);
@@ -0,0 +1,59 @@
+#include "MetricsEndpoint.hpp"
+
+#include <format>
+#include <ixwebsocket/IXHttpServer.h>
+#include <ixwebsocket/IXNetSystem.h>
+
+#include "Logger.hpp"
+#include "MetricsRegistry.hpp"
+
+std::shared_ptr<MetricsEndpoint> MetricsEndpoint::pInstance;
+
+std::shared_ptr<MetricsEndpoint> MetricsEndpoint::GetSingleton() {
+    if (MetricsEndpoint::pInstance == nullptr)
+        MetricsEndpoint::pInstance = std::make_shared<MetricsEndpoint>();
+
+    return MetricsEndpoint::pInstance;
+}
+
+bool MetricsEndpoint::Start(const std::uint16_t wPort) {
+    const auto logger = Logger::GetSingleton();
+    if (this->m_pServer != nullptr) {
+        logger->PrintWarning(RbxStu::MetricsEndpoint, "The metrics endpoint is running already!");
+        return false;
+    }
+
+    ix::initNetSystem();
+    const auto pServer = std::make_shared<ix::HttpServer>(wPort, "127.0.0.1", ix::SocketServer::kDefaultTcpBacklog,
+                                                          MetricsEndpoint::MaximumConnections);
+
+    pServer->setOnConnectionCallback(
+            [](const ix::HttpRequestPtr &request,
+               const std::shared_ptr<ix::ConnectionState> &) -> ix::HttpResponsePtr {
+                if (request->uri != "/metrics")
+                    return std::make_shared<ix::HttpResponse>(404, "Not Found", ix::HttpErrorCode::Ok,
+                                                              ix::WebSocketHttpHeaders{}, "Not Found\n");
+
+                if (request->method != "GET")
+                    return std::make_shared<ix::HttpResponse>(405, "Method Not Allowed", ix::HttpErrorCode::Ok,
+                                                              ix::WebSocketHttpHeaders{{"Allow", "GET"}},
+                                                              "Method Not Allowed\n");
+
+                return std::make_shared<ix::HttpResponse>(
+                        200, "OK", ix::HttpErrorCode::Ok,
+                        ix::WebSocketHttpHeaders{{"Content-Type", "text/plain; version=0.0.4; charset=utf-8"}},
+                        MetricsRegistry::GetSingleton()->ExportPrometheus());
+            });
+
+    if (const auto [bListening, szError] = pServer->listen(); !bListening) {
+        logger->PrintError(RbxStu::MetricsEndpoint,
+                           std::format("Failed to listen on 127.0.0.1:{}! Error: {}", wPort, szError));
+        return false;
+    }
+
+    pServer->start();
+    this->m_pServer = pServer;
+    logger->PrintInformation(RbxStu::MetricsEndpoint,
+                             std::format("Serving metrics on http://127.0.0.1:{}/metrics", wPort));
+    return true;
+}
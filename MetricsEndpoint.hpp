@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+
+namespace ix {
+    class HttpServer;
+} // namespace ix
+
+/// @brief A loopback HTTP server that serves the MetricsRegistry on /metrics, in the Prometheus text format, for
+/// dashboards to scrape.
+class MetricsEndpoint final {
+    /// @brief Private, Static shared pointer into the instance.
+    static std::shared_ptr<MetricsEndpoint> pInstance;
+
+    /// @brief The amount of scrapers that may be connected at once.
+    static constexpr std::size_t MaximumConnections = 8;
+
+    std::shared_ptr<ix::HttpServer> m_pServer;
+
+public:
+    /// @brief Obtains the shared pointer that points to the global singleton for the current class.
+    /// @return Singleton for MetricsEndpoint as a std::shared_ptr<MetricsEndpoint>.
+    static std::shared_ptr<MetricsEndpoint> GetSingleton();
+
+    /// @brief Begins serving the metrics on the loopback interface.
+    /// @param wPort The port to listen on.
+    /// @return True if the server is listening, false if it could not be started or is running already.
+    bool Start(std::uint16_t wPort);
+};
@@ -0,0 +1,165 @@
+#include "MetricsRegistry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+
+std::shared_ptr<MetricsRegistry> MetricsRegistry::pInstance;
+
+/// @brief Formats a sample value the way Prometheus expects it.
+static std::string FormatValue(const double dValue) {
+    if (std::isnan(dValue))
+        return "NaN";
+
+    if (std::isinf(dValue))
+        return dValue > 0 ? "+Inf" : "-Inf";
+
+    return std::format("{}", dValue);
+}
+
+/// @brief Escapes a label value, or the text of a HELP line if bIsHelp is set, which keeps its quotes.
+static std::string EscapeText(const std::string_view szText, const bool bIsHelp) {
+    std::string szEscaped;
+    for (const auto c: szText) {
+        if (c == '\\')
+            szEscaped += "\\\\";
+        else if (c == '\n')
+            szEscaped += "\\n";
+        else if (c == '"' && !bIsHelp)
+            szEscaped += "\\\"";
+        else
+            szEscaped += c;
+    }
+
+    return szEscaped;
+}
+
+/// @brief Writes a single sample line, e.g. name{labels} value.
+static void WriteSample(std::string &szOutput, const std::string_view szName, const std::string_view szLabels,
+                        const std::string_view szValue) {
+    if (szLabels.empty())
+        szOutput += std::format("{} {}\n", szName, szValue);
+    else
+        szOutput += std::format("{}{{{}}} {}\n", szName, szLabels, szValue);
+}
+
+void RbxStu::Metrics::Counter::Export(std::string &szOutput, const std::string_view szName,
+                                      const std::string_view szLabels) const {
+    WriteSample(szOutput, szName, szLabels, std::format("{}", this->Get()));
+}
+
+void RbxStu::Metrics::Gauge::Export(std::string &szOutput, const std::string_view szName,
+                                    const std::string_view szLabels) const {
+    WriteSample(szOutput, szName, szLabels, FormatValue(this->Get()));
+}
+
+RbxStu::Metrics::BucketHistogram::BucketHistogram(std::vector<double> bounds)
+    : m_bounds(std::move(bounds)), m_pBuckets(std::make_unique<std::atomic_uint64_t[]>(this->m_bounds.size() + 1)) {}
+
+void RbxStu::Metrics::BucketHistogram::Observe(const double dValue) {
+    // Bounds are inclusive ("le"), so the value belongs to the first bucket whose bound is not below it.
+    const auto ullBucket = static_cast<std::size_t>(std::ranges::lower_bound(this->m_bounds, dValue) -
+                                                    this->m_bounds.begin());
+    this->m_pBuckets[ullBucket].fetch_add(1, std::memory_order_relaxed);
+    this->m_ullCount.fetch_add(1, std::memory_order_relaxed);
+    this->m_dSum.fetch_add(dValue, std::memory_order_relaxed);
+}
+
+void RbxStu::Metrics::BucketHistogram::Export(std::string &szOutput, const std::string_view szName,
+                                              const std::string_view szLabels) const {
+    // Buckets are cumulative, and the "+Inf" one must match the count, which may be behind the buckets if observations
+    // are being recorded whilst exporting.
+    const auto szBucketName = std::format("{}_bucket", szName);
+    const auto szSeparator = szLabels.empty() ? "" : ",";
+    std::uint64_t ullCumulative = 0;
+    for (std::size_t i = 0; i < this->m_bounds.size(); i++) {
+        ullCumulative += this->m_pBuckets[i].load(std::memory_order_relaxed);
+        WriteSample(szOutput, szBucketName,
+                    std::format("{}{}le=\"{}\"", szLabels, szSeparator, FormatValue(this->m_bounds[i])),
+                    std::format("{}", ullCumulative));
+    }
+
+    ullCumulative += this->m_pBuckets[this->m_bounds.size()].load(std::memory_order_relaxed);
+    WriteSample(szOutput, szBucketName, std::format("{}{}le=\"+Inf\"", szLabels, szSeparator),
+                std::format("{}", ullCumulative));
+    WriteSample(szOutput, std::format("{}_sum", szName), szLabels,
+                FormatValue(this->m_dSum.load(std::memory_order_relaxed)));
+    WriteSample(szOutput, std::format("{}_count", szName), szLabels, std::format("{}", ullCumulative));
+}
+
+std::shared_ptr<MetricsRegistry> MetricsRegistry::GetSingleton() {
+    if (MetricsRegistry::pInstance == nullptr)
+        MetricsRegistry::pInstance = std::make_shared<MetricsRegistry>();
+
+    return MetricsRegistry::pInstance;
+}
+
+RbxStu::Metrics::Metric &MetricsRegistry::GetSeries(const std::string_view szName, const std::string_view szHelp,
+                                                    const MetricType type, const RbxStu::Metrics::Labels &labels,
+                                                    const std::vector<double> *pBuckets) {
+    std::string szLabels;
+    for (const auto &[szLabel, szValue]: labels)
+        szLabels += std::format("{}{}=\"{}\"", szLabels.empty() ? "" : ",", szLabel, EscapeText(szValue, false));
+
+    std::lock_guard lock{this->m_familiesMutex};
+    auto family = this->m_mapFamilies.find(szName);
+    if (family == this->m_mapFamilies.end())
+        family = this->m_mapFamilies.emplace(szName, Family{type, std::string{szHelp}, {}}).first;
+    else if (family->second.type != type)
+        throw std::exception("A metric has been registered again with another type!");
+
+    auto &mapSeries = family->second.mapSeries;
+    auto series = mapSeries.find(szLabels);
+    if (series == mapSeries.end()) {
+        std::unique_ptr<RbxStu::Metrics::Metric> pMetric;
+        switch (type) {
+            case MetricType::Counter:
+                pMetric = std::make_unique<RbxStu::Metrics::Counter>();
+                break;
+            case MetricType::Gauge:
+                pMetric = std::make_unique<RbxStu::Metrics::Gauge>();
+                break;
+            case MetricType::Histogram:
+                pMetric = std::make_unique<RbxStu::Metrics::BucketHistogram>(*pBuckets);
+                break;
+        }
+
+        series = mapSeries.emplace(std::move(szLabels), std::move(pMetric)).first;
+    }
+
+    return *series->second;
+}
+
+RbxStu::Metrics::Counter &MetricsRegistry::GetCounter(const std::string_view szName, const std::string_view szHelp,
+                                                      const RbxStu::Metrics::Labels &labels) {
+    return static_cast<RbxStu::Metrics::Counter &>(this->GetSeries(szName, szHelp, MetricType::Counter, labels));
+}
+
+RbxStu::Metrics::Gauge &MetricsRegistry::GetGauge(const std::string_view szName, const std::string_view szHelp,
+                                                  const RbxStu::Metrics::Labels &labels) {
+    return static_cast<RbxStu::Metrics::Gauge &>(this->GetSeries(szName, szHelp, MetricType::Gauge, labels));
+}
+
+RbxStu::Metrics::BucketHistogram &MetricsRegistry::GetHistogram(const std::string_view szName,
+                                                                const std::string_view szHelp,
+                                                                const std::vector<double> &bounds,
+                                                                const RbxStu::Metrics::Labels &labels) {
+    return static_cast<RbxStu::Metrics::BucketHistogram &>(
+            this->GetSeries(szName, szHelp, MetricType::Histogram, labels, &bounds));
+}
+
+std::string MetricsRegistry::ExportPrometheus() {
+    std::string szOutput;
+    std::lock_guard lock{this->m_familiesMutex};
+    for (const auto &[szName, family]: this->m_mapFamilies) {
+        const auto szType = family.type == MetricType::Counter ? "counter"
+                            : family.type == MetricType::Gauge ? "gauge"
+                                                               : "histogram";
+        szOutput += std::format("# HELP {} {}\n# TYPE {} {}\n", szName, EscapeText(family.szHelp, true), szName,
+                                szType);
+        for (const auto &[szLabels, pMetric]: family.mapSeries)
+            pMetric->Export(szOutput, szName, szLabels);
+    }
+
+    return szOutput;
+}
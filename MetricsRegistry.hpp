@@ -0,0 +1,140 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace RbxStu::Metrics {
+    /// @brief The labels of a metric, as pairs of name and value, e.g. {{"hook", "freeblock"}}.
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    /// @brief The upper bounds, in seconds, of the buckets of histograms of durations.
+    inline const std::vector<double> DurationBuckets = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+                                                        0.025,  0.05,    0.1,    0.25,  0.5,    1,     2.5};
+
+    /// @brief A metric of the registry, which writes itself in the Prometheus text format.
+    class Metric {
+    public:
+        virtual ~Metric() = default;
+
+        /// @brief Writes the samples of the metric into szOutput.
+        /// @param szName The name of the metric.
+        /// @param szLabels The labels of the metric, formatted and without braces, possibly empty.
+        virtual void Export(std::string &szOutput, std::string_view szName, std::string_view szLabels) const = 0;
+    };
+
+    /// @brief A value that only ever goes up, such as the amount of jobs executed.
+    class Counter final : public Metric {
+        std::atomic_uint64_t m_ullValue = 0;
+
+    public:
+        /// @brief Increments the counter. Lock-free, may be called from any thread.
+        void Increment(const std::uint64_t ullAmount = 1) {
+            this->m_ullValue.fetch_add(ullAmount, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] std::uint64_t Get() const { return this->m_ullValue.load(std::memory_order_relaxed); }
+
+        void Export(std::string &szOutput, std::string_view szName, std::string_view szLabels) const override;
+    };
+
+    /// @brief A value that may go up and down, such as the amount of threads yielded or the size of the Luau heap.
+    class Gauge final : public Metric {
+        std::atomic<double> m_dValue = 0;
+
+    public:
+        /// @brief Sets the gauge. Lock-free, may be called from any thread.
+        void Set(const double dValue) { this->m_dValue.store(dValue, std::memory_order_relaxed); }
+
+        /// @brief Adds to the gauge, or subtracts from it if dAmount is negative. Lock-free, may be called from any
+        /// thread.
+        void Add(const double dAmount) { this->m_dValue.fetch_add(dAmount, std::memory_order_relaxed); }
+
+        [[nodiscard]] double Get() const { return this->m_dValue.load(std::memory_order_relaxed); }
+
+        void Export(std::string &szOutput, std::string_view szName, std::string_view szLabels) const override;
+    };
+
+    /// @brief Counts observations into buckets whose bounds are fixed when it is created, as Prometheus histograms do.
+    /// @remarks Unlike ::Histogram, which approximates percentiles for reports, its buckets are the ones the scraper
+    /// aggregates over, so they must be the same across every series of a metric.
+    class BucketHistogram final : public Metric {
+        std::vector<double> m_bounds;
+        /// @brief The observations of every bucket, the last one being the one above every bound ("+Inf").
+        std::unique_ptr<std::atomic_uint64_t[]> m_pBuckets;
+        std::atomic_uint64_t m_ullCount = 0;
+        std::atomic<double> m_dSum = 0;
+
+    public:
+        /// @param bounds The upper bounds of the buckets, in ascending order.
+        explicit BucketHistogram(std::vector<double> bounds);
+
+        /// @brief Records an observation. Lock-free, may be called from any thread.
+        void Observe(double dValue);
+
+        /// @brief Records a duration, in seconds.
+        void ObserveDuration(const std::chrono::steady_clock::duration duration) {
+            this->Observe(std::chrono::duration<double>(duration).count());
+        }
+
+        void Export(std::string &szOutput, std::string_view szName, std::string_view szLabels) const override;
+    };
+} // namespace RbxStu::Metrics
+
+/// @brief The process-wide registry of counters, gauges and histograms, exported in the Prometheus text format through
+/// the MetricsEndpoint.
+/// @remarks Metrics are registered on first use and live for as long as the process does, so call sites look them up
+/// once and keep the reference, e.g. in a function-local static. Updating a metric never takes a lock.
+class MetricsRegistry final {
+    /// @brief Private, Static shared pointer into the instance.
+    static std::shared_ptr<MetricsRegistry> pInstance;
+
+    enum class MetricType : std::uint8_t { Counter, Gauge, Histogram };
+
+    /// @brief Every series of a metric, keyed by their formatted labels.
+    struct Family {
+        MetricType type;
+        std::string szHelp;
+        std::map<std::string, std::unique_ptr<RbxStu::Metrics::Metric>, std::less<>> mapSeries;
+    };
+
+    std::mutex m_familiesMutex;
+    std::map<std::string, Family, std::less<>> m_mapFamilies;
+
+    /// @brief Obtains the series of a metric with the given labels, creating it (and the metric) if they do not exist.
+    /// @remarks Throws if the metric exists with another type.
+    RbxStu::Metrics::Metric &GetSeries(std::string_view szName, std::string_view szHelp, MetricType type,
+                                       const RbxStu::Metrics::Labels &labels,
+                                       const std::vector<double> *pBuckets = nullptr);
+
+public:
+    /// @brief Obtains the shared pointer that points to the global singleton for the current class.
+    /// @return Singleton for MetricsRegistry as a std::shared_ptr<MetricsRegistry>.
+    static std::shared_ptr<MetricsRegistry> GetSingleton();
+
+    /// @brief Obtains a counter, registering it on first use.
+    /// @param szName The name of the metric, which should end in "_total", e.g. "rbxstu_scheduler_jobs_executed_total".
+    /// @param szHelp The description of the metric. Only the one given first is kept.
+    /// @param labels The labels of the series.
+    RbxStu::Metrics::Counter &GetCounter(std::string_view szName, std::string_view szHelp,
+                                         const RbxStu::Metrics::Labels &labels = {});
+
+    /// @brief Obtains a gauge, registering it on first use.
+    RbxStu::Metrics::Gauge &GetGauge(std::string_view szName, std::string_view szHelp,
+                                     const RbxStu::Metrics::Labels &labels = {});
+
+    /// @brief Obtains a histogram, registering it on first use.
+    /// @param bounds The upper bounds of its buckets, in ascending order. Only used when the series is created.
+    RbxStu::Metrics::BucketHistogram &GetHistogram(std::string_view szName, std::string_view szHelp,
+                                                   const std::vector<double> &bounds,
+                                                   const RbxStu::Metrics::Labels &labels = {});
+
+    /// @brief Generates the exposition of every metric, in the Prometheus text format (version 0.0.4).
+    [[nodiscard]] std::string ExportPrometheus();
+};
@@ -0,0 +1,164 @@
+#include "Preemption.hpp"
+
+#include "Logger.hpp"
+#include "Profiler.hpp"
+#include "Scheduler.hpp"
+#include "SchedulerManager.hpp"
+#include "lua.h"
+#include "lualib.h"
+
+std::shared_ptr<Preemption> Preemption::pInstance;
+
+/// @brief Suspends until the next Scheduler step, resuming the preempted thread with no values. The thread continues
+/// running from the instruction it was interrupted at.
+static RbxStu::Task<int> ResumeOnNextStep(lua_State *L) {
+    co_await RbxStu::NextSchedulerStep{};
+    co_return 0;
+}
+
+std::shared_ptr<Preemption> Preemption::GetSingleton() {
+    if (Preemption::pInstance == nullptr)
+        Preemption::pInstance = std::make_shared<Preemption>();
+
+    return Preemption::pInstance;
+}
+
+Preemption::InterruptHook *Preemption::GetInterruptHook(const global_State *pGlobalState) {
+    for (auto &hook: this->m_aInterruptHooks) {
+        if (hook.pGlobalState.load(std::memory_order_acquire) == pGlobalState)
+            return &hook;
+    }
+
+    return nullptr;
+}
+
+void Preemption::OnInterrupt(lua_State *L, const int gc) {
+    // The instance is guaranteed to exist, it is what installed the callback. Going through GetSingleton would cost a
+    // reference count increment on every interrupt.
+    const auto preemption = Preemption::pInstance.get();
+    const auto pHook = preemption->GetInterruptHook(L->global);
+    if (const auto original = pHook != nullptr ? pHook->original.load(std::memory_order_relaxed) : nullptr;
+        original != nullptr) {
+        original(L, gc);
+        if (L->status != LUA_OK)
+            return;
+    }
+
+    // The profiler piggybacks on the interrupt, as it may only read the stack of the thread that is running.
+    if (Profiler::IsSamplePending())
+        Profiler::GetSingleton()->Sample(L, gc);
+
+    // Interrupts raised by the GC (gc >= 0) and from within C functions may not yield, nor may threads resumed by
+    // other Luau threads (baseCcalls > 1) or that are inside a C call. The thread a job was started on is the
+    // exception, its base C call count is raised by the protected call the job runs in.
+    if (gc >= 0 || pHook == nullptr || preemption->m_ullBudgetedJobCount.load(std::memory_order_relaxed) == 0)
+        return;
+    if (!ttisfunction(L->ci->func) || clvalue(L->ci->func)->isC || !lua_isyieldable(L))
+        return;
+
+    {
+        std::lock_guard lock{preemption->m_mutex};
+        const auto budgetedJob = preemption->m_mapBudgetedJobs.find(clvalue(L->ci->func)->l.p->source);
+        if (budgetedJob == preemption->m_mapBudgetedJobs.end() || budgetedJob->second.pGlobalState != L->global)
+            return;
+        if (L->baseCcalls > 1 && budgetedJob->second.pThread != L)
+            return;
+
+        const auto now = std::chrono::steady_clock::now();
+        if (const auto ullStep = pHook->ullStep.load(); budgetedJob->second.ullSliceStep != ullStep) {
+            budgetedJob->second.ullSliceStep = ullStep;
+            budgetedJob->second.sliceStartedAt = now;
+            return;
+        }
+
+        if (now - budgetedJob->second.sliceStartedAt < budgetedJob->second.budget)
+            return;
+    }
+
+    const auto scheduler = SchedulerManager::GetSingleton()->GetSchedulerForState(L);
+    if (!scheduler.has_value() || !lua_checkstack(L, 2))
+        return;
+
+    preemption->m_ullPreemptions++;
+    scheduler.value()->ScheduleJob(SchedulerJob(L, ResumeOnNextStep(L)));
+    lua_yield(L, 0);
+}
+
+void Preemption::InstallInterrupt(lua_State *L) {
+    const auto callbacks = lua_callbacks(L);
+    if (callbacks->interrupt == Preemption::OnInterrupt)
+        return;
+
+    // The slot is fully set up before the callback is installed, so the callback can always find the original.
+    auto &hook = this->m_aInterruptHooks[this->m_ullNextInterruptHook++ % this->m_aInterruptHooks.size()];
+    hook.pGlobalState.store(nullptr, std::memory_order_release);
+    hook.original.store(callbacks->interrupt, std::memory_order_relaxed);
+    hook.pGlobalState.store(L->global, std::memory_order_release);
+    callbacks->interrupt = Preemption::OnInterrupt;
+
+    Logger::GetSingleton()->PrintInformation(
+            RbxStu::Preemption,
+            std::format("Installed the preemption interrupt on global state {}.", static_cast<void *>(L->global)));
+}
+
+void Preemption::SetJobBudget(lua_State *L, const TString *pSource, const std::chrono::steady_clock::duration budget) {
+    // Pushing the source interns it into the very same TString, so referencing it keeps it alive.
+    lua_pushlstring(L, getstr(pSource), pSource->len);
+    const auto dwSourceRef = lua_ref(L, -1);
+    lua_pop(L, 1);
+
+    std::lock_guard lock{this->m_mutex};
+    if (const auto [budgetedJob, bInserted] = this->m_mapBudgetedJobs.try_emplace(
+                pSource, BudgetedJob{L->global, dwSourceRef, budget, 0, {}, nullptr});
+        !bInserted) {
+        budgetedJob->second.budget = budget;
+        lua_unref(L, dwSourceRef);
+        return;
+    }
+
+    this->m_ullBudgetedJobCount++;
+}
+
+void Preemption::SetJobThread(const TString *pSource, lua_State *L) {
+    if (this->m_ullBudgetedJobCount.load(std::memory_order_relaxed) == 0)
+        return;
+
+    std::lock_guard lock{this->m_mutex};
+    if (const auto budgetedJob = this->m_mapBudgetedJobs.find(pSource); budgetedJob != this->m_mapBudgetedJobs.end())
+        budgetedJob->second.pThread = L;
+}
+
+void Preemption::ReleaseJobBudget(lua_State *L, const TString *pSource) {
+    if (this->m_ullBudgetedJobCount.load(std::memory_order_relaxed) == 0)
+        return;
+
+    std::lock_guard lock{this->m_mutex};
+    const auto budgetedJob = this->m_mapBudgetedJobs.find(pSource);
+    if (budgetedJob == this->m_mapBudgetedJobs.end() || budgetedJob->second.pGlobalState != L->global)
+        return;
+
+    lua_unref(L, budgetedJob->second.dwSourceRef);
+    this->m_mapBudgetedJobs.erase(budgetedJob);
+    this->m_ullBudgetedJobCount--;
+}
+
+void Preemption::ReleaseJobBudgets(const global_State *pGlobalState, lua_State *L) {
+    std::lock_guard lock{this->m_mutex};
+    std::erase_if(this->m_mapBudgetedJobs, [this, pGlobalState, L](const auto &budgetedJob) {
+        if (budgetedJob.second.pGlobalState != pGlobalState)
+            return false;
+
+        if (L != nullptr)
+            lua_unref(L, budgetedJob.second.dwSourceRef);
+
+        this->m_ullBudgetedJobCount--;
+        return true;
+    });
+}
+
+void Preemption::OnSchedulerStep(const global_State *pGlobalState) {
+    if (const auto pHook = this->GetInterruptHook(pGlobalState); pHook != nullptr)
+        pHook->ullStep++;
+}
+
+std::uint64_t Preemption::GetPreemptionCount() const { return this->m_ullPreemptions; }
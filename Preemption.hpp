@@ -0,0 +1,110 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "lobject.h"
+#include "lstate.h"
+
+/// @brief Enforces the time budgets of executor scripts through Luau's interrupt callback. A script that exceeds its
+/// share of a Scheduler step yields back to the Scheduler, which resumes it on the next step, so that long-running
+/// code shares the frame instead of freezing Studio.
+/// @remarks Scripts are told apart by the source of their chunk, which every function and thread created by a script
+/// shares. Only threads resumed directly by Roblox, and the thread the script was started on, are preempted, as
+/// yielding a coroutine resumed from Luau would return control to whoever resumed it instead of to the Scheduler.
+class Preemption final {
+    /// @brief Private, Static shared pointer into the instance.
+    static std::shared_ptr<Preemption> pInstance;
+
+    using InterruptCallback = void (*)(lua_State *L, int gc);
+
+    struct BudgetedJob {
+        /// @brief The VM the job runs on.
+        global_State *pGlobalState;
+        /// @brief The registry reference keeping the source of the chunk alive, so that its address may not be reused
+        /// by another chunk whilst it identifies this one.
+        int dwSourceRef;
+        /// @brief The time the job may run for on every Scheduler step.
+        std::chrono::steady_clock::duration budget;
+        /// @brief The step of the VM's Scheduler the current slice of the job belongs to.
+        std::uint64_t ullSliceStep;
+        /// @brief When the job first ran on the current slice.
+        std::chrono::steady_clock::time_point sliceStartedAt;
+        /// @brief The thread the job was started on, which runs it within a protected call and so is not told apart
+        /// from coroutines by its base C call count.
+        lua_State *pThread;
+    };
+
+    struct InterruptHook {
+        /// @brief The VM the interrupt callback has been installed on.
+        std::atomic<global_State *> pGlobalState;
+        /// @brief The interrupt callback the VM had before, which is called before ours.
+        std::atomic<InterruptCallback> original;
+        /// @brief Incremented on every step of the VM's Scheduler, every step begins a new slice for the VM's jobs.
+        /// Kept per VM, as the Schedulers of other DataModels step on the same frame.
+        std::atomic_uint64_t ullStep = 1;
+    };
+
+    /// @brief Guards the budgeted jobs.
+    std::mutex m_mutex;
+    /// @brief The budgets of the jobs that have one, keyed by the source of their chunk.
+    std::unordered_map<const TString *, BudgetedJob> m_mapBudgetedJobs;
+    /// @brief The amount of budgeted jobs, checked without the lock so that the interrupts raised when there are none
+    /// cost nothing.
+    std::atomic_size_t m_ullBudgetedJobCount;
+    /// @brief The VMs the interrupt callback has been installed on. Slots are reused once every one of them is taken.
+    std::array<InterruptHook, 8> m_aInterruptHooks;
+    std::atomic_size_t m_ullNextInterruptHook;
+    /// @brief The amount of times scripts have been preempted.
+    std::atomic_uint64_t m_ullPreemptions;
+
+    /// @brief Obtains the slot of the interrupt callback installed on the given VM.
+    /// @return The slot, or nullptr if the callback has not been installed on the VM.
+    InterruptHook *GetInterruptHook(const global_State *pGlobalState);
+
+    /// @brief The interrupt callback installed on the VMs, chaining to the original one.
+    static void OnInterrupt(lua_State *L, int gc);
+
+public:
+    /// @brief Obtains the shared pointer that points to the global singleton for the current class.
+    /// @return Singleton for Preemption as a std::shared_ptr<Preemption>.
+    static std::shared_ptr<Preemption> GetSingleton();
+
+    /// @brief Installs the interrupt callback on the VM of the given lua_State, keeping the previous callback to call
+    /// it before ours. Installing it twice on the same VM does nothing.
+    void InstallInterrupt(lua_State *L);
+
+    /// @brief Gives the job whose chunk has the given source a time budget for every Scheduler step.
+    /// @param L A thread of the VM the job runs on.
+    /// @param pSource The source of the chunk of the job.
+    /// @param budget The time the job may run for on every Scheduler step before it is preempted.
+    void SetJobBudget(lua_State *L, const TString *pSource, std::chrono::steady_clock::duration budget);
+
+    /// @brief Records the thread the job whose chunk has the given source has been started on, which may be preempted
+    /// even within the protected call it runs in. Does nothing if the job has no budget.
+    /// @param pSource The source of the chunk of the job.
+    /// @param L The thread the job has been started on.
+    void SetJobThread(const TString *pSource, lua_State *L);
+
+    /// @brief Removes the budget of the job whose chunk has the given source, once it has finished. Does nothing if the
+    /// job has no budget.
+    /// @param L A thread of the VM the job ran on, used to release the reference the budget holds.
+    /// @param pSource The source of the chunk of the job.
+    void ReleaseJobBudget(lua_State *L, const TString *pSource);
+
+    /// @brief Removes the budgets of every job running on the given VM.
+    /// @param pGlobalState The VM to remove the budgets of.
+    /// @param L A thread of the VM, used to release the references the budgets hold, or nullptr if the VM is no longer
+    /// alive, in which case its references are gone already.
+    void ReleaseJobBudgets(const global_State *pGlobalState, lua_State *L);
+
+    /// @brief Begins a new slice for every budgeted job of the given VM. Called by its Scheduler on every step.
+    void OnSchedulerStep(const global_State *pGlobalState);
+
+    /// @brief Obtains the amount of times scripts have been preempted.
+    [[nodiscard]] std::uint64_t GetPreemptionCount() const;
+};
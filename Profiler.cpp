@@ -0,0 +1,202 @@
+#include "Profiler.hpp"
+
+#include <Windows.h>
+#include <algorithm>
+#include <array>
+#include <format>
+#include <fstream>
+#include <vector>
+
+#include "Logger.hpp"
+#include "MetricsRegistry.hpp"
+#include "Security.hpp"
+#include "lgc.h"
+#include "lstate.h"
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+std::shared_ptr<Profiler> Profiler::pInstance;
+
+std::shared_ptr<Profiler> Profiler::GetSingleton() {
+    if (Profiler::pInstance == nullptr)
+        Profiler::pInstance = std::make_shared<Profiler>();
+
+    return Profiler::pInstance;
+}
+
+void Profiler::Sample(lua_State *L, const int gc) {
+    // Only one of the VMs running at the time of the tick gets the sample.
+    if (!Profiler::bIsSamplePending.exchange(false, std::memory_order_relaxed))
+        return;
+
+    static auto &ownSamples = MetricsRegistry::GetSingleton()->GetCounter(
+            "rbxstu_profiler_samples_total", "The samples taken by the profiler, by whose thread was running.",
+            {{"thread", "rbxstu"}});
+    static auto &otherSamples = MetricsRegistry::GetSingleton()->GetCounter(
+            "rbxstu_profiler_samples_total", "The samples taken by the profiler, by whose thread was running.",
+            {{"thread", "roblox"}});
+
+    if (L->userdata == nullptr || !Security::IsOurThread(L)) {
+        otherSamples.Increment();
+        std::lock_guard lock{this->m_samplesMutex};
+        this->m_ullSamples++;
+        this->m_ullOtherSamples++;
+        return;
+    }
+
+    ownSamples.Increment();
+
+    // Frames are formatted leaf first, as the stack is walked, into buffers on the stack, so that nothing is allocated
+    // unless the stack has never been seen before.
+    std::array<char, 4096> aFrames;
+    std::array<std::string_view, Profiler::MaximumDepth + 2> aFrameViews;
+    std::size_t ullFrameCount = 0;
+    std::size_t ullUsed = 0;
+    const auto appendFrame = [&]<typename... TArgs>(std::format_string<TArgs...> fmt, TArgs &&...args) {
+        const auto pStart = aFrames.data() + ullUsed;
+        const auto result = std::format_to_n(pStart, aFrames.size() - ullUsed, fmt, std::forward<TArgs>(args)...);
+        // Semicolons separate frames, they may not be part of one.
+        std::replace(pStart, result.out, ';', ':');
+        std::replace(pStart, result.out, '\n', ' ');
+        ullUsed += static_cast<std::size_t>(result.out - pStart);
+        aFrameViews[ullFrameCount++] = {pStart, result.out};
+    };
+
+    if (gc >= 0)
+        appendFrame("[GC {}]", luaC_statename(gc));
+
+    lua_Debug ar{};
+    for (int dwLevel = 0; ullFrameCount < Profiler::MaximumDepth && lua_getinfo(L, dwLevel, "sn", &ar) != 0;
+         dwLevel++) {
+        // Functions are told apart by the line they are defined on, so that all of their samples merge into one frame.
+        if (ar.linedefined > 0)
+            appendFrame("{} ({}:{})", ar.name != nullptr ? ar.name : "<anonymous>", ar.short_src, ar.linedefined);
+        else
+            appendFrame("{} ({})", ar.name != nullptr ? ar.name : "<anonymous>", ar.short_src);
+    }
+
+    if (lua_stackdepth(L) > static_cast<int>(Profiler::MaximumDepth))
+        appendFrame("[truncated]");
+
+    std::array<char, 4096 + Profiler::MaximumDepth + 2> aStack;
+    std::size_t ullStackSize = 0;
+    for (auto i = ullFrameCount; i > 0; i--) {
+        const auto &szFrame = aFrameViews[i - 1];
+        if (ullStackSize != 0)
+            aStack[ullStackSize++] = ';';
+
+        ullStackSize = std::copy(szFrame.begin(), szFrame.end(), aStack.begin() + ullStackSize) - aStack.begin();
+    }
+
+    const std::string_view szStack{aStack.data(), ullStackSize};
+    std::lock_guard lock{this->m_samplesMutex};
+    this->m_ullSamples++;
+    if (const auto stack = this->m_mapStacks.find(szStack); stack != this->m_mapStacks.end())
+        stack->second++;
+    else
+        this->m_mapStacks.emplace(szStack, 1);
+}
+
+void Profiler::RunTimer() {
+    // High resolution timers (Windows 10 1803 onwards) fire well within a millisecond of their due time, whilst regular
+    // ones are only as precise as the system timer, usually 15.6ms.
+    auto hTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (hTimer == nullptr)
+        hTimer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+
+    if (hTimer == nullptr) {
+        Logger::GetSingleton()->PrintError(
+                RbxStu::Profiler, std::format("Failed to create the sampling timer! Error: {}", GetLastError()));
+        this->m_bIsRunning = false;
+        return;
+    }
+
+    // Relative due times are negative, in 100ns units.
+    LARGE_INTEGER dueTime{};
+    dueTime.QuadPart = -static_cast<LONGLONG>(10'000'000 / this->m_dwFrequency.load());
+    while (this->m_bIsRunning.load(std::memory_order_relaxed)) {
+        if (!SetWaitableTimer(hTimer, &dueTime, 0, nullptr, nullptr, FALSE) ||
+            WaitForSingleObject(hTimer, INFINITE) != WAIT_OBJECT_0)
+            break;
+
+        Profiler::bIsSamplePending.store(true, std::memory_order_relaxed);
+    }
+
+    CloseHandle(hTimer);
+}
+
+bool Profiler::Start(const std::uint32_t dwFrequency) {
+    std::lock_guard lock{this->m_controlMutex};
+    if (this->m_bIsRunning)
+        return false;
+
+    // The timer thread may have exited on its own, having failed to create its timer.
+    if (this->m_timerThread.joinable())
+        this->m_timerThread.join();
+
+    this->m_dwFrequency = std::clamp<std::uint32_t>(dwFrequency, 1, Profiler::MaximumFrequency);
+    this->m_bIsRunning = true;
+    this->m_timerThread = std::thread([this] { this->RunTimer(); });
+
+    Logger::GetSingleton()->PrintInformation(
+            RbxStu::Profiler,
+            std::format("Sampling RbxStu's threads {} times per second.", this->m_dwFrequency.load()));
+    return true;
+}
+
+bool Profiler::Stop() {
+    std::lock_guard lock{this->m_controlMutex};
+    if (!this->m_bIsRunning)
+        return false;
+
+    this->m_bIsRunning = false;
+    if (this->m_timerThread.joinable())
+        this->m_timerThread.join();
+
+    Profiler::bIsSamplePending = false;
+    return true;
+}
+
+bool Profiler::IsRunning() const { return this->m_bIsRunning; }
+
+void Profiler::Clear() {
+    std::lock_guard lock{this->m_samplesMutex};
+    this->m_mapStacks.clear();
+    this->m_ullSamples = 0;
+    this->m_ullOtherSamples = 0;
+}
+
+std::string Profiler::ExportFoldedStacks() {
+    std::vector<std::pair<std::string, std::uint64_t>> stacks;
+    std::uint64_t ullSamples;
+    std::uint64_t ullOtherSamples;
+    {
+        std::lock_guard lock{this->m_samplesMutex};
+        stacks.assign(this->m_mapStacks.begin(), this->m_mapStacks.end());
+        ullSamples = this->m_ullSamples;
+        ullOtherSamples = this->m_ullOtherSamples;
+    }
+
+    // Sorted, so that the profiles of two runs may be compared with a diff.
+    std::ranges::sort(stacks);
+    std::string szFolded;
+    for (const auto &[szStack, ullCount]: stacks)
+        szFolded += std::format("{} {}\n", szStack, ullCount);
+
+    Logger::GetSingleton()->PrintInformation(
+            RbxStu::Profiler,
+            std::format("Exported {} stacks from {} samples, {} of which were taken whilst Roblox's threads ran.",
+                        stacks.size(), ullSamples, ullOtherSamples));
+    return szFolded;
+}
+
+bool Profiler::DumpToFile(const std::filesystem::path &path) {
+    std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    file << this->ExportFoldedStacks();
+    return file.good();
+}
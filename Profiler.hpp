@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include "lua.h"
+
+/// @brief Samples the Luau call stacks of RbxStu's threads, aggregating them into the folded stack format that
+/// flamegraph tools (flamegraph.pl, inferno, speedscope) read.
+/// @remarks A timer thread raises a flag at the sampling frequency, which the interrupt callback installed by
+/// Preemption checks on every interrupt. The first interrupt to see it takes the sample, so samples are only ever taken
+/// on the thread running Luau, where its stack may be read safely. Samples taken whilst a thread that is not RbxStu's
+/// runs are only counted, they are the time the VM spent on Roblox's scripts.
+class Profiler final {
+    /// @brief Private, Static shared pointer into the instance.
+    static std::shared_ptr<Profiler> pInstance;
+
+    /// @brief Raised by the timer thread, taken by the interrupt that samples. Kept inline, as it is checked on every
+    /// interrupt of every VM.
+    inline static std::atomic_bool bIsSamplePending{false};
+
+    /// @brief Hashes strings and string views alike, so that stacks may be looked up without being copied.
+    struct StackHash {
+        using is_transparent = void;
+        std::size_t operator()(const std::string_view szStack) const {
+            return std::hash<std::string_view>{}(szStack);
+        }
+    };
+
+    /// @brief Guards starting and stopping the timer thread.
+    std::mutex m_controlMutex;
+    std::thread m_timerThread;
+    std::atomic_bool m_bIsRunning{false};
+    std::atomic_uint32_t m_dwFrequency{0};
+
+    /// @brief Guards the aggregated samples. Only contended by VMs sampled at once and by exports.
+    std::mutex m_samplesMutex;
+    /// @brief The amount of samples of every stack, keyed by their frames, root first, separated by semicolons.
+    std::unordered_map<std::string, std::uint64_t, StackHash, std::equal_to<>> m_mapStacks;
+    std::uint64_t m_ullSamples = 0;
+    /// @brief The samples taken whilst a thread that is not RbxStu's was running.
+    std::uint64_t m_ullOtherSamples = 0;
+
+    /// @brief Raises the sample flag at the sampling frequency until the profiler is stopped.
+    void RunTimer();
+
+public:
+    /// @brief The sampling frequency used if none is given, in samples per second.
+    static constexpr std::uint32_t DefaultFrequency = 1000;
+    static constexpr std::uint32_t MaximumFrequency = 10000;
+    /// @brief The deepest frames of a stack are kept, the ones closer to its root are dropped.
+    static constexpr std::size_t MaximumDepth = 64;
+
+    /// @brief Obtains the shared pointer that points to the global singleton for the current class.
+    /// @return Singleton for Profiler as a std::shared_ptr<Profiler>.
+    static std::shared_ptr<Profiler> GetSingleton();
+
+    /// @brief Obtains whether the timer has asked for a sample that has not been taken yet.
+    static bool IsSamplePending() { return Profiler::bIsSamplePending.load(std::memory_order_relaxed); }
+
+    /// @brief Takes a sample of the stack of L, if one is still pending. Called from the interrupt callback.
+    /// @param L The thread being interrupted.
+    /// @param gc The state of the garbage collector if the interrupt was raised by it, else a negative value.
+    void Sample(lua_State *L, int gc);
+
+    /// @brief Begins sampling. Samples taken so far are kept.
+    /// @param dwFrequency The samples to take per second, up to MaximumFrequency.
+    /// @return False if the profiler is running already.
+    bool Start(std::uint32_t dwFrequency = DefaultFrequency);
+
+    /// @brief Stops sampling, waiting for the timer thread to exit.
+    /// @return False if the profiler was not running.
+    bool Stop();
+
+    [[nodiscard]] bool IsRunning() const;
+
+    /// @brief Discards every sample taken so far.
+    void Clear();
+
+    /// @brief Generates the folded stacks of every sample taken so far, one "frame;frame;frame count" line per stack.
+    [[nodiscard]] std::string ExportFoldedStacks();
+
+    /// @brief Writes the stacks generated by ExportFoldedStacks into the given file, replacing its contents.
+    /// @return True if the file was written successfully.
+    bool DumpToFile(const std::filesystem::path &path);
+};
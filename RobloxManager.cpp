@@ -13,12 +13,17 @@
 #include "LuauManager.hpp"
 #include "Scanner.hpp"
 #include "Scheduler.hpp"
+#include "SchedulerManager.hpp"
 #include "Security.hpp"
+#include "TraceRecorder.hpp"
 #include "lualib.h"
 
 std::shared_mutex __robloxmanager__singleton__lock;
 
 void rbx_rbxcrash(const char *crashType, const char *crashDescription) {
+    static auto &invocations = RobloxManager::GetHookInvocations("RBX::RBXCRASH");
+    invocations.Increment();
+
     const auto logger = Logger::GetSingleton();
 
     if (crashType == nullptr)
@@ -32,6 +37,7 @@ void rbx_rbxcrash(const char *crashType, const char *crashDescription) {
     logger->PrintInformation(RbxStu::Hooked_RBXCrash, std::format("CRASH DESCRIPTION: {}", crashDescription));
 
     logger->PrintInformation(RbxStu::Hooked_RBXCrash, "Displaying stack trace!");
+    logger->Flush();
 
     SymInitialize(GetCurrentProcess(), nullptr, TRUE);
 
@@ -66,15 +72,19 @@ void rbx_rbxcrash(const char *crashType, const char *crashDescription) {
 std::shared_mutex __rbx__scriptcontext__resumeWaitingThreads__lock;
 
 /// @brief Used for the hook of RBX::ScriptContext::resumeWaitingThreads to prevent accessing uninitialized lua_States.
-std::atomic_int calledBeforeCount;
+/// Counted separately for every DataModel type, as each one initializes its own Scheduler.
+std::map<RBX::DataModelType, std::int32_t> calledBeforeCount;
 
 void *rbx__scriptcontext__resumeWaitingThreads(
         void *waitingHybridScriptsJob) { // the "scriptContext" is actually a std::vector of waitinghybridscripts as it
                                          // seems.
 
+    static auto &invocations = RobloxManager::GetHookInvocations("RBX::ScriptContext::resumeDelayedThreads");
+    invocations.Increment();
+
     const auto robloxManager = RobloxManager::GetSingleton();
     const auto logger = Logger::GetSingleton();
-    const auto scheduler = Scheduler::GetSingleton();
+    const auto schedulerManager = SchedulerManager::GetSingleton();
     const auto security = Security::GetSingleton();
 
     if (!robloxManager->IsInitialized())
@@ -88,62 +98,87 @@ void *rbx__scriptcontext__resumeWaitingThreads(
     // logger->PrintInformation(RbxStu::HookedFunction,
     //                         std::format("ScriptContext::resumeWaitingThreads. ScriptContext: {:#x}", ScriptContext));
 
-    if (!scheduler->IsInitialized()) { // !scheduler->is_initialized()
+    // The Heartbeat of a closed DataModel never fires again, so its Scheduler must be reset from here. Only the
+    // Schedulers whose DataModel went away are reset, the rest keep running whatever they have queued.
+    for (const auto dataModelType:
+         {RBX::DataModelType_Edit, RBX::DataModelType_PlayClient, RBX::DataModelType_PlayServer}) {
+        if (const auto scheduler = schedulerManager->GetScheduler(dataModelType).value();
+            scheduler->IsInitialized() && !robloxManager->IsDataModelValid(dataModelType)) {
+            logger->PrintWarning(RbxStu::HookedFunction,
+                                 std::format("DataModel for {} is invalid, yet its scheduler is initialized, resetting "
+                                             "scheduler!",
+                                             RBX::DataModelTypeToString(dataModelType)));
+            scheduler->ResetScheduler();
+        }
+    }
+
+    {
         auto getDataModel = reinterpret_cast<RbxStu::StudioFunctionDefinitions::r_RBX_ScriptContext_getDataModel>(
                 robloxManager->GetRobloxFunction("RBX::ScriptContext::getDataModel"));
         if (getDataModel == nullptr) {
-            logger->PrintWarning(RbxStu::HookedFunction, "Initialization of Scheduler may be unstable! Cannot "
-                                                         "determine DataModel for the obtained ScriptContext!");
-        } else {
-            const auto expectedDataModel = robloxManager->GetCurrentDataModel(RBX::DataModelType_PlayClient);
-            if (!expectedDataModel.has_value() || getDataModel(scriptContext) != expectedDataModel.value() ||
-                !robloxManager->IsDataModelValid(RBX::DataModelType_PlayClient)) {
-                goto __scriptContext_resumeWaitingThreads__cleanup;
+            logger->PrintWarning(RbxStu::HookedFunction, "Cannot initialize the Scheduler! Cannot determine DataModel "
+                                                         "for the obtained ScriptContext!");
+            goto __scriptContext_resumeWaitingThreads__cleanup;
+        }
+
+        // Find out which of the DataModels we know of owns this ScriptContext, that is the Scheduler it initializes.
+        const auto dataModel = getDataModel(scriptContext);
+        std::optional<RBX::DataModelType> dataModelType;
+        for (const auto type: {RBX::DataModelType_Edit, RBX::DataModelType_PlayClient, RBX::DataModelType_PlayServer}) {
+            if (const auto expectedDataModel = robloxManager->GetCurrentDataModel(type);
+                expectedDataModel.has_value() && expectedDataModel.value() == dataModel) {
+                dataModelType = type;
+                break;
             }
         }
 
-        // HACK!: We do not want to initialize the scheduler on the
-        // first resumptions of waiting threads. This will cause
-        // us to access invalid memory, as the global state is not truly set up yet apparently,
-        // race conditions at their finest! This had to be increased, because Roblox.
-        if (calledBeforeCount <= 16) {
-            calledBeforeCount += 1;
+        if (!dataModelType.has_value() || !robloxManager->IsDataModelValid(dataModelType.value()))
             goto __scriptContext_resumeWaitingThreads__cleanup;
-        }
 
-        const auto optionalrL = robloxManager->GetGlobalState(scriptContext);
-        logger->PrintWarning(RbxStu::HookedFunction,
-                             std::format("WaitingHybridScriptsJob: {}", waitingHybridScriptsJob));
-        logger->PrintWarning(RbxStu::HookedFunction, std::format("ScriptContext: {}", scriptContext));
-        logger->PrintWarning(RbxStu::HookedFunction, std::format("ScriptContext__GlobalState: {}",
-                                                                 reinterpret_cast<void *>(optionalrL.value())));
-
-
-        if (optionalrL.has_value() && robloxManager->IsDataModelValid(RBX::DataModelType_PlayClient)) {
-            const auto robloxL = optionalrL.value();
-            lua_State *rL = lua_newthread(robloxL);
-            lua_pop(robloxL, 1);
-            lua_State *L = lua_newthread(robloxL);
-            lua_pop(robloxL, 1);
-            security->SetThreadSecurity(rL, 8);
-            security->SetThreadSecurity(L, 8);
-            lua_pop(L, lua_gettop(L));
-
-            scheduler->InitializeWith(L, rL, getDataModel(scriptContext));
+        const auto scheduler = schedulerManager->GetScheduler(dataModelType.value()).value();
+        if (!scheduler->IsInitialized()) {
+            // HACK!: We do not want to initialize the scheduler on the
+            // first resumptions of waiting threads. This will cause
+            // us to access invalid memory, as the global state is not truly set up yet apparently,
+            // race conditions at their finest! This had to be increased, because Roblox.
+            if (calledBeforeCount[dataModelType.value()] <= 16) {
+                calledBeforeCount[dataModelType.value()] += 1;
+                goto __scriptContext_resumeWaitingThreads__cleanup;
+            }
+
+            const auto optionalrL = robloxManager->GetGlobalState(scriptContext);
+            RbxStuLog(Debug, RbxStu::HookedFunction, "WaitingHybridScriptsJob: {}", waitingHybridScriptsJob);
+            RbxStuLog(Debug, RbxStu::HookedFunction, "ScriptContext: {}", scriptContext);
+            RbxStuLog(Debug, RbxStu::HookedFunction, "ScriptContext__GlobalState: {}",
+                      reinterpret_cast<void *>(optionalrL.value()));
+
+            if (optionalrL.has_value()) {
+                const auto robloxL = optionalrL.value();
+                lua_State *rL = lua_newthread(robloxL);
+                lua_pop(robloxL, 1);
+                lua_State *L = lua_newthread(robloxL);
+                lua_pop(robloxL, 1);
+                security->SetThreadSecurity(rL, 8);
+                security->SetThreadSecurity(L, 8);
+                lua_pop(L, lua_gettop(L));
+
+                scheduler->InitializeWith(std::make_shared<RobloxSchedulerHost>(dataModelType.value()), L, rL,
+                                          dataModel);
+            }
         }
-    } else if (scheduler->IsInitialized() && !robloxManager->IsDataModelValid(RBX::DataModelType_PlayClient)) {
-        logger->PrintWarning(RbxStu::HookedFunction, "DataModel for client is invalid, yet the scheduler is "
-                                                     "initialized, resetting scheduler!");
-        scheduler->ResetScheduler();
+
+        calledBeforeCount[dataModelType.value()] = 0;
     }
 
-    calledBeforeCount = 0;
 __scriptContext_resumeWaitingThreads__cleanup:
     __rbx__scriptcontext__resumeWaitingThreads__lock.unlock();
     return reinterpret_cast<RbxStu::StudioFunctionDefinitions::r_RBX_ScriptContext_resumeDelayedThreads>(
             robloxManager->GetHookOriginal("RBX::ScriptContext::resumeDelayedThreads"))(waitingHybridScriptsJob);
 }
 void rbx__datamodel__dodatamodelclose(void **dataModelContainer) {
+    static auto &invocations = RobloxManager::GetHookInvocations("RBX::DataModel::doDataModelClose");
+    invocations.Increment();
+
     // DataModel = *(dataModelContainer + 0x8)
     auto dataModel = *reinterpret_cast<void **>(reinterpret_cast<std::uintptr_t>(dataModelContainer) + 0x8);
 
@@ -184,6 +219,9 @@ void rbx__datamodel__dodatamodelclose(void **dataModelContainer) {
 }
 
 std::int32_t rbx__datamodel__getstudiogamestatetype(RBX::DataModel *dataModel) {
+    static auto &invocations = RobloxManager::GetHookInvocations("RBX::DataModel::getStudioGameStateType");
+    invocations.Increment();
+
     auto robloxManager = RobloxManager::GetSingleton();
     auto original = reinterpret_cast<RbxStu::StudioFunctionDefinitions::r_RBX_DataModel_getStudioGameStateType>(
             robloxManager->GetHookOriginal("RBX::DataModel::getStudioGameStateType"));
@@ -281,7 +319,7 @@ void RobloxManager::Initialize() {
 
     logger->PrintInformation(RbxStu::RobloxManager, "Functions Found via simple scanning:");
     for (const auto &[funcName, funcAddress]: this->m_mapRobloxFunctions) {
-        logger->PrintInformation(RbxStu::RobloxManager, std::format("- '{}' at address {}.", funcName, funcAddress));
+        RbxStuLog(Debug, RbxStu::RobloxManager, "- '{}' at address {}.", funcName, funcAddress);
     }
 
     logger->PrintInformation(RbxStu::RobloxManager, "Additional dumping step... [2/3]");
@@ -529,7 +567,8 @@ void *RobloxManager::GetRobloxFunction(const std::string &functionName) {
     return nullptr;
 }
 
-void RobloxManager::ResumeScript(RBX::Lua::WeakThreadRef *threadRef, const std::int32_t nret) {
+void RobloxManager::ResumeScript(RBX::Lua::WeakThreadRef *threadRef, const std::int32_t nret, const bool isError,
+                                 const char *szErrorMessage) {
     const auto logger = Logger::GetSingleton();
     if (!this->m_bInitialized) {
         logger->PrintError(RbxStu::RobloxManager, "Cannot obtain resume. Reason: RobloxManager is not initialized.");
@@ -550,8 +589,7 @@ void RobloxManager::ResumeScript(RBX::Lua::WeakThreadRef *threadRef, const std::
     auto scriptContext = extraSpace->sharedExtraSpace->scriptContext;
 
     int64_t out[0x2]{0};
-    logger->PrintInformation(RbxStu::RobloxManager,
-                             std::format("Resuming thread {}!", reinterpret_cast<void *>(threadRef->thread)));
+    RbxStuTrace(RbxStu::RobloxManager, "Resuming thread {}!", reinterpret_cast<void *>(threadRef->thread));
 
 
     /// Roblox has decided to make our lifes more annoying. ScriptContext, when calling resume, must be offset (its
@@ -559,19 +597,17 @@ void RobloxManager::ResumeScript(RBX::Lua::WeakThreadRef *threadRef, const std::
     /// violation, this offset can be updated by searching for xrefs to "[FLog::ScriptContext] Resuming script: %p"
 
     try {
+        const RbxStu::TraceSpan span{RbxStu::RobloxManager, "RBX::ScriptContext::resume"};
         resumeFunction(reinterpret_cast<void *>(reinterpret_cast<std::uintptr_t>(scriptContext) + 0x698), out,
-                       &threadRef, nret, false, nullptr);
+                       &threadRef, nret, isError, szErrorMessage);
     } catch (const std::exception &ex) {
         logger->PrintError(RbxStu::RobloxManager,
                            std::format("An error occured whilst resuming the thread! Exception: {}", ex.what()));
     }
 
 
-    logger->PrintInformation(
-            RbxStu::RobloxManager,
-            std::format("RBX::ScriptContext::resume : [Status (0x1)]: {}; [Unknown (0x2)]: {}", out[0], out[1]));
-
-    delete[] out;
+    RbxStuTrace(RbxStu::RobloxManager, "RBX::ScriptContext::resume : [Status (0x1)]: {}; [Unknown (0x2)]: {}", out[0],
+                out[1]);
 }
 
 void *RobloxManager::GetHookOriginal(const std::string &functionName) {
@@ -582,6 +618,12 @@ void *RobloxManager::GetHookOriginal(const std::string &functionName) {
     return this->GetRobloxFunction(functionName); // Redirect to GetRobloxFunction.
 }
 
+RbxStu::Metrics::Counter &RobloxManager::GetHookInvocations(const std::string &functionName) {
+    return MetricsRegistry::GetSingleton()->GetCounter("rbxstu_hook_invocations_total",
+                                                       "The times each function RbxStu hooks has been called.",
+                                                       {{"hook", functionName}});
+}
+
 static std::shared_mutex __datamodelModificationMutex;
 
 std::optional<RBX::DataModel *> RobloxManager::GetCurrentDataModel(const RBX::DataModelType &dataModelType) const {
@@ -613,9 +655,8 @@ void RobloxManager::SetCurrentDataModel(const RBX::DataModelType &dataModelType,
             return;
         }
         this->m_mapDataModelMap[dataModelType] = dataModel;
-        logger->PrintInformation(RbxStu::RobloxManager, std::format("DataModel of type {} modified to point to: {}",
-                                                                    RBX::DataModelTypeToString(dataModelType),
-                                                                    reinterpret_cast<void *>(dataModel)));
+        RbxStuLog(Information, RbxStu::RobloxManager, "DataModel of type {} modified to point to: {}",
+                  RBX::DataModelTypeToString(dataModelType), reinterpret_cast<void *>(dataModel));
     }
 }
 
@@ -7,6 +7,7 @@
 #include <memory>
 #include <mutex>
 #include <optional>
+#include "MetricsRegistry.hpp"
 #include "Roblox/TypeDefinitions.hpp"
 #include "Scanner.hpp"
 #include "lua.h"
@@ -272,7 +273,10 @@ public:
     /// @brief Resumes a lua_State through the Roblox scheduler
     /// @param threadRef The thread reference representing the state of the thread for yielding
     /// @param nret The number of returns after yielding.
-    void ResumeScript(RBX::Lua::WeakThreadRef *threadRef, std::int32_t nret);
+    /// @param isError Whether the thread should be resumed with an error instead of with results.
+    /// @param szErrorMessage The error message to resume the thread with, only used if isError is true.
+    void ResumeScript(RBX::Lua::WeakThreadRef *threadRef, std::int32_t nret, bool isError = false,
+                      const char *szErrorMessage = nullptr);
 
     /// @brief Obtains the original function given the function's name.
     /// @param functionName The name of the Roblox function to obtain the original from.
@@ -283,6 +287,11 @@ public:
     /// @return A type-less pointer into the start of the original function.
     void *GetHookOriginal(const std::string &functionName);
 
+    /// @brief Obtains the counter of the invocations of a hooked function, exported as rbxstu_hook_invocations_total.
+    /// @param functionName The name of the hooked function, as given to GetHookOriginal.
+    /// @remarks Hooks look their counter up once, and keep it in a function-local static.
+    static RbxStu::Metrics::Counter &GetHookInvocations(const std::string &functionName);
+
     /// @brief Obtains the most recient and up-to-date DataModel for the given DataModel type.
     /// @param type Describes the type of DataModel to check for.
     /// @return A std::optional<RBX::DataModel *> into an instance of a DataModel which is of the type described on the
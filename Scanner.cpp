@@ -4,6 +4,8 @@
 
 #include "Scanner.hpp"
 
+#include "TraceRecorder.hpp"
+
 std::shared_ptr<Scanner> Scanner::pInstance;
 
 Signature SignatureByte::GetSignatureFromString(const std::string &aob, const std::string &mask) {
@@ -107,6 +109,7 @@ std::shared_ptr<Scanner> Scanner::GetSingleton() {
     return Scanner::pInstance;
 }
 std::vector<void *> Scanner::Scan(const Signature &signature, const void *lpStartAddress) {
+    const RbxStu::TraceSpan span{RbxStu::ByteScanner, "Scan"};
     const auto logger = Logger::GetSingleton();
 
     if (lpStartAddress == nullptr) {
@@ -119,10 +122,7 @@ std::vector<void *> Scanner::Scan(const Signature &signature, const void *lpStar
     std::vector<std::future<std::vector<void *>>> scansVector{};
     std::vector<void *> results{};
     MEMORY_BASIC_INFORMATION memoryInfo{};
-#if _DEBUG
-    logger->PrintInformation(RbxStu::ByteScanner,
-                             std::format("Beginning scan from address {} to far beyond!", lpStartAddress));
-#endif
+    RbxStuLog(Debug, RbxStu::ByteScanner, "Beginning scan from address {} to far beyond!", lpStartAddress);
     auto startAddress = reinterpret_cast<std::uintptr_t>(lpStartAddress);
 
     while (VirtualQuery(reinterpret_cast<void *>(startAddress), &memoryInfo, sizeof(MEMORY_BASIC_INFORMATION))) {
@@ -143,6 +143,7 @@ std::vector<void *> Scanner::Scan(const Signature &signature, const void *lpStar
                 //         memoryInfo.BaseAddress));
                 return std::vector<void *>{};
             }
+            const RbxStu::TraceSpan regionSpan{RbxStu::ByteScanner, "ScanRegion"};
             auto *buffer = new unsigned char[memoryInfo.RegionSize];
             memcpy(buffer, memoryInfo.BaseAddress, memoryInfo.RegionSize);
 
@@ -154,17 +155,16 @@ std::vector<void *> Scanner::Scan(const Signature &signature, const void *lpStar
         startAddress += memoryInfo.RegionSize;
     }
 
+    const RbxStu::TraceSpan collectSpan{RbxStu::ByteScanner, "CollectResults"};
     for (auto &i: scansVector) {
         auto async_result = i.get();
         for (const auto &e: async_result) {
+            RbxStuTrace(RbxStu::ByteScanner, "Candidate found at {}.", e);
             results.push_back(e);
         }
     }
 
-#if _DEBUG
-    logger->PrintInformation(
-            RbxStu::ByteScanner,
-            std::format("Scan finalized. Found {} candidates for the given signature.", results.size()));
-#endif
+    RbxStuLog(Debug, RbxStu::ByteScanner, "Scan finalized. Found {} candidates for the given signature.",
+              results.size());
     return results;
 }
@@ -1,55 +1,402 @@
 #include <Scheduler.hpp>
+#include <cstring>
 #include <iostream>
+#include <mutex>
 #include <shared_mutex>
 
-#include "Communication.hpp"
-#include "Environment/EnvironmentManager.hpp"
+#include "CoverageCollector.hpp"
+#include "ExecutionReporter.hpp"
+#include "LatencyTracker.hpp"
 #include "Luau/CodeGen/include/Luau/CodeGen.h"
 #include "Luau/Compiler.h"
 #include "Luau/Compiler/src/Builtins.h"
-#include "LuauManager.hpp"
-#include "RobloxManager.hpp"
-#include "Security.hpp"
+#include "MetricsRegistry.hpp"
+#include "Preemption.hpp"
+#include "TraceRecorder.hpp"
+#include "ThreadPool.hpp"
+#include "lapi.h"
 #include "lstate.h"
 #include "lualib.h"
 
-std::shared_ptr<Scheduler> Scheduler::pInstance;
+static std::atomic_uint64_t s_ullExecutedJobs;
 
-std::shared_ptr<Scheduler> Scheduler::GetSingleton() {
-    if (Scheduler::pInstance == nullptr)
-        Scheduler::pInstance = std::make_shared<Scheduler>();
+/// @brief The metrics shared by every Scheduler.
+struct SchedulerMetrics {
+    RbxStu::Metrics::Counter &luauJobsQueued;
+    RbxStu::Metrics::Counter &yieldsQueued;
+    RbxStu::Metrics::Counter &luauJobsExecuted;
+    RbxStu::Metrics::Counter &resumptionsExecuted;
+    /// @brief The threads that have yielded on a C function and have not been resumed yet.
+    RbxStu::Metrics::Gauge &yieldsInFlight;
+};
+
+static SchedulerMetrics &GetSchedulerMetrics() {
+    static SchedulerMetrics metrics = [] {
+        const auto registry = MetricsRegistry::GetSingleton();
+        constexpr auto szQueuedHelp = "The jobs queued into the Scheduler, yielded threads counted once.";
+        constexpr auto szExecutedHelp = "The jobs executed by the Scheduler, including resumptions that found their "
+                                        "operation still in flight.";
+        return SchedulerMetrics{
+                registry->GetCounter("rbxstu_scheduler_jobs_queued_total", szQueuedHelp, {{"kind", "luau"}}),
+                registry->GetCounter("rbxstu_scheduler_jobs_queued_total", szQueuedHelp, {{"kind", "yield"}}),
+                registry->GetCounter("rbxstu_scheduler_jobs_executed_total", szExecutedHelp, {{"kind", "luau"}}),
+                registry->GetCounter("rbxstu_scheduler_jobs_executed_total", szExecutedHelp, {{"kind", "yield"}}),
+                registry->GetGauge("rbxstu_scheduler_yields_in_flight",
+                                   "The threads yielded on a C function that have not been resumed yet."),
+        };
+    }();
+
+    return metrics;
+}
+
+void RbxStu::RecordCompilation(const char *szOrigin, const std::size_t ullSourceSize,
+                               const std::size_t ullBytecodeSize, const std::chrono::steady_clock::duration duration) {
+    const auto registry = MetricsRegistry::GetSingleton();
+    const RbxStu::Metrics::Labels labels{{"origin", szOrigin}};
+    registry->GetCounter("rbxstu_compile_source_bytes_total", "The bytes of Luau source compiled.", labels)
+            .Increment(ullSourceSize);
+    registry->GetCounter("rbxstu_compile_bytecode_bytes_total", "The bytes of bytecode the compiled source yielded.",
+                         labels)
+            .Increment(ullBytecodeSize);
+    registry->GetHistogram("rbxstu_compile_duration_seconds", "The time spent compiling Luau source into bytecode.",
+                           RbxStu::Metrics::DurationBuckets, labels)
+            .ObserveDuration(duration);
+}
+
+Scheduler::Scheduler(const RBX::DataModelType dataModelType) {
+    this->m_dataModelType = dataModelType;
+
+    const auto registry = MetricsRegistry::GetSingleton();
+    const RbxStu::Metrics::Labels labels{{"datamodel", RBX::DataModelTypeToString(dataModelType)}};
+    const auto getCycleGauge = [&registry, &labels](const char *szPhase) {
+        auto phaseLabels = labels;
+        phaseLabels.emplace_back("phase", szPhase);
+        return &registry->GetGauge("rbxstu_luau_gc_last_cycle_seconds",
+                                   "The time the last completed garbage collection cycle spent in each phase.",
+                                   phaseLabels);
+    };
+
+    this->m_metrics.pHeapSize =
+            &registry->GetGauge("rbxstu_luau_heap_bytes", "The bytes allocated by the Luau VM.", labels);
+    this->m_metrics.pHeapThreshold =
+            &registry->GetGauge("rbxstu_luau_gc_threshold_bytes",
+                                "The heap size at which the garbage collector runs its next step.", labels);
+    this->m_metrics.pCompletedCycles = &registry->GetGauge(
+            "rbxstu_luau_gc_completed_cycles", "The garbage collection cycles the Luau VM has completed.", labels);
+    this->m_metrics.pAssistTime =
+            &registry->GetGauge("rbxstu_luau_gc_assist_seconds",
+                                "The time spent in garbage collection steps triggered by allocations.", labels);
+    this->m_metrics.pExplicitTime =
+            &registry->GetGauge("rbxstu_luau_gc_explicit_seconds",
+                                "The time spent in garbage collection steps requested explicitly.", labels);
+    this->m_metrics.pLastPauseTime = getCycleGauge("pause");
+    this->m_metrics.pLastMarkTime = getCycleGauge("mark");
+    this->m_metrics.pLastAtomicTime = getCycleGauge("atomic");
+    this->m_metrics.pLastSweepTime = getCycleGauge("sweep");
+    this->m_metrics.pParkedJobs = &registry->GetGauge(
+            "rbxstu_scheduler_jobs_parked", "The yielded jobs waiting on their operation to complete.", labels);
+
+    constexpr const char *aLaneNames[] = {"resumption", "interactive", "background"};
+    for (std::size_t i = 0; i < this->m_metrics.aQueuedJobs.size(); i++) {
+        auto laneLabels = labels;
+        laneLabels.emplace_back("lane", aLaneNames[i]);
+        this->m_metrics.aQueuedJobs[i] = &registry->GetGauge(
+                "rbxstu_scheduler_jobs_pending", "The jobs queued on each lane of the Scheduler.", laneLabels);
+    }
+}
+
+RBX::DataModelType Scheduler::GetDataModelType() const { return this->m_dataModelType; }
+
+void Scheduler::ScheduleJob(SchedulerJob job) {
+    // Jobs are only ever put into a lane once they are queued, jobs that were never enqueued are new.
+    if (job.enqueuedAt == std::chrono::steady_clock::time_point{}) {
+        const auto &metrics = GetSchedulerMetrics();
+        if (job.bIsLuaCode) {
+            metrics.luauJobsQueued.Increment();
+        } else if (job.bIsYieldingJob) {
+            metrics.yieldsQueued.Increment();
+            metrics.yieldsInFlight.Add(1);
+        }
+    }
+
+    if (job.bIsLuaCode && job.luaJob.trace.queued == std::chrono::steady_clock::time_point{}) {
+        job.luaJob.trace.queued = std::chrono::steady_clock::now();
+        // Jobs that did not come through the pipe are received the moment they are queued.
+        if (job.luaJob.trace.received == std::chrono::steady_clock::time_point{})
+            job.luaJob.trace.received = job.luaJob.trace.queued;
+    }
+
+    if (job.IsWaiting()) {
+        this->ParkJob(std::move(job));
+        return;
+    }
+
+    this->m_jobLanes.Enqueue(std::move(job));
+}
+
+void Scheduler::ParkJob(SchedulerJob job) {
+    auto &promise = job.yieldJob.hCoroutine.promise();
+    std::lock_guard lock{this->m_parkedMutex};
+    const auto ullParkId = ++this->m_ullLastParkId;
+    this->m_mapParkedJobs.emplace(ullParkId, std::move(job));
+    if (promise.deadline != std::chrono::steady_clock::time_point::max())
+        this->m_timerWheel.Schedule(promise.deadline, ullParkId);
+
+    // Nothing wakes up a Task waiting on its deadline alone but the timer wheel.
+    if (promise.bWakeOnDeadline)
+        return;
+
+    // If the operation completed before we got to park the Task it will never be woken up, the job must go straight
+    // into its lane instead.
+    promise.waker.pfnWake = [](void *pScheduler, const std::uint64_t ullId) {
+        static_cast<Scheduler *>(pScheduler)->WakeJob(ullId);
+    };
+    promise.waker.pContext = this;
+    promise.waker.ullId = ullParkId;
+    if (auto expected = RbxStu::TaskState::Waiting;
+        !promise.state.compare_exchange_strong(expected, RbxStu::TaskState::Parked)) {
+        this->m_jobLanes.Enqueue(std::move(this->m_mapParkedJobs.extract(ullParkId).mapped()));
+    }
+}
+
+void Scheduler::WakeJob(const std::uint64_t ullParkId) {
+    std::lock_guard lock{this->m_parkedMutex};
+    // The job may have been moved back into its lane already when its deadline was reached.
+    if (auto node = this->m_mapParkedJobs.extract(ullParkId); !node.empty())
+        this->m_jobLanes.Enqueue(std::move(node.mapped()));
+}
+
+void Scheduler::ExpireParkedJobs() {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard lock{this->m_parkedMutex};
+    this->m_timerWheel.Advance(now, [this, now](const std::uint64_t ullParkId) {
+        // The timers of jobs that were woken up by their operation are left on the wheel, and simply ignored here.
+        auto node = this->m_mapParkedJobs.extract(ullParkId);
+        if (node.empty())
+            return;
+
+        if (auto &promise = node.mapped().yieldJob.hCoroutine.promise(); promise.bWakeOnDeadline) {
+            promise.readyAt = now;
+            promise.state = RbxStu::TaskState::Ready;
+        }
+
+        this->m_jobLanes.Enqueue(std::move(node.mapped()));
+    });
+}
+
+void Scheduler::SampleMetrics(lua_State *L) {
+    const auto *pGlobal = L->global;
+    this->m_metrics.pHeapSize->Set(static_cast<double>(pGlobal->totalbytes));
+    this->m_metrics.pHeapThreshold->Set(static_cast<double>(pGlobal->GCthreshold));
+
+    // Timings are taken by the VM with lua_clock, in seconds.
+    const auto &gcMetrics = pGlobal->gcmetrics;
+    this->m_metrics.pCompletedCycles->Set(static_cast<double>(gcMetrics.completedcycles));
+    this->m_metrics.pAssistTime->Set(gcMetrics.stepassisttimeacc);
+    this->m_metrics.pExplicitTime->Set(gcMetrics.stepexplicittimeacc);
+    this->m_metrics.pLastPauseTime->Set(gcMetrics.lastcycle.pausetime);
+    this->m_metrics.pLastMarkTime->Set(gcMetrics.lastcycle.marktime);
+    this->m_metrics.pLastAtomicTime->Set(gcMetrics.lastcycle.atomictime);
+    this->m_metrics.pLastSweepTime->Set(gcMetrics.lastcycle.sweeptime);
+
+    for (std::size_t i = 0; i < this->m_metrics.aQueuedJobs.size(); i++)
+        this->m_metrics.aQueuedJobs[i]->Set(
+                static_cast<double>(this->m_jobLanes.GetQueueDepth(static_cast<RbxStu::JobPriority>(i))));
+
+    // The pool is shared by every Scheduler, whichever steps last leaves its snapshot.
+    static const auto aPoolGauges = [] {
+        const auto registry = MetricsRegistry::GetSingleton();
+        constexpr auto szHelp = "The tasks of the ThreadPool, by whether they are queued, held back as their owner has "
+                                "too many in flight, or running.";
+        return std::array{
+                &registry->GetGauge("rbxstu_threadpool_tasks", szHelp, {{"state", "queued"}}),
+                &registry->GetGauge("rbxstu_threadpool_tasks", szHelp, {{"state", "throttled"}}),
+                &registry->GetGauge("rbxstu_threadpool_tasks", szHelp, {{"state", "running"}}),
+                &registry->GetGauge("rbxstu_threadpool_peak_queued_tasks",
+                                    "The most tasks ever queued on the ThreadPool at once."),
+        };
+    }();
+    const auto poolMetrics = ThreadPool::GetSingleton()->GetMetrics();
+    aPoolGauges[0]->Set(static_cast<double>(poolMetrics.ullQueueDepth));
+    aPoolGauges[1]->Set(static_cast<double>(poolMetrics.ullThrottledDepth));
+    aPoolGauges[2]->Set(static_cast<double>(poolMetrics.ullRunning));
+    aPoolGauges[3]->Set(static_cast<double>(poolMetrics.ullPeakQueueDepth));
+
+    std::lock_guard lock{this->m_parkedMutex};
+    this->m_metrics.pParkedJobs->Set(static_cast<double>(this->m_mapParkedJobs.size()));
+}
 
-    return Scheduler::pInstance;
+std::shared_ptr<SchedulerHost> Scheduler::GetHost() const { return this->m_pHost; }
+
+/// @brief The name of the chunk of the trampoline WrapWithJobTrace wraps jobs with.
+constexpr auto JobTrampolineChunkName = "RbxStuV2::JobTrace";
+
+/// @brief The state a job trampoline keeps alongside it, as a userdata shared by its callbacks.
+struct JobTrampolineState {
+    RbxStu::JobTrace trace;
+    /// @brief The report ID of the job, see ExecutionReporter.
+    std::uint64_t ullReportId;
+    /// @brief The source of the chunk of the job. Kept alive by the function the trampoline wraps.
+    const TString *pSource;
+    /// @brief The function of the job, if its coverage is being collected. Collected once the job finishes.
+    std::optional<CoverageCollector::TrackedChunk> coverage;
+};
+
+/// @brief Collects the coverage of the job the trampoline belongs to, if it is tracked and has not been collected yet.
+static void CollectJobCoverage(lua_State *L, JobTrampolineState *pState) {
+    if (!pState->coverage.has_value())
+        return;
+
+    CoverageCollector::GetSingleton()->Collect(L, pState->coverage.value());
+    pState->coverage.reset();
 }
 
-void Scheduler::ScheduleJob(SchedulerJob job) { this->m_qSchedulerJobs.emplace(job); }
+/// @brief Builds the traceback of the error being handled on L, from the function that raised it down to the
+/// trampoline, in the format of debug.traceback.
+static std::string GetErrorTraceback(lua_State *L) {
+    std::string szTraceback = luaL_tolstring(L, 1, nullptr);
+    lua_pop(L, 1);
+
+    lua_Debug ar{};
+    for (int dwLevel = 1; lua_getinfo(L, dwLevel, "sln", &ar) != 0; dwLevel++) {
+        if (std::strcmp(ar.source, JobTrampolineChunkName) == 0)
+            break;
+
+        szTraceback += std::format("\n{}", ar.short_src);
+        if (ar.currentline > 0)
+            szTraceback += std::format(":{}", ar.currentline);
+        if (ar.name != nullptr)
+            szTraceback += std::format(" function {}", ar.name);
+    }
 
-SchedulerJob Scheduler::DequeueSchedulerJob() {
-    if (this->m_qSchedulerJobs.empty())
-        return SchedulerJob("");
-    auto job = this->m_qSchedulerJobs.back();
-    this->m_qSchedulerJobs.pop();
-    return job;
+    return szTraceback;
+}
+
+/// @brief Replaces the function on top of the stack of L with a Luau function that calls it, recording when it first
+/// runs and when it completes, and reporting both and any error it raises to its submitter. Being a Luau function, the
+/// script may still yield through it freely.
+/// @param pHost The host to elevate the wrapper through.
+/// @param L The lua_State the function is on.
+/// @param trace The trace of the job the function belongs to.
+/// @param ullReportId The report ID of the job, or zero if nobody is listening.
+/// @param coverage The function of the job, if its coverage is being collected.
+/// @return The copy of the trace that lives alongside the wrapper, or nullptr if the function could not be wrapped, in
+/// which case it is left as it was.
+static RbxStu::JobTrace *WrapWithJobTrace(SchedulerHost *pHost, lua_State *L, const RbxStu::JobTrace &trace,
+                                          const std::uint64_t ullReportId,
+                                          const std::optional<CoverageCollector::TrackedChunk> &coverage) {
+    // Errors are caught to report them with the stack they were raised on, and raised again as they were so that
+    // Roblox reports them as it always has.
+    static const auto szTrampolineBytecode = Luau::compile(R"(
+local fn, onResumed, onCompleted, onFailed = ...
+return function(...)
+    onResumed()
+    local bSucceeded, err = xpcall(fn, onFailed, ...)
+    if not bSucceeded then
+        error(err, 0)
+    end
+    onCompleted()
+end
+)");
+
+    const auto pSource = static_cast<const Closure *>(lua_topointer(L, -1))->l.p->source;
+    if (luau_load(L, JobTrampolineChunkName, szTrampolineBytecode.c_str(), szTrampolineBytecode.size(), 0) !=
+        LUA_OK) {
+        Logger::GetSingleton()->PrintError(RbxStu::Scheduler,
+                                           std::format("Failed to load job trace trampoline: {}", lua_tostring(L, -1)));
+        lua_pop(L, 1);
+        return nullptr;
+    }
+
+    lua_pushvalue(L, -2);
+    auto *pState = new (lua_newuserdata(L, sizeof(JobTrampolineState)))
+            JobTrampolineState{trace, ullReportId, pSource, coverage};
+    lua_pushvalue(L, -1);
+    lua_pushcclosure(
+            L,
+            [](lua_State *L) -> int {
+                const auto pState = static_cast<JobTrampolineState *>(lua_touserdata(L, lua_upvalueindex(1)));
+                pState->trace.firstResume = std::chrono::steady_clock::now();
+                Preemption::GetSingleton()->SetJobThread(pState->pSource, L);
+                ExecutionReporter::GetSingleton()->Report(pState->ullReportId,
+                                                          RbxStu::Protocol::ExecutionEventKind::Started);
+                return 0;
+            },
+            nullptr, 1);
+    lua_pushvalue(L, -2);
+    lua_pushcclosure(
+            L,
+            [](lua_State *L) -> int {
+                const auto pState = static_cast<JobTrampolineState *>(lua_touserdata(L, lua_upvalueindex(1)));
+                pState->trace.completed = std::chrono::steady_clock::now();
+                LatencyTracker::GetSingleton()->RecordJob(pState->trace);
+                CollectJobCoverage(L, pState);
+                // Threads the job spawned that are still running lose the budget along with it.
+                Preemption::GetSingleton()->ReleaseJobBudget(L, pState->pSource);
+                ExecutionReporter::GetSingleton()->Report(pState->ullReportId,
+                                                          RbxStu::Protocol::ExecutionEventKind::Completed);
+                return 0;
+            },
+            nullptr, 1);
+    lua_pushvalue(L, -3);
+    lua_pushcclosure(
+            L,
+            [](lua_State *L) -> int {
+                // Called as the error handler of xpcall, whilst the stack that raised the error is still there.
+                const auto pState = static_cast<JobTrampolineState *>(lua_touserdata(L, lua_upvalueindex(1)));
+                // Scripts that fail are collected as well, as the lines up to the error have run.
+                CollectJobCoverage(L, pState);
+                Preemption::GetSingleton()->ReleaseJobBudget(L, pState->pSource);
+                if (pState->ullReportId != 0)
+                    ExecutionReporter::GetSingleton()->Report(
+                            pState->ullReportId, RbxStu::Protocol::ExecutionEventKind::Error, GetErrorTraceback(L));
+
+                lua_settop(L, 1);
+                return 1;
+            },
+            nullptr, 1);
+    lua_remove(L, -4);
+    lua_call(L, 4, 1);
+    lua_remove(L, -2);
+    pHost->SetClosureSecurity(lua_toclosure(L, -1), 8);
+    return &pState->trace;
 }
 
 void Scheduler::ExecuteSchedulerJob(lua_State *runOn, SchedulerJob *job) {
     const auto logger = Logger::GetSingleton();
-    const auto robloxManager = RobloxManager::GetSingleton();
-    const auto security = Security::GetSingleton();
     if (job->bIsLuaCode) {
-        if (job->luaJob.szluaCode.empty())
+        const auto reporter = ExecutionReporter::GetSingleton();
+        if (job->luaJob.szluaCode.empty()) {
+            reporter->Report(job->luaJob.ullReportId, RbxStu::Protocol::ExecutionEventKind::Completed);
             return;
+        }
 
-        logger->PrintInformation(RbxStu::Scheduler, "Compiling Bytecode...");
-
-        auto opts = Luau::CompileOptions{};
-        opts.debugLevel = 2;
-        opts.optimizationLevel = 2;
-        const char *mutableGlobals[] = {"_G", "_ENV", "shared", nullptr};
-        opts.mutableGlobals = mutableGlobals;
-        const auto bytecode = Luau::compile(job->luaJob.szluaCode, opts);
+        job->luaJob.trace.compileStart = std::chrono::steady_clock::now();
+        // Precompiled bytecode carries no coverage instrumentation, its coverage cannot be collected.
+        const auto bCollectCoverage = !job->luaJob.bIsBytecode && CoverageCollector::IsEnabled();
+        std::string szCompiledBytecode;
+        if (!job->luaJob.bIsBytecode) {
+            RbxStuLog(Debug, RbxStu::Scheduler, "Compiling Bytecode...");
+            auto opts = Luau::CompileOptions{};
+            opts.debugLevel = 2;
+            opts.optimizationLevel = 2;
+            const char *mutableGlobals[] = {"_G", "_ENV", "shared", nullptr};
+            opts.mutableGlobals = mutableGlobals;
+            // Counts the hits of every line, instead of only whether they were hit.
+            if (bCollectCoverage)
+                opts.coverageLevel = 2;
+
+            const RbxStu::TraceSpan span{RbxStu::Scheduler, "Luau::compile"};
+            szCompiledBytecode = Luau::compile(job->luaJob.szluaCode, opts);
+            RbxStuLog(Debug, RbxStu::Scheduler, "Compiled Bytecode!");
+        }
+        job->luaJob.trace.compileEnd = std::chrono::steady_clock::now();
+        if (!job->luaJob.bIsBytecode)
+            RbxStu::RecordCompilation("scheduler", job->luaJob.szluaCode.size(), szCompiledBytecode.size(),
+                                      job->luaJob.trace.compileEnd - job->luaJob.trace.compileStart);
 
-        logger->PrintInformation(RbxStu::Scheduler, "Compiled Bytecode!");
+        // Precompiled bytecode has been validated when it was received, so it is loaded as-is.
+        const auto &bytecode = job->luaJob.bIsBytecode ? job->luaJob.szluaCode : szCompiledBytecode;
 
         // WARNING: This code will have to be run ONLY if you decide to use luaE_newthread, as lua_newthread will
         // execute the callback, which will trigger it and initialize the RobloxExtraSpace correctly.
@@ -57,69 +404,141 @@ void Scheduler::ExecuteSchedulerJob(lua_State *runOn, SchedulerJob *job) {
         auto L = lua_newthread(runOn);
         lua_pop(runOn, 1);
 
-        security->SetThreadSecurity(L, 8);
+        this->m_pHost->SetThreadSecurity(L, 8);
 
-        logger->PrintInformation(RbxStu::Scheduler, "Set Thread identity & capabilities");
+        RbxStuLog(Debug, RbxStu::Scheduler, "Set Thread identity & capabilities");
 
-        if (luau_load(L, "RbxStuV2", bytecode.c_str(), bytecode.size(), 0) != LUA_OK) {
+        // Every job gets its own chunk name, as the chunk source is what the ThreadPool uses to tell scripts apart.
+        const auto szChunkName = std::format("RbxStuV2#{}", ++s_ullExecutedJobs);
+        if (const RbxStu::TraceSpan span{RbxStu::Scheduler, "luau_load"};
+            luau_load(L, szChunkName.c_str(), bytecode.c_str(), bytecode.size(), 0) != LUA_OK) {
             const char *err = lua_tostring(L, -1);
             logger->PrintError(RbxStu::Scheduler, err);
+            reporter->Report(job->luaJob.ullReportId, RbxStu::Protocol::ExecutionEventKind::Error, err);
             lua_pop(L, 1);
             return;
         }
-        logger->PrintWarning(RbxStu::Scheduler,
-                             std::format("Execution Lua State = {:#x}", reinterpret_cast<std::uintptr_t>(L)));
+        reporter->AttachChunk(job->luaJob.ullReportId, szChunkName);
+        reporter->Report(job->luaJob.ullReportId, RbxStu::Protocol::ExecutionEventKind::Compiled);
+        RbxStuLog(Debug, RbxStu::Scheduler, "Execution Lua State = {:#x}", reinterpret_cast<std::uintptr_t>(L));
 
         auto *pClosure = const_cast<Closure *>(static_cast<const Closure *>(lua_topointer(L, -1)));
 
-        security->SetLuaClosureSecurity(pClosure, 8);
+        this->m_pHost->SetClosureSecurity(pClosure, 8);
 
-        if (Communication::GetSingleton()->IsCodeGenerationEnabled()) {
+        if (job->luaJob.budget.has_value())
+            Preemption::GetSingleton()->SetJobBudget(L, pClosure->l.p->source, job->luaJob.budget.value());
+
+        if (this->m_pHost->IsCodeGenerationEnabled() && job->luaJob.bNativeCodeGen) {
             const Luau::CodeGen::CompilationOptions opts{0};
-            logger->PrintInformation(RbxStu::Scheduler,
-                                     "Native Code Generation is enabled! Compiling Luau Bytecode -> Native");
+            RbxStuLog(Debug, RbxStu::Scheduler, "Native Code Generation is enabled! Compiling Luau Bytecode -> Native");
+            const RbxStu::TraceSpan span{RbxStu::Scheduler, "CodeGen::compile"};
             Luau::CodeGen::compile(L, -1, opts);
         }
+        job->luaJob.trace.loaded = std::chrono::steady_clock::now();
+
+        std::optional<CoverageCollector::TrackedChunk> coverage;
+        if (bCollectCoverage)
+            coverage = CoverageCollector::GetSingleton()->Track(L, job->luaJob.szluaCode);
 
-        if (robloxManager->GetRobloxTaskDefer().has_value()) {
-            const auto defer = robloxManager->GetRobloxTaskDefer().value();
-            defer(L);
-        } else if (robloxManager->GetRobloxTaskSpawn().has_value()) {
-            const auto spawn = robloxManager->GetRobloxTaskSpawn().value();
-            spawn(L);
+        const auto pSource = pClosure->l.p->source;
+        if (const auto pTrace = WrapWithJobTrace(this->m_pHost.get(), L, job->luaJob.trace, job->luaJob.ullReportId,
+                                                 coverage);
+            pTrace != nullptr) {
+            pTrace->handedOff = std::chrono::steady_clock::now();
         } else {
+            // Nothing will tell when the job finishes, neither its budget nor its coverage may be kept around.
+            Preemption::GetSingleton()->ReleaseJobBudget(L, pSource);
+            if (coverage.has_value())
+                lua_unref(L, coverage->dwReference);
+
+            coverage.reset();
+            // Nor could its submitter ever hear that it ended, so it is not run at all.
+            if (job->luaJob.ullReportId != 0) {
+                reporter->Report(job->luaJob.ullReportId, RbxStu::Protocol::ExecutionEventKind::Error,
+                                 "The job could not be traced, it has not been run.");
+                return;
+            }
+        }
+
+        if (!this->m_pHost->DeferThread(L)) {
+            // The trampoline will never run, so what it would have released on completion is released here.
+            Preemption::GetSingleton()->ReleaseJobBudget(L, pSource);
+            if (coverage.has_value())
+                lua_unref(L, coverage->dwReference);
+
             logger->PrintError(RbxStu::Scheduler,
                                "Execution attempt failed. There is no function that can run the code through Roblox's "
                                "scheduler! Reason: task.defer and task.spawn were not found on the sigging step.");
+            reporter->Report(job->luaJob.ullReportId, RbxStu::Protocol::ExecutionEventKind::Error,
+                             "There is no function that can run the code through Roblox's scheduler!");
+            // The exception skips the flush at the end of the step.
+            reporter->Flush();
 
             throw std::exception("Cannot run Scheduler job!");
         }
 
         return;
     } else if (job->bIsYieldingJob) {
+        const auto L = job->yieldJob.threadRef.thread;
+        const auto dwThreadRef = job->yieldJob.threadRef.thread_ref;
+        if (job->IsJobTimedOut()) {
+            logger->PrintWarning(RbxStu::Scheduler,
+                                 "A yielded thread has timed out whilst waiting for its operation to complete! "
+                                 "Resuming it with an error.");
+            job->Cancel();
+            this->m_pHost->ResumeThread(L, dwThreadRef, 0, true, "The operation has timed out!");
+            job->ReleaseThreadReference();
+            GetSchedulerMetrics().yieldsInFlight.Add(-1);
+            return;
+        }
+
         if (job->IsJobCompleted()) {
             // If the job is completed, we want to call RBX::ScriptContext::resume using it!
-            // else we want to enqueue it again to check it on the next cycle of the scheduler, as the yielding will
-            // else never end!
+            // else we want to park it again until its operation completes, as the yielding will else never end!
+
+            const auto hCoroutine = job->yieldJob.hCoroutine;
+            auto &promise = hCoroutine.promise();
+            const auto dwOriginalTop = lua_gettop(L);
+
+            const auto latencyTracker = LatencyTracker::GetSingleton();
+            latencyTracker->Record(RbxStu::LatencyStage::YieldOperation, promise.suspendedAt, promise.readyAt);
+            latencyTracker->Record(RbxStu::LatencyStage::YieldResumption, promise.readyAt,
+                                   std::chrono::steady_clock::now());
 
-            if (const auto callback = job->GetCallback(); callback.has_value()) {
-                const auto nargs = callback.value()(job->yieldJob.threadRef.thread);
-                logger->PrintWarning(RbxStu::Scheduler, "Starting resumption!");
-                robloxManager->ResumeScript(&job->yieldJob.threadRef, nargs);
+            promise.state = RbxStu::TaskState::Running;
+            {
+                const RbxStu::TraceSpan span{RbxStu::Scheduler, "ResumeTask"};
+                hCoroutine.resume();
+            }
+
+            if (!hCoroutine.done()) {
+                // The Task has awaited on something else, we must wait for it once more.
+                this->ScheduleJob(*job);
+                return;
+            }
 
-                job->FreeResources();
+            RbxStuLog(Debug, RbxStu::Scheduler, "Starting resumption!");
+            if (promise.exception) {
+                auto szErrorMessage = std::string("Unknown error whilst resuming a yielded thread");
+                try {
+                    std::rethrow_exception(promise.exception);
+                } catch (const std::exception &ex) {
+                    szErrorMessage = ex.what();
+                } catch (...) {
+                }
+
+                lua_settop(L, dwOriginalTop);
+                this->m_pHost->ResumeThread(L, dwThreadRef, 0, true, szErrorMessage.c_str());
             } else {
-                logger->PrintError(RbxStu::Scheduler,
-                                   "Callback has no value despite the job being marked as completed!");
+                this->m_pHost->ResumeThread(L, dwThreadRef, promise.result.value(), false, nullptr);
             }
-        } else {
-            this->m_qSchedulerJobs.emplace(*job);
-            // Due to the nature of this architecture, when we have only one job left, we will just start calling it
-            // again and again Which is truly terrible for performance, and I should refactor to separate the execution
-            // from the resumption, but whats done its done...
 
-            // if (this->m_qSchedulerJobs.size() == 1)
-            //     _mm_pause();
+            job->FreeResources();
+            job->ReleaseThreadReference();
+            GetSchedulerMetrics().yieldsInFlight.Add(-1);
+        } else {
+            this->ScheduleJob(*job);
         }
         return;
     }
@@ -128,29 +547,27 @@ void Scheduler::ExecuteSchedulerJob(lua_State *runOn, SchedulerJob *job) {
     throw std::exception("Valid job not found!");
 };
 
-std::shared_mutex __scheduler_init;
-
 std::optional<lua_State *> Scheduler::GetGlobalExecutorState() const {
-    std::lock_guard g{__scheduler_init};
+    std::shared_lock g{this->m_initMutex};
     return this->m_lsInitialisedWith;
 }
 
 std::optional<lua_State *> Scheduler::GetGlobalRobloxState() const {
-    std::lock_guard g{__scheduler_init};
+    std::shared_lock g{this->m_initMutex};
     return this->m_lsRoblox;
 }
 
-std::shared_mutex __scheduler_lock;
-
 void Scheduler::StepScheduler(lua_State *runner) {
-    std::lock_guard lg{__scheduler_lock};
+    const RbxStu::TraceSpan span{RbxStu::Scheduler, "Heartbeat"};
+    std::lock_guard lg{this->m_stepMutex};
     // Here we will check if the DataModel obtained is correct, as in, our data model is successful!
-    const auto robloxManager = RobloxManager::GetSingleton();
     const auto logger = Logger::GetSingleton();
-    if (const auto dataModel = robloxManager->GetCurrentDataModel(RBX::DataModelType_PlayClient);
-        !dataModel.has_value() || this->m_pClientDataModel != dataModel.value()) {
-        logger->PrintWarning(RbxStu::Scheduler, "The task scheduler's internal state is out of date! Reason: DataModel "
-                                                "pointer is invalid! Executing reinitialization sub-routine!");
+    if (const auto dataModel = this->m_pHost->GetCurrentDataModel();
+        !dataModel.has_value() || this->m_pDataModel != dataModel.value()) {
+        logger->PrintWarning(RbxStu::Scheduler,
+                             std::format("The task scheduler's internal state is out of date! Reason: {} DataModel "
+                                         "pointer is invalid! Executing reinitialization sub-routine!",
+                                         RBX::DataModelTypeToString(this->m_dataModelType)));
         this->ResetScheduler();
         return;
     }
@@ -162,96 +579,63 @@ void Scheduler::StepScheduler(lua_State *runner) {
     //             "environment into segments which are not supposed to have such elevated access! Reason: gt and L are
     //             different!");
     // }
-    auto job = this->DequeueSchedulerJob();
-    this->ExecuteSchedulerJob(runner, &job);
+
+    Preemption::GetSingleton()->OnSchedulerStep(runner->global);
+    this->ExpireParkedJobs();
+    this->SampleMetrics(runner);
+    this->m_jobLanes.Step([this, runner](SchedulerJob &job) {
+        const RbxStu::TraceSpan jobSpan{RbxStu::Scheduler, job.bIsLuaCode ? "ExecuteJob" : "ResumeYieldedJob"};
+        const auto &metrics = GetSchedulerMetrics();
+        (job.bIsLuaCode ? metrics.luauJobsExecuted : metrics.resumptionsExecuted).Increment();
+        this->ExecuteSchedulerJob(runner, &job);
+    });
+
+    const RbxStu::TraceSpan flushSpan{RbxStu::Scheduler, "FlushExecutionEvents"};
+    ExecutionReporter::GetSingleton()->Flush();
 }
 
-void Scheduler::InitializeWith(lua_State *L, lua_State *rL, RBX::DataModel *dataModel) {
-    std::lock_guard g{__scheduler_init};
+void Scheduler::InitializeWith(std::shared_ptr<SchedulerHost> pHost, lua_State *L, lua_State *rL,
+                               void *pDataModel) {
+    std::lock_guard g{this->m_initMutex};
     const auto logger = Logger::GetSingleton();
-    const auto robloxManager = RobloxManager::GetSingleton();
 
-    if (const auto luauManager = LuauManager::GetSingleton();
-        !robloxManager->IsInitialized() || !luauManager->IsInitialized()) {
-        logger->PrintWarning(RbxStu::Scheduler, "LuauManager/RobloxManager is not initialized yet...");
+    if (!pHost->IsReady()) {
+        logger->PrintWarning(RbxStu::Scheduler, "The host of the Scheduler is not ready yet...");
         return;
     }
-    this->m_pClientDataModel = dataModel;
+    this->m_pHost = std::move(pHost);
+    this->m_pDataModel = pDataModel;
     this->m_lsRoblox = rL;
     this->m_lsInitialisedWith = L;
+    this->m_pGlobalState = rL->global;
 
-    logger->PrintInformation(RbxStu::Scheduler,
-                             std::format("Task Scheduler initialized!\nInternal State: \n\t- m_pClientDataModel: "
-                                         "{}\n\t- m_lsRoblox: {}\n\t- m_lsInitialisedWith: {}",
-                                         reinterpret_cast<void *>(this->m_pClientDataModel.value()),
-                                         reinterpret_cast<void *>(this->m_lsRoblox.value()),
-                                         reinterpret_cast<void *>(this->m_lsInitialisedWith.value())));
-
-    const auto security = Security::GetSingleton();
+    RbxStuLog(Information, RbxStu::Scheduler,
+              "Task Scheduler initialized for {}!\nInternal State: \n\t- m_pDataModel: {}\n\t- m_lsRoblox: {}\n\t- "
+              "m_lsInitialisedWith: {}",
+              RBX::DataModelTypeToString(this->m_dataModelType), this->m_pDataModel.value(),
+              reinterpret_cast<void *>(this->m_lsRoblox.value()),
+              reinterpret_cast<void *>(this->m_lsInitialisedWith.value()));
 
-    logger->PrintInformation(RbxStu::Scheduler, "Sandboxing threads to avoid environment modification issues!");
+    RbxStuLog(Debug, RbxStu::Scheduler, "Sandboxing threads to avoid environment modification issues!");
 
     luaL_sandboxthread(rL);
     luaL_sandboxthread(L);
 
-    logger->PrintInformation(RbxStu::Scheduler, "Initializing Environment for the executor thread!");
-
-    const auto envManager = EnvironmentManager::GetSingleton();
-    envManager->PushEnvironment(L);
-
-    logger->PrintInformation(RbxStu::Scheduler, "Elevating!");
+    RbxStuLog(Debug, RbxStu::Scheduler, "Initializing Environment for the executor thread!");
 
-    security->SetThreadSecurity(rL, 8);
-    security->SetThreadSecurity(L, 8);
+    this->m_pHost->PushEnvironment(L);
 
-    logger->PrintInformation(RbxStu::Scheduler, "Initializing Heartbeat signal...");
+    RbxStuLog(Debug, RbxStu::Scheduler, "Elevating!");
 
-    lua_pushcclosure(
-            L,
-            [](lua_State *L) -> int32_t {
-                const auto scheduler = Scheduler::GetSingleton();
-                if (scheduler->IsInitialized())
-                    scheduler->StepScheduler(L);
-                return 0;
-            },
-            nullptr, 0);
-    lua_setglobal(L, "scheduler");
-
-    auto opts = Luau::CompileOptions{};
-    opts.debugLevel = 0;
-    opts.optimizationLevel = 2;
-    const auto bytecode = Luau::compile("game:GetService(\"RunService\").Heartbeat:Connect(scheduler)", opts);
-
-
-    if (luau_load(L, "SchedulerHookInit", bytecode.c_str(), bytecode.size(), 0) != LUA_OK) {
-        const char *err = lua_tostring(L, -1);
-        logger->PrintError(RbxStu::Scheduler, err);
-        lua_pop(L, 1);
-        return;
-    }
+    this->m_pHost->SetThreadSecurity(rL, 8);
+    this->m_pHost->SetThreadSecurity(L, 8);
 
-    security->SetLuaClosureSecurity(lua_toclosure(L, -1), 8);
+    RbxStuLog(Debug, RbxStu::Scheduler, "Installing preemption interrupt...");
+    Preemption::GetSingleton()->InstallInterrupt(rL);
 
-    if (Communication::GetSingleton()->IsCodeGenerationEnabled()) {
-        Luau::CodeGen::CompilationOptions nativeOptions;
-        logger->PrintInformation(RbxStu::Scheduler,
-                                 "Native Code Generation is enabled! Compiling Luau Bytecode -> Native");
-        Luau::CodeGen::compile(L, -1, nativeOptions);
-    }
+    RbxStuLog(Debug, RbxStu::Scheduler, "Initializing Heartbeat signal...");
 
-    if (robloxManager->GetRobloxTaskDefer().has_value()) {
-        const auto defer = robloxManager->GetRobloxTaskDefer().value();
-        defer(L);
-    } else if (robloxManager->GetRobloxTaskSpawn().has_value()) {
-        const auto spawn = robloxManager->GetRobloxTaskSpawn().value();
-        spawn(L);
-    } else {
-        logger->PrintError(RbxStu::Scheduler,
-                           "Execution attempt failed. There is no function that can run the code through Roblox's "
-                           "scheduler! Reason: task.defer and task.spawn were not found on the sigging step.");
-
-        throw std::exception("Cannot run Scheduler job!");
-    }
+    this->m_pHost->ConnectHeartbeat(L);
 
     logger->PrintInformation(RbxStu::Scheduler, "Initialized!");
 
@@ -261,21 +645,73 @@ void Scheduler::InitializeWith(lua_State *L, lua_State *rL, RBX::DataModel *data
 }
 
 void Scheduler::ResetScheduler() {
-    std::lock_guard g{__scheduler_init};
     const auto logger = Logger::GetSingleton();
-    this->m_lsRoblox = {};
-    this->m_lsInitialisedWith = {};
-    this->m_pClientDataModel = {};
+    bool bIsStateAlive;
+    std::optional<lua_State *> rL;
+    std::optional<global_State *> pGlobalState;
+    {
+        std::lock_guard g{this->m_initMutex};
+        // Yielded threads may only be resumed (and their references released) if the lua_State they belong to is
+        // still alive. If it isn't, the registry went away with it.
+        bIsStateAlive = this->m_pDataModel.has_value() && this->m_pHost->IsDataModelAlive(this->m_pDataModel.value());
+
+        rL = this->m_lsRoblox;
+        pGlobalState = this->m_pGlobalState;
+        this->m_lsRoblox = {};
+        this->m_lsInitialisedWith = {};
+        this->m_pDataModel = {};
+        this->m_pGlobalState = {};
+    }
 
-    while (!this->m_qSchedulerJobs.empty()) {
-        // Clear job queue
-        this->m_qSchedulerJobs.pop();
+    if (pGlobalState.has_value())
+        Preemption::GetSingleton()->ReleaseJobBudgets(pGlobalState.value(), bIsStateAlive ? rL.value() : nullptr);
+
+    auto pendingJobs = this->m_jobLanes.Clear();
+    {
+        std::lock_guard lock{this->m_parkedMutex};
+        for (const auto &[ullParkId, job]: this->m_mapParkedJobs)
+            pendingJobs.emplace_back(job);
+
+        this->m_mapParkedJobs.clear();
+        this->m_timerWheel.Clear();
     }
 
-    logger->PrintInformation(RbxStu::Scheduler, "Scheduler reset completed. All fields set to no value.");
+    // Resuming runs Luau code, which may call back into the Scheduler, so the lock must not be held whilst doing so.
+    const auto reporter = ExecutionReporter::GetSingleton();
+    std::size_t ullCancelledJobs = 0;
+    std::size_t ullDroppedJobs = 0;
+    for (auto &job: pendingJobs) {
+        if (job.bIsLuaCode) {
+            // The submitter is waiting on the job, it must hear that it will never run.
+            reporter->Report(job.luaJob.ullReportId, RbxStu::Protocol::ExecutionEventKind::Error,
+                             "The scheduler was reset before the job ran!");
+            ullDroppedJobs++;
+            continue;
+        }
+
+        if (!job.bIsYieldingJob)
+            continue;
+
+        job.Cancel();
+        ullCancelledJobs++;
+        GetSchedulerMetrics().yieldsInFlight.Add(-1);
+        if (bIsStateAlive) {
+            this->m_pHost->ResumeThread(job.yieldJob.threadRef.thread, job.yieldJob.threadRef.thread_ref, 0, true,
+                                        "The operation has been cancelled, the scheduler was reset!");
+            job.ReleaseThreadReference();
+        }
+    }
+
+    // The Scheduler will not step again until it is reinitialized, so the errors are sent right away.
+    reporter->Flush();
+    logger->PrintInformation(RbxStu::Scheduler,
+                             std::format("Scheduler for {} reset completed. All fields set to no value. Cancelled {} "
+                                         "yielded threads and dropped {} queued scripts.",
+                                         RBX::DataModelTypeToString(this->m_dataModelType), ullCancelledJobs,
+                                         ullDroppedJobs));
 }
 
 bool Scheduler::IsInitialized() const {
-    std::lock_guard g{__scheduler_init};
+    std::shared_lock g{this->m_initMutex};
     return this->m_lsInitialisedWith.has_value() && this->m_lsRoblox.has_value();
 }
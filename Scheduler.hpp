@@ -3,65 +3,138 @@
 //
 #pragma once
 #include <Windows.h>
+#include <array>
+#include <chrono>
 #include <future>
 #include <memory>
+#include <optional>
 #include <queue>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
+#include "JobLanes.hpp"
+#include "LatencyTracker.hpp"
 #include "Logger.hpp"
+#include "MetricsRegistry.hpp"
+#include "SchedulerHost.hpp"
+#include "SchedulerManager.hpp"
+#include "Task.hpp"
+#include "TimerWheel.hpp"
 #include "Utilities.hpp"
 #include "lstate.h"
 #include "lua.h"
+#include "lualib.h"
+
+namespace RbxStu {
+    /// @brief Luau code larger than this is considered background work, unless its priority is given explicitly.
+    constexpr std::size_t BackgroundCodeThreshold = 256 * 1024;
+
+    /// @brief Records the compilation of Luau source into bytecode into the metrics of the given origin.
+    /// @param szOrigin What compiled the source, e.g. "scheduler" or "loadstring".
+    void RecordCompilation(const char *szOrigin, std::size_t ullSourceSize, std::size_t ullBytecodeSize,
+                           std::chrono::steady_clock::duration duration);
+} // namespace RbxStu
 
 class SchedulerJob {
 public:
     struct lJob {
+        /// @brief The Luau source code to execute, or its bytecode if bIsBytecode is set.
         std::string szluaCode;
+        /// @brief Whether szluaCode holds precompiled bytecode, which has been validated already, instead of source.
+        bool bIsBytecode;
+        /// @brief Whether the job may be compiled into native code, if native code generation is enabled.
+        bool bNativeCodeGen;
+        /// @brief The timestamps of the job as it goes through the pipeline.
+        RbxStu::JobTrace trace;
+        /// @brief The time the script may run for on every Scheduler step before it is preempted, if it has a budget.
+        std::optional<std::chrono::microseconds> budget;
+        /// @brief The report ID to report what happens to the job through ExecutionReporter, or zero if nobody is
+        /// listening.
+        std::uint64_t ullReportId;
     } luaJob;
     struct yJob {
         RBX::Lua::WeakThreadRef threadRef;
+        /// @brief The suspended coroutine that pushes the results into the lua stack once it is resumed.
+        std::coroutine_handle<RbxStu::Task<int>::promise_type> hCoroutine;
     } yieldJob;
 
     bool bIsLuaCode;
     bool bIsYieldingJob;
+    RbxStu::JobPriority priority;
+    /// @brief The moment the job was last put into the Scheduler's queue.
+    std::chrono::steady_clock::time_point enqueuedAt;
 
     SchedulerJob(const SchedulerJob &job) {
+        this->priority = job.priority;
+        this->enqueuedAt = job.enqueuedAt;
         if (job.bIsLuaCode) {
             this->bIsLuaCode = true;
+            this->bIsYieldingJob = false;
             this->luaJob = {};
             this->luaJob.szluaCode = job.luaJob.szluaCode;
+            this->luaJob.bIsBytecode = job.luaJob.bIsBytecode;
+            this->luaJob.bNativeCodeGen = job.luaJob.bNativeCodeGen;
+            this->luaJob.trace = job.luaJob.trace;
+            this->luaJob.budget = job.luaJob.budget;
+            this->luaJob.ullReportId = job.luaJob.ullReportId;
         } else if (job.bIsYieldingJob) {
             this->bIsLuaCode = false;
             this->bIsYieldingJob = true;
-            this->callbackFuture = job.callbackFuture;
+            this->yieldJob.hCoroutine = job.yieldJob.hCoroutine;
             std::memcpy(&this->yieldJob.threadRef, &job.yieldJob.threadRef, sizeof(RBX::Lua::WeakThreadRef));
         }
     };
 
-    explicit SchedulerJob(const std::string &luaCode) {
+    /// @brief Moves a job, taking over its Luau code without copying it.
+    SchedulerJob(SchedulerJob &&job) noexcept {
+        this->priority = job.priority;
+        this->enqueuedAt = job.enqueuedAt;
+        if (job.bIsLuaCode) {
+            this->bIsLuaCode = true;
+            this->bIsYieldingJob = false;
+            this->luaJob = {};
+            this->luaJob.szluaCode = std::move(job.luaJob.szluaCode);
+            this->luaJob.bIsBytecode = job.luaJob.bIsBytecode;
+            this->luaJob.bNativeCodeGen = job.luaJob.bNativeCodeGen;
+            this->luaJob.trace = job.luaJob.trace;
+            this->luaJob.budget = job.luaJob.budget;
+            this->luaJob.ullReportId = job.luaJob.ullReportId;
+        } else if (job.bIsYieldingJob) {
+            this->bIsLuaCode = false;
+            this->bIsYieldingJob = true;
+            this->yieldJob.hCoroutine = job.yieldJob.hCoroutine;
+            std::memcpy(&this->yieldJob.threadRef, &job.yieldJob.threadRef, sizeof(RBX::Lua::WeakThreadRef));
+        }
+    }
+
+    /// @brief Creates a job that compiles and executes Luau code.
+    /// @param luaCode The Luau source code to execute. Pass it with std::move to avoid copying it.
+    /// @param priority The lane to queue the job into. If not given, it is inferred from the size of the code.
+    explicit SchedulerJob(std::string luaCode, const std::optional<RbxStu::JobPriority> priority = {}) {
         this->bIsLuaCode = true;
         this->bIsYieldingJob = false;
         this->luaJob = {};
-        this->luaJob.szluaCode = luaCode;
+        this->priority = priority.value_or(luaCode.size() > RbxStu::BackgroundCodeThreshold
+                                                   ? RbxStu::JobPriority::Background
+                                                   : RbxStu::JobPriority::Interactive);
+        this->luaJob.szluaCode = std::move(luaCode);
+        this->luaJob.bNativeCodeGen = true;
     }
 
-    /// @brief The callback that is executed once the yield is completed to push the results into the lua stack for
-    /// resumption.
-    std::shared_future<std::function<int(lua_State *)>> *callbackFuture = nullptr;
-    explicit SchedulerJob(
-            lua_State *L,
-            std::function<void(lua_State *L, std::shared_future<std::function<int(lua_State *)>> *callbackToExecute)>
-                    function) {
-        const auto logger = Logger::GetSingleton();
+    /// @brief Creates a yielding job, which takes ownership of a suspended Task.
+    /// @param L The lua_State that has yielded.
+    /// @param task The Task, suspended on a co_await, that will be resumed by the Scheduler once it is ready.
+    explicit SchedulerJob(lua_State *L, RbxStu::Task<int> task) {
         this->bIsLuaCode = false;
         this->bIsYieldingJob = true;
-        this->callbackFuture = new std::shared_future<std::function<int(lua_State *)>>();
+        this->priority = RbxStu::JobPriority::Resumption;
+        this->yieldJob.hCoroutine = task.Release();
         this->yieldJob.threadRef.thread = L;
         lua_pushthread(L);
         this->yieldJob.threadRef.thread_ref = lua_ref(L, -1);
         lua_pop(L, 1); // Reset stack
-        logger->PrintInformation(RbxStu::Scheduler, "Launching callback for later resumption");
-        std::thread(function, L, this->callbackFuture).detach();
+        RbxStuLog(Debug, RbxStu::Scheduler, "Task suspended, awaiting for later resumption");
     }
 
     ~SchedulerJob() = default;
@@ -70,65 +143,146 @@ public:
         if (this->bIsLuaCode) {
             return true;
         }
-        if (this->bIsYieldingJob && this->callbackFuture) {
-            const auto logger = Logger::GetSingleton();
-            if (!this->callbackFuture->valid()) {
-                return false;
-            }
-
-            const auto ret = this->callbackFuture->wait_for(std::chrono::milliseconds(10));
-            return (ret == std::future_status::ready || ret == std::future_status::deferred);
+        if (this->bIsYieldingJob && this->yieldJob.hCoroutine) {
+            return this->yieldJob.hCoroutine.promise().state == RbxStu::TaskState::Ready;
         }
 
         return false;
     }
 
-    std::optional<std::function<int(lua_State *)>> GetCallback() const {
+    /// @brief Obtains the cost of executing the job, in scheduler credits.
+    /// @remarks Compiling dominates the cost of executing Luau code, so it scales with the size of the source.
+    std::uint32_t GetCost() const {
         if (this->bIsLuaCode)
-            return {};
+            return 1 + static_cast<std::uint32_t>(this->luaJob.szluaCode.size() / (64 * 1024));
 
-        Logger::GetSingleton()->PrintInformation(RbxStu::Scheduler, "polling callback");
+        return 1;
+    }
 
-        if (this->callbackFuture && this->callbackFuture->valid()) {
-            const auto ret = this->callbackFuture->wait_for(
-                    std::chrono::milliseconds(10)); // Lazily compute value requires us to do this lmao.
+    /// @brief Obtains whether the job may not be executed yet, as its Task is waiting on an operation that has neither
+    /// completed nor timed out.
+    bool IsWaiting() const { return this->bIsYieldingJob && !this->IsJobCompleted() && !this->IsJobTimedOut(); }
 
-            if (this->bIsYieldingJob && ret == std::future_status::ready || ret == std::future_status::deferred)
-                return this->callbackFuture->get();
-        }
+    /// @brief Obtains whether the job's Task is still waiting on an operation whose deadline has passed.
+    bool IsJobTimedOut() const {
+        if (!this->bIsYieldingJob || !this->yieldJob.hCoroutine)
+            return false;
 
-        return {};
+        // Reaching the deadline is what a Task waiting on nothing else waits for, it cannot time out.
+        const auto &promise = this->yieldJob.hCoroutine.promise();
+        const auto state = promise.state.load();
+        return !promise.bWakeOnDeadline &&
+               (state == RbxStu::TaskState::Waiting || state == RbxStu::TaskState::Parked) &&
+               std::chrono::steady_clock::now() > promise.deadline;
     }
 
     void FreeResources() {
-        delete this->callbackFuture;
-        this->callbackFuture = nullptr;
+        if (this->yieldJob.hCoroutine)
+            this->yieldJob.hCoroutine.destroy();
+
+        this->yieldJob.hCoroutine = nullptr;
+    }
+
+    /// @brief Gives up on the job's Task. If its operation is still in flight, the worker running it is left in charge
+    /// of destroying the coroutine frame, else the frame is destroyed right away.
+    /// @remarks Must be called from the thread that owns the Scheduler.
+    void Cancel() {
+        if (!this->bIsYieldingJob || !this->yieldJob.hCoroutine)
+            return;
+
+        // Nothing but the Scheduler holds on to a Task waiting on its deadline alone, so it may be destroyed right
+        // away.
+        auto &promise = this->yieldJob.hCoroutine.promise();
+        if (promise.bWakeOnDeadline || !promise.Abandon())
+            this->yieldJob.hCoroutine.destroy();
+
+        this->yieldJob.hCoroutine = nullptr;
+    }
+
+    /// @brief Releases the registry reference that keeps the yielded thread alive.
+    /// @remarks The lua_State the thread belongs to must still be alive.
+    void ReleaseThreadReference() {
+        if (!this->bIsYieldingJob || this->yieldJob.threadRef.thread_ref == LUA_NOREF)
+            return;
+
+        lua_unref(this->yieldJob.threadRef.thread, this->yieldJob.threadRef.thread_ref);
+        this->yieldJob.threadRef.thread_ref = LUA_NOREF;
     }
 };
 
+/// @brief Executes RbxStu's jobs on the DataModel of a given type. There is one instance per DataModel type, owned by
+/// the SchedulerManager.
 class Scheduler final {
-    /// @brief Private, Static shared pointer into the instance.
-    static std::shared_ptr<Scheduler> pInstance;
-
+    /// @brief The type of the DataModel the Scheduler executes on.
+    RBX::DataModelType m_dataModelType;
+    /// @brief Guards the lua_States and DataModel the Scheduler is initialized with.
+    mutable std::shared_mutex m_initMutex;
+    /// @brief Held whilst the Scheduler is being stepped.
+    std::shared_mutex m_stepMutex;
     /// @brief A std::optional<lua_State *>, which represents a unique, non-array lua_State which RbxStu obtains its
     /// environment from.
     std::optional<lua_State *> m_lsInitialisedWith;
     /// @brief A std::optional<lua_State *>, which represents a unique, non-array lua_State which results from the
     /// ScriptContext's GetGlobalState.
     std::optional<lua_State *> m_lsRoblox;
-    /// @brief A queue of jobs for the Scheduler to work through when stepping. May include more than one job.
-    std::queue<SchedulerJob> m_qSchedulerJobs;
-    /// @brief A std::optional<RBX::DataModel *>, which represents a unique, non-array RBX::DataModel obtained through
-    /// hooking, which the ScriptContext that m_lsRoblox was obtained from is parented/related to.
-    std::optional<RBX::DataModel *> m_pClientDataModel;
+    /// @brief The queues of jobs for the Scheduler to work through when stepping, one per RbxStu::JobPriority.
+    RbxStu::JobLanes<SchedulerJob> m_jobLanes;
+    /// @brief Guards the parked jobs and the timer wheel.
+    std::mutex m_parkedMutex;
+    /// @brief Yielded jobs whose Task is waiting on an operation, keyed by the identifier they were parked with. They
+    /// are moved back into the lanes once their operation completes or their deadline is reached, and never polled.
+    std::unordered_map<std::uint64_t, SchedulerJob> m_mapParkedJobs;
+    /// @brief The deadlines of the parked jobs, holding the identifiers they were parked with.
+    RbxStu::TimerWheel<std::uint64_t> m_timerWheel;
+    /// @brief The identifier given to the last job that was parked.
+    std::uint64_t m_ullLastParkId = 0;
+    /// @brief What the Scheduler uses to interact with the engine it runs on, given when it is initialized.
+    std::shared_ptr<SchedulerHost> m_pHost;
+    /// @brief A std::optional<void *>, which holds the handle m_pHost gave to the DataModel the ScriptContext that
+    /// m_lsRoblox was obtained from is parented/related to.
+    std::optional<void *> m_pDataModel;
+    /// @brief The VM m_lsRoblox belongs to, kept so that it may be told apart even after it is gone.
+    std::optional<global_State *> m_pGlobalState;
+    /// @brief The gauges of the DataModel the Scheduler executes on, sampled on every step.
+    struct {
+        RbxStu::Metrics::Gauge *pHeapSize;
+        RbxStu::Metrics::Gauge *pHeapThreshold;
+        RbxStu::Metrics::Gauge *pCompletedCycles;
+        RbxStu::Metrics::Gauge *pAssistTime;
+        RbxStu::Metrics::Gauge *pExplicitTime;
+        RbxStu::Metrics::Gauge *pLastPauseTime;
+        RbxStu::Metrics::Gauge *pLastMarkTime;
+        RbxStu::Metrics::Gauge *pLastAtomicTime;
+        RbxStu::Metrics::Gauge *pLastSweepTime;
+        RbxStu::Metrics::Gauge *pParkedJobs;
+        std::array<RbxStu::Metrics::Gauge *, 3> aQueuedJobs;
+    } m_metrics;
+
+    /// @brief Parks a yielded job until its Task is Ready or its deadline is reached.
+    /// @remarks Thread-safe.
+    void ParkJob(SchedulerJob job);
 
-    /// @brief Internal function used to dequeue a job from the job queue.
-    SchedulerJob DequeueSchedulerJob();
+    /// @brief Moves a parked job back into its lane, as the operation it was waiting on has completed.
+    /// @param ullParkId The identifier the job was parked with. If the job is no longer parked, nothing is done.
+    /// @remarks Thread-safe. Invoked by the worker thread that completed the operation.
+    void WakeJob(std::uint64_t ullParkId);
+
+    /// @brief Moves every parked job whose deadline has been reached back into its lane. Jobs that were waiting on
+    /// their deadline alone are made Ready, the rest will be resumed with a timeout error.
+    void ExpireParkedJobs();
+
+    /// @brief Samples the garbage collector of the VM L belongs to and the depth of the queues into the gauges of the
+    /// Scheduler.
+    /// @remarks The VM may only be read from the thread that runs it, so this must be called whilst stepping.
+    void SampleMetrics(lua_State *L);
 
 public:
-    /// @brief Obtains the shared pointer that points to the global singleton for the current class.
-    /// @return Singleton for Scheduler as a std::shared_ptr<Scheduler>.
-    static std::shared_ptr<Scheduler> GetSingleton();
+    /// @brief Creates a Scheduler for DataModels of the given type.
+    /// @remarks Obtain the Scheduler of a DataModel through the SchedulerManager instead of creating new ones.
+    explicit Scheduler(RBX::DataModelType dataModelType);
+
+    /// @brief Obtains the type of the DataModel the Scheduler executes on.
+    [[nodiscard]] RBX::DataModelType GetDataModelType() const;
 
     /// @brief Executes a scheduler job on demand.
     /// @param runOn The lua state to execute the scheduler job into
@@ -136,26 +290,32 @@ public:
     /// @remarks This is an exposed internal function. Calling it may result in undefined behaviour.
     void ExecuteSchedulerJob(lua_State *runOn, SchedulerJob *job);
 
-    /// @brief Schedules a job into the Scheduler given its Luau source code.
+    /// @brief Schedules a job into the Scheduler, on the lane matching its priority. Yielded jobs that are still
+    /// waiting on their Task are parked instead.
     /// @param job An instance of a job to enqueue on the scheduler for execution.
+    /// @remarks Thread-safe.
     void ScheduleJob(SchedulerJob job);
 
-    /// @brief Initializes the Scheduler with the given RbxStu lua_State, global Roblox lua_State and RBX::DataModel
-    /// pointer.
+    /// @brief Initializes the Scheduler with the given host, RbxStu lua_State, global Roblox lua_State and DataModel.
+    /// @param pHost What the Scheduler uses to interact with the engine it runs on from now on.
     /// @param L The RbxStu lua_State.
     /// @param rL The global Roblox lua_State
-    /// @param dataModel A pointer to the RBX::DataModel that rL's ScriptContext originates from.
+    /// @param pDataModel The handle pHost gives to the DataModel that rL's ScriptContext originates from.
     /// @remarks This function may result in undefined behaviour if any of the pointers is nullptr.
-    void InitializeWith(lua_State *L, lua_State *rL, RBX::DataModel *dataModel);
+    void InitializeWith(std::shared_ptr<SchedulerHost> pHost, lua_State *L, lua_State *rL, void *pDataModel);
 
     /// @brief Obtains whether the instance is initialized to completion.
     /// @return True if the scheduler has its L, rL and DataModel with populated, valid values.
     [[nodiscard]] bool IsInitialized() const;
 
     /// @brief Used to reset the scheduler if it is deemed unfit for execution.
-    /// @remarks Reserved for internal API use. Do not call unless explicitly required.
+    /// @remarks Reserved for internal API use. Do not call unless explicitly required. Only this Scheduler is reset,
+    /// the Schedulers of other DataModels are left untouched.
     void ResetScheduler();
 
+    /// @brief Used to obtain what the Scheduler uses to interact with the engine it runs on.
+    [[nodiscard]] std::shared_ptr<SchedulerHost> GetHost() const;
+
     /// @brief Used to obtain the RbxStu lua_State the Scheduler was initialized with.
     /// @return A std::optional<lua_State *> which may or may not have a value.
     std::optional<lua_State *> GetGlobalExecutorState() const;
@@ -169,3 +329,24 @@ public:
     /// RESULT IN UNDEFINED BEHAVIOUR!
     void StepScheduler(lua_State *runner);
 };
+
+namespace RbxStu {
+    /// @brief Adapts a function returning a Task into a lua_CFunction. If the Task suspends, the calling thread yields
+    /// and the Scheduler resumes both the Task and the thread once the awaited operation completes.
+    template<RbxStu::Task<int> (*function)(lua_State *)>
+    int YieldingCFunction(lua_State *L) {
+        // Resolved before the Task runs: once it suspends, its frame may already be in the hands of a worker, and
+        // raising an error afterwards would destroy the frame from under it.
+        const auto scheduler = SchedulerManager::GetSingleton()->GetSchedulerForState(L);
+        if (!scheduler.has_value())
+            luaL_error(L, "Cannot yield, the thread does not belong to any DataModel RbxStu executes on!");
+
+        auto task = function(L);
+        if (task.IsCompleted())
+            return task.GetResult();
+
+        scheduler.value()->ScheduleJob(SchedulerJob(L, std::move(task)));
+        L->ci->flags |= 1;
+        return lua_yield(L, 0);
+    }
+} // namespace RbxStu
@@ -0,0 +1,118 @@
+#include "SchedulerHost.hpp"
+
+#include "Communication.hpp"
+#include "Environment/EnvironmentManager.hpp"
+#include "Logger.hpp"
+#include "Luau/CodeGen/include/Luau/CodeGen.h"
+#include "Luau/Compiler.h"
+#include "LuauManager.hpp"
+#include "RobloxManager.hpp"
+#include "Scheduler.hpp"
+#include "SchedulerManager.hpp"
+#include "Security.hpp"
+#include "Utilities.hpp"
+
+RobloxSchedulerHost::RobloxSchedulerHost(const RBX::DataModelType dataModelType) {
+    this->m_dataModelType = dataModelType;
+}
+
+bool RobloxSchedulerHost::IsReady() {
+    return RobloxManager::GetSingleton()->IsInitialized() && LuauManager::GetSingleton()->IsInitialized();
+}
+
+std::optional<void *> RobloxSchedulerHost::GetCurrentDataModel() {
+    if (const auto dataModel = RobloxManager::GetSingleton()->GetCurrentDataModel(this->m_dataModelType);
+        dataModel.has_value())
+        return dataModel.value();
+
+    return {};
+}
+
+bool RobloxSchedulerHost::IsDataModelAlive(void *pDataModel) {
+    const auto dataModel = static_cast<RBX::DataModel *>(pDataModel);
+    return Utilities::IsPointerValid(dataModel) && !dataModel->m_bIsClosed;
+}
+
+void RobloxSchedulerHost::PushEnvironment(lua_State *L) { EnvironmentManager::GetSingleton()->PushEnvironment(L); }
+
+void RobloxSchedulerHost::ConnectHeartbeat(lua_State *L) {
+    const auto logger = Logger::GetSingleton();
+
+    // Every DataModel has its own Heartbeat, which steps only the Scheduler of its DataModel type.
+    lua_pushinteger(L, this->m_dataModelType);
+    lua_pushcclosure(
+            L,
+            [](lua_State *L) -> int32_t {
+                const auto dataModelType = static_cast<RBX::DataModelType>(lua_tointeger(L, lua_upvalueindex(1)));
+                if (const auto scheduler = SchedulerManager::GetSingleton()->GetScheduler(dataModelType);
+                    scheduler.has_value() && scheduler.value()->IsInitialized())
+                    scheduler.value()->StepScheduler(L);
+                return 0;
+            },
+            nullptr, 1);
+    lua_setglobal(L, "scheduler");
+
+    auto opts = Luau::CompileOptions{};
+    opts.debugLevel = 0;
+    opts.optimizationLevel = 2;
+    const auto bytecode = Luau::compile("game:GetService(\"RunService\").Heartbeat:Connect(scheduler)", opts);
+
+
+    if (luau_load(L, "SchedulerHookInit", bytecode.c_str(), bytecode.size(), 0) != LUA_OK) {
+        const char *err = lua_tostring(L, -1);
+        logger->PrintError(RbxStu::Scheduler, err);
+        lua_pop(L, 1);
+        return;
+    }
+
+    this->SetClosureSecurity(lua_toclosure(L, -1), 8);
+
+    if (this->IsCodeGenerationEnabled()) {
+        Luau::CodeGen::CompilationOptions nativeOptions;
+        logger->PrintInformation(RbxStu::Scheduler,
+                                 "Native Code Generation is enabled! Compiling Luau Bytecode -> Native");
+        Luau::CodeGen::compile(L, -1, nativeOptions);
+    }
+
+    if (!this->DeferThread(L)) {
+        logger->PrintError(RbxStu::Scheduler,
+                           "Execution attempt failed. There is no function that can run the code through Roblox's "
+                           "scheduler! Reason: task.defer and task.spawn were not found on the sigging step.");
+
+        throw std::exception("Cannot run Scheduler job!");
+    }
+}
+
+bool RobloxSchedulerHost::DeferThread(lua_State *L) {
+    const auto robloxManager = RobloxManager::GetSingleton();
+    if (const auto defer = robloxManager->GetRobloxTaskDefer(); defer.has_value()) {
+        defer.value()(L);
+        return true;
+    }
+
+    if (const auto spawn = robloxManager->GetRobloxTaskSpawn(); spawn.has_value()) {
+        spawn.value()(L);
+        return true;
+    }
+
+    return false;
+}
+
+void RobloxSchedulerHost::ResumeThread(lua_State *L, const int dwThreadRef, const std::int32_t nret,
+                                       const bool isError, const char *szErrorMessage) {
+    // Roblox only reads the reference whilst resuming, it needs not outlive the call.
+    RBX::Lua::WeakThreadRef threadRef{};
+    threadRef.thread = L;
+    threadRef.thread_ref = dwThreadRef;
+    RobloxManager::GetSingleton()->ResumeScript(&threadRef, nret, isError, szErrorMessage);
+}
+
+void RobloxSchedulerHost::SetThreadSecurity(lua_State *L, const int identity) {
+    Security::GetSingleton()->SetThreadSecurity(L, identity);
+}
+
+void RobloxSchedulerHost::SetClosureSecurity(Closure *closure, const int identity) {
+    Security::GetSingleton()->SetLuaClosureSecurity(closure, identity);
+}
+
+bool RobloxSchedulerHost::IsCodeGenerationEnabled() { return Communication::GetSingleton()->IsCodeGenerationEnabled(); }
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+
+#include "Roblox/TypeDefinitions.hpp"
+#include "lobject.h"
+#include "lua.h"
+
+/// @brief Everything the Scheduler needs from the engine it runs on. Keeping it behind this abstraction keeps the
+/// Scheduler itself free of Roblox specifics, so it may be driven by a stand-in implementation, such as the headless
+/// one of Tools/SchedulerBenchmark.
+/// @remarks The DataModel is opaque to the Scheduler, it only ever compares the handles its host gives it.
+class SchedulerHost {
+public:
+    virtual ~SchedulerHost() = default;
+
+    /// @brief Obtains whether the engine is ready for the Scheduler to be initialized on it.
+    virtual bool IsReady() = 0;
+
+    /// @brief Obtains a handle to the DataModel the Scheduler should be executing on, if there is any.
+    virtual std::optional<void *> GetCurrentDataModel() = 0;
+
+    /// @brief Obtains whether the given DataModel, and with it the lua_State it runs scripts on, is still alive.
+    /// @param pDataModel A handle obtained through GetCurrentDataModel.
+    virtual bool IsDataModelAlive(void *pDataModel) = 0;
+
+    /// @brief Pushes the environment of the executor into the given thread.
+    virtual void PushEnvironment(lua_State *L) = 0;
+
+    /// @brief Arranges for the Scheduler to be stepped on every frame of the engine.
+    /// @param L The RbxStu lua_State the Scheduler is being initialized with.
+    virtual void ConnectHeartbeat(lua_State *L) = 0;
+
+    /// @brief Hands the function on top of the stack of L to the engine's scheduler, which will run it on L.
+    /// @return False if the engine offers no way to do so.
+    virtual bool DeferThread(lua_State *L) = 0;
+
+    /// @brief Resumes a yielded thread through the engine's scheduler.
+    /// @param L The thread to resume.
+    /// @param dwThreadRef The registry reference that keeps the thread alive whilst it is yielded.
+    /// @param nret The number of returns after yielding.
+    /// @param isError Whether the thread should be resumed with an error instead of with results.
+    /// @param szErrorMessage The error message to resume the thread with, only used if isError is true.
+    virtual void ResumeThread(lua_State *L, int dwThreadRef, std::int32_t nret, bool isError,
+                              const char *szErrorMessage) = 0;
+
+    /// @brief Elevates the given thread to the given identity.
+    virtual void SetThreadSecurity(lua_State *L, int identity) = 0;
+
+    /// @brief Elevates the given Luau closure to the given identity.
+    virtual void SetClosureSecurity(Closure *closure, int identity) = 0;
+
+    /// @brief Obtains whether loaded code should be compiled into native code.
+    virtual bool IsCodeGenerationEnabled() = 0;
+};
+
+/// @brief The SchedulerHost used inside of Roblox Studio, backed by the RobloxManager and Security singletons.
+class RobloxSchedulerHost final : public SchedulerHost {
+    /// @brief The type of the DataModel the Scheduler this host belongs to executes on.
+    RBX::DataModelType m_dataModelType;
+
+public:
+    explicit RobloxSchedulerHost(RBX::DataModelType dataModelType);
+
+    bool IsReady() override;
+    std::optional<void *> GetCurrentDataModel() override;
+    bool IsDataModelAlive(void *pDataModel) override;
+    void PushEnvironment(lua_State *L) override;
+    void ConnectHeartbeat(lua_State *L) override;
+    bool DeferThread(lua_State *L) override;
+    void ResumeThread(lua_State *L, int dwThreadRef, std::int32_t nret, bool isError,
+                      const char *szErrorMessage) override;
+    void SetThreadSecurity(lua_State *L, int identity) override;
+    void SetClosureSecurity(Closure *closure, int identity) override;
+    bool IsCodeGenerationEnabled() override;
+};
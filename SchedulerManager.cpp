@@ -0,0 +1,51 @@
+#include "SchedulerManager.hpp"
+
+#include "Scheduler.hpp"
+#include "lstate.h"
+
+std::shared_ptr<SchedulerManager> SchedulerManager::pInstance;
+
+SchedulerManager::SchedulerManager() {
+    this->m_aSchedulers[RBX::DataModelType_Edit] = std::make_shared<Scheduler>(RBX::DataModelType_Edit);
+    this->m_aSchedulers[RBX::DataModelType_PlayClient] = std::make_shared<Scheduler>(RBX::DataModelType_PlayClient);
+    this->m_aSchedulers[RBX::DataModelType_PlayServer] = std::make_shared<Scheduler>(RBX::DataModelType_PlayServer);
+}
+
+std::shared_ptr<SchedulerManager> SchedulerManager::GetSingleton() {
+    if (SchedulerManager::pInstance == nullptr)
+        SchedulerManager::pInstance = std::make_shared<SchedulerManager>();
+
+    return SchedulerManager::pInstance;
+}
+
+bool SchedulerManager::IsDataModelTypeSupported(const RBX::DataModelType dataModelType) {
+    return dataModelType == RBX::DataModelType_Edit || dataModelType == RBX::DataModelType_PlayClient ||
+           dataModelType == RBX::DataModelType_PlayServer;
+}
+
+std::optional<RBX::DataModelType> SchedulerManager::ParseTarget(const std::string &szTarget) {
+    if (szTarget == "edit")
+        return RBX::DataModelType_Edit;
+    if (szTarget == "client")
+        return RBX::DataModelType_PlayClient;
+    if (szTarget == "server")
+        return RBX::DataModelType_PlayServer;
+
+    return {};
+}
+
+std::optional<std::shared_ptr<Scheduler>> SchedulerManager::GetScheduler(const RBX::DataModelType dataModelType) const {
+    if (!SchedulerManager::IsDataModelTypeSupported(dataModelType))
+        return {};
+
+    return this->m_aSchedulers[dataModelType];
+}
+
+std::optional<std::shared_ptr<Scheduler>> SchedulerManager::GetSchedulerForState(lua_State *L) const {
+    for (const auto &scheduler: this->m_aSchedulers) {
+        if (const auto rL = scheduler->GetGlobalRobloxState(); rL.has_value() && rL.value()->global == L->global)
+            return scheduler;
+    }
+
+    return {};
+}
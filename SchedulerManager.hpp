@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "Roblox/TypeDefinitions.hpp"
+#include "lua.h"
+
+class Scheduler;
+
+/// @brief Keeps one Scheduler per DataModel RbxStu may execute on, and routes work to the one it belongs to.
+/// @remarks Every Scheduler has its own queues, Heartbeat connection and lifetime, so a Team Test or a server and
+/// client playtest may run scripts on all of its DataModels at once, and reinitializing one of them leaves the rest
+/// untouched.
+class SchedulerManager final {
+    /// @brief Private, Static shared pointer into the instance.
+    static std::shared_ptr<SchedulerManager> pInstance;
+
+    /// @brief The Scheduler of every supported DataModel type, indexed by RBX::DataModelType.
+    std::array<std::shared_ptr<Scheduler>, 3> m_aSchedulers;
+
+public:
+    SchedulerManager();
+
+    /// @brief Obtains the shared pointer that points to the global singleton for the current class.
+    /// @return Singleton for SchedulerManager as a std::shared_ptr<SchedulerManager>.
+    static std::shared_ptr<SchedulerManager> GetSingleton();
+
+    /// @brief Obtains whether RbxStu runs a Scheduler on DataModels of the given type.
+    /// @remarks Only the Edit, PlayClient and PlayServer DataModels are supported.
+    static bool IsDataModelTypeSupported(RBX::DataModelType dataModelType);
+
+    /// @brief Parses the name of an execution target, as used on the "--!target" directive.
+    /// @param szTarget The name of the target, one of "edit", "client" or "server".
+    /// @return The DataModel type the target refers to, if the name is valid.
+    static std::optional<RBX::DataModelType> ParseTarget(const std::string &szTarget);
+
+    /// @brief Obtains the Scheduler that executes on DataModels of the given type.
+    /// @return The Scheduler, or an empty std::optional if the DataModel type is not supported.
+    std::optional<std::shared_ptr<Scheduler>> GetScheduler(RBX::DataModelType dataModelType) const;
+
+    /// @brief Obtains the Scheduler that the given lua_State belongs to, by comparing the global state it shares with
+    /// the lua_States every initialized Scheduler executes on.
+    /// @param L The lua_State to look up. Any thread of the VM is valid.
+    /// @return The Scheduler, or an empty std::optional if the lua_State does not belong to any initialized Scheduler.
+    std::optional<std::shared_ptr<Scheduler>> GetSchedulerForState(lua_State *L) const;
+};
@@ -79,17 +79,19 @@ std::shared_ptr<Security> Security::GetSingleton() {
 }
 
 void Security::PrintCapabilities(int capabilities) {
-    const auto logger = Logger::GetSingleton();
+    if (RbxStu::LogLevel::Debug < RbxStu::MinimumLogLevel ||
+        !Logger::IsEnabled(RbxStu::LogLevel::Debug, RbxStu::Security))
+        return;
 
-    logger->PrintInformation(RbxStu::Security, std::format("0x{:X} got these capabilities:", capabilities));
+    RbxStuLog(Debug, RbxStu::Security, "0x{:X} got these capabilities:", capabilities);
     for (auto capability = allCapabilities.begin(); capability != allCapabilities.end(); ++capability) {
         if (capability->second.second == true) {
             if ((capabilities) & (1 << capability->second.first)) {
-                logger->PrintInformation(RbxStu::Security, capability->first);
+                RbxStuLog(Debug, RbxStu::Security, "{}", capability->first);
             }
         } else {
             if ((capability->second.first & capabilities) == capability->second.first) {
-                logger->PrintInformation(RbxStu::Security, capability->first);
+                RbxStuLog(Debug, RbxStu::Security, "{}", capability->first);
             }
         }
     }
@@ -126,8 +128,7 @@ void Security::SetThreadSecurity(lua_State *L, int identity) {
     auto *plStateUd = static_cast<RBX::Lua::ExtraSpace *>(L->userdata);
     auto capabilities = Security::GetSingleton()->IdentityToCapabilities(identity);
 
-    Logger::GetSingleton()->PrintInformation(RbxStu::Security,
-                                             std::format("Elevating our thread capabilities to: 0x{:X}", capabilities));
+    RbxStuLog(Debug, RbxStu::Security, "Elevating our thread capabilities to: 0x{:X}", capabilities);
 
     plStateUd->identity = identity;
     plStateUd->capabilities = capabilities;
@@ -140,18 +141,6 @@ static void set_proto(Proto *proto, uintptr_t *proto_identity) {
         set_proto(proto->p[i], proto_identity);
 }
 
-bool Security::IsOurThread(lua_State *L) {
-    /// The way we currently have of checking if a thread is our thread is through... capabilities!
-    /// Roblox handles capabilities using an std::int64_t, giving us 64 fun bits to play around with.
-    /// This way, we can set the bit 64th, used to describe NOTHING, to set it as
-    /// our thread. Then we & it to validate it is present on the integer with an AND, which it shouldn't be ever if its
-    /// anything normal, but we aren't normal!
-    const auto extraSpace = static_cast<RBX::Lua::ExtraSpace *>(L->userdata);
-    const auto logger = Logger::GetSingleton();
-    const auto passed = (extraSpace->capabilities & (63 << 1)) == (63 << 1);
-    return passed;
-}
-
 bool Security::SetLuaClosureSecurity(Closure *lClosure, int identity) {
     if (lClosure->isC)
         return false;
@@ -4,6 +4,7 @@
 
 #pragma once
 #include <lapi.h>
+#include <lstate.h>
 #include <list>
 #include <memory>
 
@@ -98,7 +99,17 @@ public:
     /// @remarks This function will only work if SetThreadSecurity(lua_State* L) was called, or if the threads'
     /// capabilities were set appropiately.
     /// @return true if the thread was created by RbxStu, false if it was not.
-    bool IsOurThread(lua_State *L);
+    /// @remarks Defined inline, as it needs nothing but the thread, so that code built without the RobloxManager, such
+    /// as the Profiler in Tools/SchedulerBenchmark, may use it as well.
+    static bool IsOurThread(lua_State *L) {
+        /// The way we currently have of checking if a thread is our thread is through... capabilities!
+        /// Roblox handles capabilities using an std::int64_t, giving us 64 fun bits to play around with.
+        /// This way, we can set the bit 64th, used to describe NOTHING, to set it as
+        /// our thread. Then we & it to validate it is present on the integer with an AND, which it shouldn't be ever if
+        /// its anything normal, but we aren't normal!
+        const auto extraSpace = static_cast<RBX::Lua::ExtraSpace *>(L->userdata);
+        return (extraSpace->capabilities & (63 << 1)) == (63 << 1);
+    }
 
     /// @brief Elevates a lua closure's identity and capability.
     /// @param lClosure The closure to elevate.
@@ -0,0 +1,195 @@
+#include "SharedMemoryEndpoint.hpp"
+
+#include <chrono>
+#include <format>
+#include <thread>
+
+#include "Communication.hpp"
+#include "ExecutionReporter.hpp"
+#include "Logger.hpp"
+
+std::shared_ptr<SharedMemoryEndpoint> SharedMemoryEndpoint::pInstance;
+
+/// @brief The channel to the client of a session of the shared memory region.
+class SharedMemoryReplyChannel final : public RbxStu::ReplyChannel {
+    std::uint32_t m_dwSession;
+
+public:
+    explicit SharedMemoryReplyChannel(const std::uint32_t dwSession) : m_dwSession(dwSession) {}
+
+    bool Send(std::string szMessage) override {
+        return SharedMemoryEndpoint::GetSingleton()->SendReply(this->m_dwSession, szMessage);
+    }
+
+    [[nodiscard]] bool IsOpen() const override {
+        return SharedMemoryEndpoint::GetSingleton()->IsSessionOpen(this->m_dwSession);
+    }
+};
+
+/// @brief Obtains whether the process with the given ID is still running.
+static bool IsProcessRunning(const DWORD dwProcessId) {
+    const auto hProcess = OpenProcess(SYNCHRONIZE, FALSE, dwProcessId);
+    if (hProcess == nullptr)
+        return GetLastError() == ERROR_ACCESS_DENIED;
+
+    const auto bIsRunning = WaitForSingleObject(hProcess, 0) == WAIT_TIMEOUT;
+    CloseHandle(hProcess);
+    return bIsRunning;
+}
+
+std::shared_ptr<SharedMemoryEndpoint> SharedMemoryEndpoint::GetSingleton() {
+    if (SharedMemoryEndpoint::pInstance == nullptr)
+        SharedMemoryEndpoint::pInstance = std::make_shared<SharedMemoryEndpoint>();
+
+    return SharedMemoryEndpoint::pInstance;
+}
+
+void SharedMemoryEndpoint::ReleaseClient() {
+    std::lock_guard lock{this->m_replyMutex};
+    const auto pHeader = this->m_rings.pHeader;
+    this->m_rings.requests.Reset();
+    this->m_rings.replies.Reset();
+    pHeader->dwClientDetaching.store(0, std::memory_order_relaxed);
+    pHeader->dwSession.fetch_add(1, std::memory_order_relaxed);
+    this->m_bIsClientFailed.store(false, std::memory_order_relaxed);
+    // Publishes the reset rings, the next client may claim the region as soon as it sees it free.
+    pHeader->dwClientProcessId.store(0, std::memory_order_release);
+}
+
+void SharedMemoryEndpoint::Serve() {
+    const auto logger = Logger::GetSingleton();
+    const auto pHeader = this->m_rings.pHeader;
+    auto &requests = this->m_rings.requests;
+    RbxStu::Protocol::MessageReader reader;
+    std::shared_ptr<RbxStu::ReplyChannel> pChannel;
+    std::string szClient = "shared memory client";
+    bool bShouldCheckClient = false;
+
+    while (true) {
+        const auto dwClientProcessId = pHeader->dwClientProcessId.load(std::memory_order_acquire);
+        if (dwClientProcessId != 0 && pChannel == nullptr) {
+            pChannel = std::make_shared<SharedMemoryReplyChannel>(pHeader->dwSession.load());
+            szClient = std::format("shared memory client (process {})", dwClientProcessId);
+            logger->PrintInformation(RbxStu::SharedMemoryEndpoint, std::format("The {} has attached!", szClient));
+        }
+
+        // The requests of a client whose stream is broken are no longer read, it is only waited on to detach.
+        const auto bIsClientFailed = this->m_bIsClientFailed.load(std::memory_order_relaxed);
+        const auto [pBuffer, ullSize] = reader.GetBuffer();
+        if (const auto ullRead = bIsClientFailed ? 0 : requests.Read(pBuffer, ullSize); ullRead != 0) {
+            switch (reader.OnRead(ullRead)) {
+                case RbxStu::Protocol::ReadStatus::Success:
+                    Communication::SubmitMessage(reader.GetReceivedMessage(), szClient,
+                                                 std::chrono::steady_clock::now(), pChannel);
+                    break;
+                case RbxStu::Protocol::ReadStatus::Malformed:
+                    logger->PrintError(RbxStu::SharedMemoryEndpoint,
+                                       std::format("The {} sent a malformed message header! Ignoring it until it "
+                                                   "detaches, as the stream cannot be resynchronized.",
+                                                   szClient));
+                    this->m_bIsClientFailed.store(true, std::memory_order_relaxed);
+                    reader.Reset();
+                    break;
+                default:
+                    break;
+            }
+
+            continue;
+        }
+
+        // The client is only let go of once every request it wrote has been read, or its stream is broken.
+        if (dwClientProcessId != 0 && (pHeader->dwClientDetaching.load(std::memory_order_acquire) != 0 ||
+                                       (bShouldCheckClient && !IsProcessRunning(dwClientProcessId)))) {
+            logger->PrintInformation(RbxStu::SharedMemoryEndpoint, std::format("The {} has detached.", szClient));
+            this->ReleaseClient();
+            reader.Reset();
+            pChannel = nullptr;
+            bShouldCheckClient = false;
+            continue;
+        }
+
+        bShouldCheckClient = false;
+        if (bIsClientFailed) {
+            // Whatever the client writes is never read, so the doorbell cannot tell when it detaches.
+            Sleep(SharedMemoryEndpoint::ClientCheckInterval);
+            bShouldCheckClient = true;
+        } else if (requests.PrepareWait()) {
+            bShouldCheckClient =
+                    WaitForSingleObject(this->m_hRequestDoorbell, SharedMemoryEndpoint::ClientCheckInterval) ==
+                    WAIT_TIMEOUT;
+            requests.EndWait();
+        }
+    }
+}
+
+bool SharedMemoryEndpoint::Start(const std::string &szName) {
+    const auto logger = Logger::GetSingleton();
+    if (this->m_hMapping != nullptr) {
+        logger->PrintWarning(RbxStu::SharedMemoryEndpoint, "The shared memory endpoint is running already!");
+        return false;
+    }
+
+    const auto szMappingName = std::format(R"(Local\RbxStu.{})", szName);
+    constexpr auto ullSize = RbxStu::Protocol::GetSharedMemorySize(SharedMemoryEndpoint::RingSize);
+    const auto hMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                             static_cast<DWORD>(static_cast<std::uint64_t>(ullSize) >> 32),
+                                             static_cast<DWORD>(ullSize), szMappingName.c_str());
+    if (hMapping == nullptr || GetLastError() == ERROR_ALREADY_EXISTS) {
+        // Should another process own the name we must not serve it, as with the pipe.
+        logger->PrintError(RbxStu::SharedMemoryEndpoint,
+                           std::format("Failed to create the shared memory region '{}'! Error: {}", szMappingName,
+                                       GetLastError()));
+        if (hMapping != nullptr)
+            CloseHandle(hMapping);
+
+        return false;
+    }
+
+    const auto pView = MapViewOfFile(hMapping, FILE_MAP_ALL_ACCESS, 0, 0, ullSize);
+    const auto hRequestDoorbell = CreateEventA(nullptr, FALSE, FALSE, (szMappingName + ".Requests").c_str());
+    const auto hReplyDoorbell = CreateEventA(nullptr, FALSE, FALSE, (szMappingName + ".Replies").c_str());
+    if (pView == nullptr || hRequestDoorbell == nullptr || hReplyDoorbell == nullptr) {
+        logger->PrintError(RbxStu::SharedMemoryEndpoint,
+                           std::format("Failed to set up the shared memory region '{}'! Error: {}", szMappingName,
+                                       GetLastError()));
+        if (pView != nullptr)
+            UnmapViewOfFile(pView);
+        if (hRequestDoorbell != nullptr)
+            CloseHandle(hRequestDoorbell);
+        if (hReplyDoorbell != nullptr)
+            CloseHandle(hReplyDoorbell);
+
+        CloseHandle(hMapping);
+        return false;
+    }
+
+    this->m_rings = RbxStu::Protocol::InitializeSharedMemory(pView, SharedMemoryEndpoint::RingSize);
+    this->m_hRequestDoorbell = hRequestDoorbell;
+    this->m_hReplyDoorbell = hReplyDoorbell;
+    this->m_hMapping = hMapping;
+
+    std::thread([this] { this->Serve(); }).detach();
+    logger->PrintInformation(RbxStu::SharedMemoryEndpoint,
+                             std::format("Serving the shared memory region '{}' with {} KiB rings.", szMappingName,
+                                         SharedMemoryEndpoint::RingSize / 1024));
+    return true;
+}
+
+bool SharedMemoryEndpoint::SendReply(const std::uint32_t dwSession, const std::string_view szMessage) {
+    std::lock_guard lock{this->m_replyMutex};
+    if (!this->IsSessionOpen(dwSession) || this->m_rings.replies.GetFreeSpace() < szMessage.size())
+        return false;
+
+    this->m_rings.replies.Write(szMessage);
+    if (this->m_rings.replies.IsConsumerWaiting())
+        SetEvent(this->m_hReplyDoorbell);
+
+    return true;
+}
+
+bool SharedMemoryEndpoint::IsSessionOpen(const std::uint32_t dwSession) const {
+    const auto pHeader = this->m_rings.pHeader;
+    return !this->m_bIsClientFailed.load(std::memory_order_relaxed) &&
+           pHeader->dwSession.load(std::memory_order_relaxed) == dwSession &&
+           pHeader->dwClientProcessId.load(std::memory_order_relaxed) != 0;
+}
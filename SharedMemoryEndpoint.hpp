@@ -0,0 +1,65 @@
+#pragma once
+#include <Windows.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "SharedMemoryRing.hpp"
+
+/// @brief Serves a single client at a time through a shared memory region, for tools that submit requests faster than
+/// the pipe can take them, such as automated test runs.
+/// @remarks The region, named "Local\RbxStu.<name>", holds a request ring and a reply ring, see SharedMemoryHeader,
+/// which carry the same messages as the pipe. Each ring has a doorbell, an auto-reset event named after the region
+/// with a ".Requests" or ".Replies" suffix, which is only set when its consumer is waiting on it, so that neither side
+/// makes a system call per message whilst the other is busy.
+class SharedMemoryEndpoint final {
+    /// @brief Private, Static shared pointer into the instance.
+    static std::shared_ptr<SharedMemoryEndpoint> pInstance;
+
+    /// @brief The size of each ring.
+    static constexpr std::uint32_t RingSize = 1024 * 1024;
+    /// @brief How often the client is checked for having exited whilst it sends nothing, in milliseconds.
+    static constexpr DWORD ClientCheckInterval = 500;
+
+    HANDLE m_hMapping = nullptr;
+    HANDLE m_hRequestDoorbell = nullptr;
+    HANDLE m_hReplyDoorbell = nullptr;
+    RbxStu::Protocol::SharedMemoryRings m_rings{};
+
+    /// @brief Guards writing into the reply ring and releasing the region, as replies are sent from several threads
+    /// whilst the ring only has room for a single producer.
+    std::mutex m_replyMutex;
+    /// @brief Set once the current client has sent a malformed message. Its session is closed, but the region is only
+    /// released once the client detaches, as the rings may not be reset whilst it may still be writing into them.
+    std::atomic_bool m_bIsClientFailed{false};
+
+    /// @brief Reads the requests of the clients until RbxStu exits.
+    void Serve();
+
+    /// @brief Forgets the current client, resetting the rings for the next one.
+    /// @remarks The client must have detached or exited, as it may not be using the rings whilst they are reset.
+    void ReleaseClient();
+
+public:
+    /// @brief Obtains the shared pointer that points to the global singleton for the current class.
+    /// @return Singleton for SharedMemoryEndpoint as a std::shared_ptr<SharedMemoryEndpoint>.
+    static std::shared_ptr<SharedMemoryEndpoint> GetSingleton();
+
+    /// @brief Creates the shared memory region and its doorbells, and begins serving clients through them.
+    /// @param szName The name of the region, without the "Local\RbxStu." prefix.
+    /// @return True if the region is being served, false if it could not be created, is owned by another process or
+    /// is being served already.
+    bool Start(const std::string &szName);
+
+    /// @brief Writes a reply to the client of the given session, without blocking.
+    /// @param dwSession The session the reply is meant for.
+    /// @param szMessage The message, as serialized by SerializeMessage.
+    /// @return False if the session has ended, or the reply ring has no room for the message.
+    bool SendReply(std::uint32_t dwSession, std::string_view szMessage);
+
+    /// @brief Obtains whether the client of the given session is still using the region.
+    [[nodiscard]] bool IsSessionOpen(std::uint32_t dwSession) const;
+};
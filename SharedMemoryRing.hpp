@@ -0,0 +1,187 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <type_traits>
+
+namespace RbxStu::Protocol {
+    /// @brief Marks the start of a shared memory region set up by RbxStu, "RSSM" in little-endian.
+    constexpr std::uint32_t SharedMemoryMagic = 0x4D535352;
+    /// @brief Incremented whenever the layout of the shared memory region changes.
+    constexpr std::uint32_t SharedMemoryVersion = 1;
+
+    static_assert(std::atomic_uint64_t::is_always_lock_free && std::atomic_uint32_t::is_always_lock_free,
+                  "The atomics of the shared memory region are shared across processes, they must be lock-free!");
+
+    /// @brief The control block of a ring, which carries a byte stream from a single producer to a single consumer.
+    /// Positions count every byte ever written and read, the data being at the position modulo the size of the ring.
+    /// @remarks Every field is on its own cache line, so that the producer and the consumer never contend on them.
+    struct SharedRingHeader {
+        /// @brief Written by the producer only, after the bytes before it have been written.
+        alignas(64) std::atomic_uint64_t ullWritePosition;
+        /// @brief Written by the consumer only, after the bytes before it have been read.
+        alignas(64) std::atomic_uint64_t ullReadPosition;
+        /// @brief Set by the consumer whilst it waits on the doorbell of the ring, so that the producer only rings it
+        /// when somebody is waiting for it.
+        alignas(64) std::atomic_uint32_t dwConsumerWaiting;
+    };
+
+    /// @brief The header a shared memory region begins with, followed by the data of the request ring and then by that
+    /// of the reply ring, each being dwRingSize bytes. Every field is little-endian.
+    /// @remarks The request ring carries messages of the pipe protocol from the client to RbxStu, and the reply ring
+    /// carries the messages RbxStu answers with back to it.
+    struct SharedMemoryHeader {
+        /// @brief Must be SharedMemoryMagic.
+        std::uint32_t dwMagic;
+        /// @brief Must be SharedMemoryVersion.
+        std::uint32_t dwVersion;
+        /// @brief The size of each ring, a power of two.
+        std::uint32_t dwRingSize;
+        std::uint32_t dwReserved;
+        /// @brief The process ID of the client using the region, or zero if there is none. Clients claim the region by
+        /// exchanging zero for their process ID, and only RbxStu sets it back to zero, once it has reset the rings.
+        std::atomic_uint32_t dwClientProcessId;
+        /// @brief Set by the client once it is done with the region. RbxStu releases the region once it has read every
+        /// request on it.
+        std::atomic_uint32_t dwClientDetaching;
+        /// @brief Incremented by RbxStu whenever the region is released, so that replies meant for a client never reach
+        /// the next one.
+        std::atomic_uint32_t dwSession;
+        alignas(64) SharedRingHeader requests;
+        alignas(64) SharedRingHeader replies;
+    };
+    static_assert(std::is_standard_layout_v<SharedMemoryHeader>, "SharedMemoryHeader is shared across processes!");
+
+    /// @brief Obtains the size of a shared memory region with rings of the given size.
+    constexpr std::size_t GetSharedMemorySize(const std::uint32_t dwRingSize) {
+        return sizeof(SharedMemoryHeader) + 2 * static_cast<std::size_t>(dwRingSize);
+    }
+
+    /// @brief A view over one side of a ring in a shared memory region. Neither side ever blocks, waiting on the
+    /// doorbell of the ring when there is nothing to do is up to the consumer.
+    class SharedRing final {
+        SharedRingHeader *m_pHeader = nullptr;
+        std::uint8_t *m_pData = nullptr;
+        std::uint32_t m_dwSize = 0;
+
+    public:
+        SharedRing() = default;
+        SharedRing(SharedRingHeader *pHeader, std::uint8_t *pData, const std::uint32_t dwSize)
+            : m_pHeader(pHeader), m_pData(pData), m_dwSize(dwSize) {}
+
+        /// @brief Obtains the amount of bytes that may be written before the consumer reads some.
+        [[nodiscard]] std::size_t GetFreeSpace() const {
+            return this->m_dwSize - (this->m_pHeader->ullWritePosition.load(std::memory_order_relaxed) -
+                                     this->m_pHeader->ullReadPosition.load(std::memory_order_acquire));
+        }
+
+        /// @brief Writes as many bytes as fit into the ring. Producer only.
+        /// @param szBytes The bytes to write.
+        /// @return The amount of bytes written, which may be less than given if the ring is full.
+        std::size_t Write(const std::string_view szBytes) {
+            const auto ullWritePosition = this->m_pHeader->ullWritePosition.load(std::memory_order_relaxed);
+            const auto ullSize = std::min(szBytes.size(), this->GetFreeSpace());
+            const auto ullOffset = static_cast<std::size_t>(ullWritePosition & (this->m_dwSize - 1));
+            const auto ullFirst = std::min(ullSize, this->m_dwSize - ullOffset);
+            std::memcpy(this->m_pData + ullOffset, szBytes.data(), ullFirst);
+            std::memcpy(this->m_pData, szBytes.data() + ullFirst, ullSize - ullFirst);
+            this->m_pHeader->ullWritePosition.store(ullWritePosition + ullSize, std::memory_order_release);
+            return ullSize;
+        }
+
+        /// @brief Reads as many bytes as are available, up to the given amount. Consumer only.
+        /// @param pBuffer The buffer to read into.
+        /// @param ullSize The size of the buffer.
+        /// @return The amount of bytes read, zero if the ring is empty.
+        std::size_t Read(void *pBuffer, const std::size_t ullSize) {
+            const auto ullReadPosition = this->m_pHeader->ullReadPosition.load(std::memory_order_relaxed);
+            const auto ullAvailable = static_cast<std::size_t>(
+                    this->m_pHeader->ullWritePosition.load(std::memory_order_acquire) - ullReadPosition);
+            const auto ullRead = std::min(ullSize, ullAvailable);
+            const auto ullOffset = static_cast<std::size_t>(ullReadPosition & (this->m_dwSize - 1));
+            const auto ullFirst = std::min(ullRead, this->m_dwSize - ullOffset);
+            std::memcpy(pBuffer, this->m_pData + ullOffset, ullFirst);
+            std::memcpy(static_cast<std::uint8_t *>(pBuffer) + ullFirst, this->m_pData, ullRead - ullFirst);
+            this->m_pHeader->ullReadPosition.store(ullReadPosition + ullRead, std::memory_order_release);
+            return ullRead;
+        }
+
+        /// @brief Obtains whether the consumer must be woken after a write, as it is waiting on the doorbell. Producer
+        /// only, to be called after every write.
+        [[nodiscard]] bool IsConsumerWaiting() const {
+            // Pairs with the fence of PrepareWait, either the consumer sees the write or we see it waiting.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return this->m_pHeader->dwConsumerWaiting.load(std::memory_order_relaxed) != 0;
+        }
+
+        /// @brief Announces that the consumer is about to wait on the doorbell. Consumer only.
+        /// @return True if the ring is still empty and the consumer may wait, in which case it must call EndWait once
+        /// it wakes. False if bytes arrived in the meantime, in which case it must not wait.
+        bool PrepareWait() {
+            this->m_pHeader->dwConsumerWaiting.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (this->m_pHeader->ullWritePosition.load(std::memory_order_relaxed) !=
+                this->m_pHeader->ullReadPosition.load(std::memory_order_relaxed)) {
+                this->EndWait();
+                return false;
+            }
+
+            return true;
+        }
+
+        /// @brief Announces that the consumer is no longer waiting on the doorbell. Consumer only.
+        void EndWait() { this->m_pHeader->dwConsumerWaiting.store(0, std::memory_order_relaxed); }
+
+        /// @brief Empties the ring. Only valid whilst neither side is using it.
+        void Reset() {
+            this->m_pHeader->ullWritePosition.store(0, std::memory_order_relaxed);
+            this->m_pHeader->ullReadPosition.store(0, std::memory_order_relaxed);
+            this->m_pHeader->dwConsumerWaiting.store(0, std::memory_order_release);
+        }
+    };
+
+    /// @brief The rings of a shared memory region.
+    struct SharedMemoryRings {
+        SharedMemoryHeader *pHeader;
+        /// @brief Produced by the client, consumed by RbxStu.
+        SharedRing requests;
+        /// @brief Produced by RbxStu, consumed by the client.
+        SharedRing replies;
+    };
+
+    /// @brief Sets up a shared memory region, as RbxStu does once when creating it.
+    /// @param pMemory The region, of GetSharedMemorySize(dwRingSize) bytes and aligned to at least 64 bytes.
+    /// @param dwRingSize The size of each ring, a power of two.
+    inline SharedMemoryRings InitializeSharedMemory(void *pMemory, const std::uint32_t dwRingSize) {
+        const auto pHeader = new (pMemory) SharedMemoryHeader{};
+        pHeader->dwMagic = SharedMemoryMagic;
+        pHeader->dwVersion = SharedMemoryVersion;
+        pHeader->dwRingSize = dwRingSize;
+        const auto pData = static_cast<std::uint8_t *>(pMemory) + sizeof(SharedMemoryHeader);
+        return {pHeader, {&pHeader->requests, pData, dwRingSize}, {&pHeader->replies, pData + dwRingSize, dwRingSize}};
+    }
+
+    /// @brief Obtains the rings of a shared memory region set up by RbxStu, as clients do when opening it.
+    /// @param pMemory The region.
+    /// @param ullSize The size of the region.
+    /// @param rings The rings to store the views into.
+    /// @return False if the region was not set up by a compatible version of RbxStu.
+    inline bool AttachSharedMemory(void *pMemory, const std::size_t ullSize, SharedMemoryRings &rings) {
+        if (ullSize < sizeof(SharedMemoryHeader))
+            return false;
+
+        const auto pHeader = static_cast<SharedMemoryHeader *>(pMemory);
+        const auto dwRingSize = pHeader->dwRingSize;
+        if (pHeader->dwMagic != SharedMemoryMagic || pHeader->dwVersion != SharedMemoryVersion || dwRingSize == 0 ||
+            (dwRingSize & (dwRingSize - 1)) != 0 || ullSize < GetSharedMemorySize(dwRingSize))
+            return false;
+
+        const auto pData = static_cast<std::uint8_t *>(pMemory) + sizeof(SharedMemoryHeader);
+        rings = {pHeader, {&pHeader->requests, pData, dwRingSize}, {&pHeader->replies, pData + dwRingSize, dwRingSize}};
+        return true;
+    }
+} // namespace RbxStu::Protocol
@@ -0,0 +1,307 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "ThreadPool.hpp"
+#include "lstate.h"
+
+namespace RbxStu {
+    /// @brief Obtains the key used to throttle the yielding work of a script on the ThreadPool.
+    /// @param L The lua_State that is going to yield.
+    /// @return The source of the chunk the closest Luau function on the call stack belongs to, or L itself if there is
+    /// no Luau function on it. Every thread created by a single script shares the same chunk source.
+    inline const void *GetYieldOwner(lua_State *L) {
+        for (auto ci = L->ci; ci >= L->base_ci; ci--) {
+            if (ttisfunction(ci->func) && !clvalue(ci->func)->isC)
+                return clvalue(ci->func)->l.p->source;
+        }
+
+        return L;
+    }
+
+    enum class TaskState : std::uint8_t {
+        /// @brief The coroutine is executing on Roblox's thread.
+        Running,
+        /// @brief The coroutine is suspended, waiting for an operation to complete off-thread.
+        Waiting,
+        /// @brief The coroutine is waiting, and the Scheduler has parked it until whoever completes the operation wakes
+        /// it up through its TaskWaker.
+        Parked,
+        /// @brief The awaited operation has completed, the coroutine may be resumed by the Scheduler.
+        Ready,
+        /// @brief The Scheduler has given up on the coroutine whilst it was waiting (timeout, reset or DataModel
+        /// teardown). The worker that observes this state destroys the coroutine frame once it is done with it.
+        Abandoned,
+    };
+
+    /// @brief Used as the timeout of an awaited operation to wait for it for as long as it takes.
+    constexpr auto NoTimeout = std::chrono::milliseconds::zero();
+
+    /// @brief The time an operation awaited through RunOnThreadPool may take before the yielded thread is resumed with
+    /// an error.
+    constexpr auto DefaultYieldTimeout = std::chrono::milliseconds{60000};
+
+    /// @brief Lets whoever completes the operation a Task waits on notify the Scheduler, so that it does not have to
+    /// poll Tasks for completion.
+    /// @remarks Set by the Scheduler before it makes the Task Parked, and never modified whilst it is. As the frame may
+    /// be resumed and destroyed the moment the Task becomes Ready, whoever completes the operation must copy the waker
+    /// out of it beforehand.
+    struct TaskWaker {
+        void (*pfnWake)(void *pContext, std::uint64_t ullId) = nullptr;
+        void *pContext = nullptr;
+        std::uint64_t ullId = 0;
+    };
+
+    /// @brief A coroutine used to implement yielding Luau C functions.
+    /// @remarks The coroutine runs synchronously until its first co_await. If it completes before suspending, its
+    /// result is returned straight to Luau, else the Scheduler takes ownership of it and resumes it on Roblox's thread
+    /// once the awaited operation is done. The value returned by co_return is the amount of values pushed into the
+    /// lua stack.
+    template<typename T>
+    class Task final {
+    public:
+        struct promise_type {
+            /// @brief The thread the C function was called on.
+            lua_State *L;
+            std::atomic<TaskState> state = TaskState::Running;
+            std::optional<T> result;
+            std::exception_ptr exception;
+            /// @brief The point in time after which the awaited operation is considered to have timed out.
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+            /// @brief When the coroutine last suspended, and when the operation it awaited on completed.
+            std::chrono::steady_clock::time_point suspendedAt, readyAt;
+            /// @brief Notifies the Scheduler once the awaited operation completes, if the Task is Parked.
+            TaskWaker waker;
+            /// @brief Whether the coroutine awaits on nothing but its deadline, in which case reaching the deadline
+            /// makes it Ready instead of timing it out. Nothing but the Scheduler holds on to such a coroutine.
+            bool bWakeOnDeadline = false;
+
+            explicit promise_type(lua_State *L) : L(L) {}
+
+            Task get_return_object() { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_value(T value) { this->result = std::move(value); }
+            void unhandled_exception() { this->exception = std::current_exception(); }
+
+            /// @brief Gives up on the awaited operation, if it is still in flight.
+            /// @return True if it was, in which case whoever completes the operation destroys the frame.
+            bool Abandon() {
+                auto current = this->state.load();
+                while (current == TaskState::Waiting || current == TaskState::Parked) {
+                    if (this->state.compare_exchange_weak(current, TaskState::Abandoned))
+                        return true;
+                }
+
+                return false;
+            }
+        };
+
+    private:
+        std::coroutine_handle<promise_type> m_hCoroutine;
+
+        explicit Task(const std::coroutine_handle<promise_type> hCoroutine) : m_hCoroutine(hCoroutine) {}
+
+    public:
+        Task(const Task &) = delete;
+        Task &operator=(const Task &) = delete;
+        Task(Task &&task) noexcept : m_hCoroutine(std::exchange(task.m_hCoroutine, nullptr)) {}
+
+        ~Task() {
+            if (this->m_hCoroutine)
+                this->m_hCoroutine.destroy();
+        }
+
+        /// @brief Gives up ownership of the underlying coroutine. The caller is responsible for destroying it.
+        std::coroutine_handle<promise_type> Release() { return std::exchange(this->m_hCoroutine, nullptr); }
+
+        [[nodiscard]] bool IsCompleted() const { return this->m_hCoroutine.done(); }
+
+        /// @brief Obtains the result of a completed task, rethrowing any exception that escaped it.
+        T GetResult() const {
+            if (const auto &promise = this->m_hCoroutine.promise(); promise.exception)
+                std::rethrow_exception(promise.exception);
+
+            return this->m_hCoroutine.promise().result.value();
+        }
+    };
+
+    /// @brief Allows work running on the ThreadPool to find out whether its result is still wanted.
+    class CancellationToken final {
+        const std::atomic<TaskState> *m_pState;
+        std::chrono::steady_clock::time_point m_deadline;
+
+    public:
+        CancellationToken(const std::atomic<TaskState> *pState, const std::chrono::steady_clock::time_point deadline)
+            : m_pState(pState), m_deadline(deadline) {}
+
+        /// @brief Obtains whether the awaiting Task has been abandoned or its deadline has passed.
+        [[nodiscard]] bool IsCancellationRequested() const {
+            return *this->m_pState == TaskState::Abandoned || std::chrono::steady_clock::now() > this->m_deadline;
+        }
+
+        /// @brief Obtains the time left until the deadline of the operation, or NoTimeout if it has none.
+        [[nodiscard]] std::chrono::milliseconds GetRemainingTime() const {
+            if (this->m_deadline == std::chrono::steady_clock::time_point::max())
+                return NoTimeout;
+
+            return std::max(std::chrono::duration_cast<std::chrono::milliseconds>(this->m_deadline -
+                                                                                  std::chrono::steady_clock::now()),
+                            std::chrono::milliseconds{1});
+        }
+    };
+
+    /// @brief Awaitable that runs a callable on the ThreadPool and resumes the awaiting Task with its return value.
+    /// @remarks The awaiter lives inside of the coroutine frame and is the work the ThreadPool links into its queues,
+    /// so awaiting it requires no allocations of its own. If the callable accepts a CancellationToken, it is given one.
+    template<typename Fn>
+    class ThreadPoolAwaiter final : ThreadPool::Work {
+        static constexpr bool bTakesToken = std::is_invocable_v<Fn, const CancellationToken &>;
+        using ResultType =
+                typename std::conditional_t<bTakesToken, std::invoke_result<Fn, const CancellationToken &>,
+                                            std::invoke_result<Fn>>::type;
+
+        Fn m_function;
+        std::chrono::milliseconds m_timeout;
+        std::optional<ResultType> m_result;
+        std::exception_ptr m_exception;
+        /// @brief The address of the awaiting coroutine.
+        void *m_pCoroutine = nullptr;
+
+        /// @brief Runs the callable on the calling worker thread and signals the awaiting Task.
+        template<typename Promise>
+        static void Execute(ThreadPool::Work *pWork) {
+            const auto pAwaiter = static_cast<ThreadPoolAwaiter *>(pWork);
+            const auto hCoroutine = std::coroutine_handle<Promise>::from_address(pAwaiter->m_pCoroutine);
+            auto &promise = hCoroutine.promise();
+            // If the Task was abandoned whilst queued, there is no point in doing the work at all.
+            if (promise.state != TaskState::Abandoned) {
+                try {
+                    if constexpr (bTakesToken)
+                        pAwaiter->m_result.emplace(
+                                pAwaiter->m_function(CancellationToken{&promise.state, promise.deadline}));
+                    else
+                        pAwaiter->m_result.emplace(pAwaiter->m_function());
+                } catch (...) {
+                    pAwaiter->m_exception = std::current_exception();
+                }
+            }
+
+            promise.readyAt = std::chrono::steady_clock::now();
+            TaskWaker waker;
+            auto previous = promise.state.load();
+            do {
+                if (previous == TaskState::Abandoned) {
+                    // The Scheduler is no longer interested in the Task and left the frame for us to clean up. Nothing
+                    // may touch the awaiter after this point, as it lives inside of the frame.
+                    hCoroutine.destroy();
+                    return;
+                }
+
+                // Once the Task is Ready the Scheduler may resume and destroy the frame at any moment, so the waker
+                // must be taken out of it beforehand.
+                if (previous == TaskState::Parked)
+                    waker = promise.waker;
+            } while (!promise.state.compare_exchange_weak(previous, TaskState::Ready));
+
+            // If the Task was not Parked yet, the Scheduler finds it Ready when it gets to park it.
+            if (previous == TaskState::Parked)
+                waker.pfnWake(waker.pContext, waker.ullId);
+        }
+
+    public:
+        ThreadPoolAwaiter(Fn function, const std::chrono::milliseconds timeout)
+            : m_function(std::move(function)), m_timeout(timeout) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> hCoroutine) {
+            auto &promise = hCoroutine.promise();
+            promise.suspendedAt = std::chrono::steady_clock::now();
+            promise.deadline = this->m_timeout == NoTimeout ? std::chrono::steady_clock::time_point::max()
+                                                            : promise.suspendedAt + this->m_timeout;
+            promise.bWakeOnDeadline = false;
+            promise.state = TaskState::Waiting;
+            this->pfnExecute = &ThreadPoolAwaiter::Execute<Promise>;
+            this->pOwner = GetYieldOwner(promise.L);
+            this->m_pCoroutine = hCoroutine.address();
+            if (!ThreadPool::GetSingleton()->Submit(this)) {
+                promise.deadline = std::chrono::steady_clock::time_point::max();
+                promise.state = TaskState::Running;
+                throw std::exception("Too many yielding operations are pending! The operation has been refused.");
+            }
+
+            return true;
+        }
+
+        ResultType await_resume() {
+            if (this->m_exception)
+                std::rethrow_exception(this->m_exception);
+
+            return std::move(this->m_result.value());
+        }
+    };
+
+    /// @brief Awaitable that suspends the awaiting Task until the next time the Scheduler is stepped.
+    class NextSchedulerStep final {
+    public:
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> hCoroutine) const noexcept {
+            auto &promise = hCoroutine.promise();
+            promise.suspendedAt = promise.readyAt = std::chrono::steady_clock::now();
+            promise.bWakeOnDeadline = false;
+            promise.state = TaskState::Ready;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    /// @brief Awaitable that suspends the awaiting Task until the given point in time, at which the Scheduler's timer
+    /// wheel resumes it. The thread is resumed on the first Scheduler step after the deadline.
+    class WaitUntil final {
+        std::chrono::steady_clock::time_point m_deadline;
+
+    public:
+        explicit WaitUntil(const std::chrono::steady_clock::time_point deadline) : m_deadline(deadline) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> hCoroutine) const noexcept {
+            auto &promise = hCoroutine.promise();
+            promise.suspendedAt = std::chrono::steady_clock::now();
+            promise.deadline = this->m_deadline;
+            promise.bWakeOnDeadline = true;
+            promise.state = TaskState::Waiting;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    /// @brief Suspends the calling Task for the given duration.
+    /// @remarks Unlike task.wait, the wait is tracked by the Scheduler itself, so thousands of threads may sleep at
+    /// once without Roblox or the Scheduler having to look at them on every frame.
+    inline WaitUntil Sleep(const std::chrono::steady_clock::duration duration) {
+        return WaitUntil{std::chrono::steady_clock::now() + duration};
+    }
+
+    /// @brief Runs the given callable on the ThreadPool, suspending the calling Task until it returns.
+    /// @param function A callable whose return value is the result of the co_await expression. It runs on a worker
+    /// thread, and thus must not touch the lua_State.
+    /// @param timeout The time after which the Scheduler gives up on the operation and resumes the thread with an
+    /// error, or NoTimeout to wait indefinitely.
+    template<typename Fn>
+    ThreadPoolAwaiter<Fn> RunOnThreadPool(Fn function, const std::chrono::milliseconds timeout = DefaultYieldTimeout) {
+        return ThreadPoolAwaiter<Fn>{std::move(function), timeout};
+    }
+} // namespace RbxStu
@@ -0,0 +1,146 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <format>
+#include <thread>
+
+#include "Logger.hpp"
+#include "MetricsRegistry.hpp"
+
+std::shared_ptr<ThreadPool> ThreadPool::pInstance;
+
+static std::mutex __threadpool__singleton__lock;
+
+/// @brief Obtains the counter of the pool's tasks that reached the given outcome.
+static RbxStu::Metrics::Counter &GetTaskCounter(const char *szOutcome) {
+    return MetricsRegistry::GetSingleton()->GetCounter("rbxstu_threadpool_tasks_total",
+                                                       "The tasks submitted into the ThreadPool, by their outcome.",
+                                                       {{"outcome", szOutcome}});
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::GetSingleton() {
+    std::lock_guard lock{__threadpool__singleton__lock};
+    if (ThreadPool::pInstance == nullptr) {
+        ThreadPool::pInstance = std::make_shared<ThreadPool>();
+        ThreadPool::pInstance->Initialize();
+    }
+
+    return ThreadPool::pInstance;
+}
+
+void ThreadPool::Initialize() {
+    // Most of the work we run is I/O bound (HTTP, dialogs), so we want more workers than cores, but never an unbounded
+    // amount of them, which is what spawning a thread per yield did.
+    this->m_dwWorkerCount = std::clamp(std::thread::hardware_concurrency() * 2, 4u, 16u);
+
+    // The workers hold on to the pool, so that it is not destroyed under them when the process exits.
+    for (std::uint32_t i = 0; i < this->m_dwWorkerCount; i++)
+        std::thread([pThreadPool = ThreadPool::pInstance] { pThreadPool->WorkerLoop(); }).detach();
+
+    Logger::GetSingleton()->PrintInformation(
+            RbxStu::ThreadPool, std::format("Initialized thread pool with {} workers. Max in-flight per owner: {}",
+                                            this->m_dwWorkerCount, this->m_dwMaxInFlightPerOwner));
+}
+
+void ThreadPool::WorkQueue::Push(Work *pWork) {
+    pWork->pNext = nullptr;
+    if (this->pTail != nullptr)
+        this->pTail->pNext = pWork;
+    else
+        this->pHead = pWork;
+
+    this->pTail = pWork;
+    this->ullSize++;
+}
+
+ThreadPool::Work *ThreadPool::WorkQueue::Pop() {
+    const auto pWork = this->pHead;
+    this->pHead = pWork->pNext;
+    if (this->pHead == nullptr)
+        this->pTail = nullptr;
+
+    this->ullSize--;
+    return pWork;
+}
+
+void ThreadPool::WorkerLoop() {
+    while (true) {
+        Work *pWork;
+        {
+            std::unique_lock lock{this->m_mutex};
+            this->m_cvTaskAvailable.wait(lock, [this] { return this->m_qTasks.ullSize != 0; });
+            pWork = this->m_qTasks.Pop();
+            this->m_ullRunning++;
+        }
+
+        // Executing the work may free it.
+        const auto pOwner = pWork->pOwner;
+        try {
+            pWork->pfnExecute(pWork);
+        } catch (const std::exception &ex) {
+            Logger::GetSingleton()->PrintError(
+                    RbxStu::ThreadPool, std::format("A pool task has thrown an exception! Error: {}", ex.what()));
+        }
+
+        std::lock_guard lock{this->m_mutex};
+        this->m_ullRunning--;
+        this->m_ullCompleted++;
+        static auto &completedTasks = GetTaskCounter("completed");
+        completedTasks.Increment();
+        this->OnTaskFinished(pOwner);
+    }
+}
+
+void ThreadPool::OnTaskFinished(const void *pOwner) {
+    const auto it = this->m_mapOwners.find(pOwner);
+    if (it == this->m_mapOwners.end())
+        return;
+
+    auto &owner = it->second;
+    if (owner.throttled.ullSize != 0) {
+        // The owner keeps its slot, we just hand it to the next work it had waiting.
+        this->m_qTasks.Push(owner.throttled.Pop());
+        this->m_ullThrottledCount--;
+        this->m_ullPeakQueueDepth = std::max(this->m_ullPeakQueueDepth, this->m_qTasks.ullSize);
+        this->m_cvTaskAvailable.notify_one();
+        return;
+    }
+
+    if (--owner.dwInFlight == 0 && this->m_mapOwners.size() > this->m_ullMaxKnownOwners)
+        this->m_mapOwners.erase(it);
+}
+
+bool ThreadPool::Submit(Work *pWork) {
+    std::lock_guard lock{this->m_mutex};
+
+    if (this->m_qTasks.ullSize + this->m_ullThrottledCount >= this->m_ullMaxPendingTasks) {
+        this->m_ullRejected++;
+        static auto &rejectedTasks = GetTaskCounter("rejected");
+        rejectedTasks.Increment();
+        return false;
+    }
+
+    if (auto &owner = this->m_mapOwners[pWork->pOwner]; owner.dwInFlight >= this->m_dwMaxInFlightPerOwner) {
+        owner.throttled.Push(pWork);
+        this->m_ullThrottledCount++;
+        return true;
+    } else {
+        owner.dwInFlight++;
+    }
+
+    this->m_qTasks.Push(pWork);
+    this->m_ullPeakQueueDepth = std::max(this->m_ullPeakQueueDepth, this->m_qTasks.ullSize);
+    this->m_cvTaskAvailable.notify_one();
+    return true;
+}
+
+ThreadPool::Metrics ThreadPool::GetMetrics() const {
+    std::lock_guard lock{this->m_mutex};
+    return Metrics{this->m_dwWorkerCount,
+                   this->m_qTasks.ullSize,
+                   this->m_ullThrottledCount,
+                   this->m_ullRunning,
+                   this->m_ullPeakQueueDepth,
+                   this->m_ullCompleted,
+                   this->m_ullRejected};
+}
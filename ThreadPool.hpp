@@ -0,0 +1,113 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/// @brief A shared, size-bounded pool of worker threads used to run the blocking parts of environment functions (HTTP
+/// requests, dialogs, file I/O) outside of Roblox's task scheduler.
+class ThreadPool final {
+public:
+    /// @brief A unit of work for the pool to execute. The pool links it into its queues instead of copying it, so
+    /// submitting work allocates nothing.
+    /// @remarks It must stay alive until pfnExecute is invoked, which may free it.
+    struct Work {
+        /// @brief Executes the work on a worker thread.
+        void (*pfnExecute)(Work *pWork) = nullptr;
+        /// @brief The owner of the work, work is throttled per owner.
+        const void *pOwner = nullptr;
+        /// @brief The work queued after this one. Owned by the pool.
+        Work *pNext = nullptr;
+    };
+
+    /// @brief A snapshot of the pool's state, used for diagnostics.
+    struct Metrics {
+        /// @brief The amount of worker threads owned by the pool.
+        std::uint32_t dwWorkerCount;
+        /// @brief The amount of tasks waiting on the shared queue for a free worker.
+        std::size_t ullQueueDepth;
+        /// @brief The amount of tasks held back because their owner reached its in-flight limit.
+        std::size_t ullThrottledDepth;
+        /// @brief The amount of tasks currently being executed by a worker.
+        std::size_t ullRunning;
+        /// @brief The highest queue depth observed since the pool was created.
+        std::size_t ullPeakQueueDepth;
+        /// @brief The amount of tasks that have finished executing.
+        std::uint64_t ullCompleted;
+        /// @brief The amount of tasks that were refused because the pool was saturated.
+        std::uint64_t ullRejected;
+    };
+
+private:
+    /// @brief Private, Static shared pointer into the instance.
+    static std::shared_ptr<ThreadPool> pInstance;
+
+    /// @brief A first-in, first-out queue of work, linked through the work itself.
+    struct WorkQueue {
+        Work *pHead = nullptr;
+        Work *pTail = nullptr;
+        std::size_t ullSize = 0;
+
+        void Push(Work *pWork);
+        Work *Pop();
+    };
+
+    /// @brief The state of the pool kept for every owner of work.
+    struct OwnerState {
+        /// @brief The amount of the owner's work that is either queued or running.
+        std::uint32_t dwInFlight = 0;
+        /// @brief Work that may not be dispatched yet, as the owner already has the maximum amount of work in flight.
+        WorkQueue throttled;
+    };
+
+    /// @brief The amount of worker threads. They are detached and live for as long as the process does.
+    std::uint32_t m_dwWorkerCount = 0;
+    /// @brief Work ready to be picked up by any worker.
+    WorkQueue m_qTasks;
+    /// @brief The state of every owner that has work in flight, or had it recently. Owners are kept once they go idle,
+    /// so that a script awaiting over and over does not allocate its entry anew every time.
+    std::unordered_map<const void *, OwnerState> m_mapOwners;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cvTaskAvailable;
+
+    /// @brief The maximum amount of tasks an owner may have queued or running at once.
+    std::uint32_t m_dwMaxInFlightPerOwner = 16;
+    /// @brief The maximum amount of tasks that can be pending (queued + throttled) before new work is rejected.
+    std::size_t m_ullMaxPendingTasks = 4096;
+    /// @brief The amount of owners to keep track of before idle ones are forgotten as soon as they go idle.
+    std::size_t m_ullMaxKnownOwners = 256;
+
+    std::size_t m_ullThrottledCount = 0;
+    std::size_t m_ullRunning = 0;
+    std::size_t m_ullPeakQueueDepth = 0;
+    std::uint64_t m_ullCompleted = 0;
+    std::uint64_t m_ullRejected = 0;
+
+    /// @brief Spawns the worker threads.
+    void Initialize();
+
+    /// @brief The body of every worker thread.
+    void WorkerLoop();
+
+    /// @brief Called once a task finishes, releasing the owners' slot and promoting any throttled task.
+    /// @remarks The pool's mutex must be held by the caller.
+    void OnTaskFinished(const void *pOwner);
+
+public:
+    /// @brief Obtains the shared pointer that points to the global singleton for the current class.
+    /// @return Singleton for ThreadPool as a std::shared_ptr<ThreadPool>.
+    static std::shared_ptr<ThreadPool> GetSingleton();
+
+    /// @brief Submits work into the pool.
+    /// @param pWork The work to execute on a worker thread. Its owner is an opaque key identifying who the work belongs
+    /// to, normally the script that requested it.
+    /// @return False if the pool is saturated and the work was not accepted, true otherwise.
+    /// @remarks If the owner already has the maximum amount of work in flight, the work is accepted but will only be
+    /// dispatched once some of the owners' work finishes.
+    bool Submit(Work *pWork);
+
+    /// @brief Obtains a snapshot of the pool's queue and throughput counters.
+    [[nodiscard]] Metrics GetMetrics() const;
+};
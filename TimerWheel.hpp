@@ -0,0 +1,154 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace RbxStu {
+    /// @brief A hierarchical timer wheel with a resolution of one millisecond.
+    /// @tparam TValue The value carried by every timer, handed back once it expires.
+    /// @remarks Scheduling a timer is O(1), and advancing the wheel costs O(expired) plus a constant per elapsed tick
+    /// with timers due on it, as empty stretches of the innermost wheel are skipped over. Timers are never cancelled,
+    /// owners must ignore the values of timers they are no longer interested in. Not thread-safe, callers must
+    /// synchronize access to it.
+    template<typename TValue>
+    class TimerWheel final {
+        static constexpr std::uint32_t SlotBits = 8;
+        static constexpr std::uint64_t SlotCount = 1ull << SlotBits;
+        static constexpr std::uint64_t SlotMask = SlotCount - 1;
+        static constexpr std::uint32_t LevelCount = 4;
+        /// @brief The furthest a timer may be scheduled into the future, in ticks. Timers further away than this
+        /// expire early, at this span, roughly 49 days.
+        static constexpr std::uint64_t MaximumSpan = (1ull << (SlotBits * LevelCount)) - 1;
+
+        struct Timer {
+            /// @brief The tick at which the timer expires.
+            std::uint64_t ullExpiry;
+            TValue value;
+        };
+
+        /// @brief The wheels, from the innermost (one tick per slot) to the outermost (2^24 ticks per slot).
+        std::array<std::array<std::vector<Timer>, SlotCount>, LevelCount> m_aWheels;
+        /// @brief The amount of timers held on each of the wheels.
+        std::array<std::size_t, LevelCount> m_aTimerCounts{};
+        /// @brief The last tick the wheel has been advanced to.
+        std::uint64_t m_ullCurrentTick = 0;
+        /// @brief The moment the wheel started ticking, tick zero.
+        std::chrono::steady_clock::time_point m_origin = std::chrono::steady_clock::now();
+
+        /// @brief Places a timer on the slot of the wheel matching how far into the future it expires.
+        void Insert(Timer timer) {
+            const auto ullDelta = timer.ullExpiry - this->m_ullCurrentTick;
+            std::uint32_t dwLevel = 0;
+            while (dwLevel < LevelCount - 1 && ullDelta >= 1ull << (SlotBits * (dwLevel + 1)))
+                dwLevel++;
+
+            const auto ullSlot = (timer.ullExpiry >> (SlotBits * dwLevel)) & SlotMask;
+            this->m_aWheels[dwLevel][ullSlot].emplace_back(std::move(timer));
+            this->m_aTimerCounts[dwLevel]++;
+        }
+
+        /// @brief Moves the timers on the current slot of every outer wheel whose inner wheel has just wrapped around
+        /// into the wheels below it.
+        void Cascade() {
+            for (std::uint32_t dwLevel = 1; dwLevel < LevelCount; dwLevel++) {
+                const auto ullSlot = (this->m_ullCurrentTick >> (SlotBits * dwLevel)) & SlotMask;
+                auto timers = std::move(this->m_aWheels[dwLevel][ullSlot]);
+                this->m_aWheels[dwLevel][ullSlot].clear();
+                this->m_aTimerCounts[dwLevel] -= timers.size();
+                for (auto &timer: timers)
+                    this->Insert(std::move(timer));
+
+                // The wheel above only needs to cascade if this one has wrapped around as well.
+                if (ullSlot != 0)
+                    break;
+            }
+        }
+
+        /// @brief Converts a point in time into the tick it falls on, rounding up if bRoundUp is true, else down.
+        [[nodiscard]] std::uint64_t ToTick(const std::chrono::steady_clock::time_point timePoint,
+                                           const bool bRoundUp) const {
+            if (timePoint <= this->m_origin)
+                return 0;
+
+            const auto elapsed = timePoint - this->m_origin;
+            const auto msElapsed = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
+            auto ullTick = static_cast<std::uint64_t>(msElapsed.count());
+            if (bRoundUp && msElapsed < elapsed)
+                ullTick++;
+
+            return ullTick;
+        }
+
+    public:
+        /// @brief Schedules a timer.
+        /// @param deadline The point in time the timer expires at. Timers whose deadline has already passed expire on
+        /// the next tick.
+        /// @param value The value to hand back once the timer expires.
+        void Schedule(const std::chrono::steady_clock::time_point deadline, TValue value) {
+            const auto ullExpiry = std::clamp(this->ToTick(deadline, true), this->m_ullCurrentTick + 1,
+                                              this->m_ullCurrentTick + MaximumSpan);
+            this->Insert(Timer{ullExpiry, std::move(value)});
+        }
+
+        /// @brief Advances the wheel up to the given point in time, expiring every timer due until then.
+        /// @param now The point in time to advance to.
+        /// @param onExpired Invoked with the value of every expired timer, as a TValue &, in order of expiry.
+        /// @return The amount of timers that expired.
+        template<typename Fn>
+        std::size_t Advance(const std::chrono::steady_clock::time_point now, Fn &&onExpired) {
+            const auto ullTarget = this->ToTick(now, false);
+            std::size_t ullExpired = 0;
+            while (this->m_ullCurrentTick < ullTarget) {
+                if (this->m_aTimerCounts[0] == 0) {
+                    // Nothing can expire before the innermost wheel wraps around and the outer wheels cascade into it.
+                    if (this->GetTimerCount() == 0) {
+                        this->m_ullCurrentTick = ullTarget;
+                        break;
+                    }
+
+                    this->m_ullCurrentTick = std::min(ullTarget, this->m_ullCurrentTick | SlotMask);
+                    if (this->m_ullCurrentTick == ullTarget)
+                        break;
+                }
+
+                this->m_ullCurrentTick++;
+                if ((this->m_ullCurrentTick & SlotMask) == 0)
+                    this->Cascade();
+
+                auto &slot = this->m_aWheels[0][this->m_ullCurrentTick & SlotMask];
+                if (slot.empty())
+                    continue;
+
+                auto timers = std::move(slot);
+                slot.clear();
+                this->m_aTimerCounts[0] -= timers.size();
+                ullExpired += timers.size();
+                for (auto &timer: timers)
+                    onExpired(timer.value);
+            }
+
+            return ullExpired;
+        }
+
+        /// @brief Removes every timer from the wheel without expiring them.
+        void Clear() {
+            for (auto &wheel: this->m_aWheels) {
+                for (auto &slot: wheel)
+                    slot.clear();
+            }
+
+            this->m_aTimerCounts.fill(0);
+        }
+
+        /// @brief Obtains the amount of timers that have yet to expire.
+        [[nodiscard]] std::size_t GetTimerCount() const {
+            std::size_t ullCount = 0;
+            for (const auto ullTimers: this->m_aTimerCounts)
+                ullCount += ullTimers;
+
+            return ullCount;
+        }
+    };
+} // namespace RbxStu
@@ -0,0 +1,331 @@
+// Offline decoder of the binary log files RbxStu writes when RBXSTU_LOG_FORMAT is "binary". Every message is printed
+// as a line, formatted from its format string and arguments the way the Logger would have, or as JSON lines with the
+// arguments alongside, for tools to consume.
+//
+// Usage: LogDecoder [--json] <file>...
+// Files are decoded in the order given, so the oldest segment ("RbxStu.<count - 1>.rbxlog") should come first.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "BinaryLogFormat.hpp"
+
+namespace {
+    using namespace RbxStu::BinaryLog;
+
+    /// @brief A pointer argument, kept apart from unsigned integers to be formatted as one.
+    struct PointerArgument {
+        std::uint64_t ullAddress;
+    };
+
+    using Argument = std::variant<std::int64_t, std::uint64_t, double, bool, char, PointerArgument, std::string>;
+
+    /// @brief Reads the arguments of a message record.
+    /// @return False if the record is malformed.
+    bool ReadArguments(std::string_view szRecord, const std::uint8_t bCount, std::vector<Argument> &arguments) {
+        for (std::uint8_t i = 0; i < bCount; i++) {
+            const auto type = ReadValue<ArgumentType>(szRecord);
+            if (!type.has_value())
+                return false;
+
+            switch (type.value()) {
+                case ArgumentType::SignedInteger: {
+                    const auto value = ReadValue<std::int64_t>(szRecord);
+                    if (!value.has_value())
+                        return false;
+
+                    arguments.emplace_back(value.value());
+                    break;
+                }
+                case ArgumentType::UnsignedInteger: {
+                    const auto value = ReadValue<std::uint64_t>(szRecord);
+                    if (!value.has_value())
+                        return false;
+
+                    arguments.emplace_back(value.value());
+                    break;
+                }
+                case ArgumentType::Float: {
+                    const auto value = ReadValue<double>(szRecord);
+                    if (!value.has_value())
+                        return false;
+
+                    arguments.emplace_back(value.value());
+                    break;
+                }
+                case ArgumentType::Boolean: {
+                    const auto value = ReadValue<std::uint8_t>(szRecord);
+                    if (!value.has_value())
+                        return false;
+
+                    arguments.emplace_back(value.value() != 0);
+                    break;
+                }
+                case ArgumentType::Character: {
+                    const auto value = ReadValue<char>(szRecord);
+                    if (!value.has_value())
+                        return false;
+
+                    arguments.emplace_back(value.value());
+                    break;
+                }
+                case ArgumentType::Pointer: {
+                    const auto value = ReadValue<std::uint64_t>(szRecord);
+                    if (!value.has_value())
+                        return false;
+
+                    arguments.emplace_back(PointerArgument{value.value()});
+                    break;
+                }
+                case ArgumentType::String: {
+                    const auto dwLength = ReadValue<std::uint32_t>(szRecord);
+                    if (!dwLength.has_value() || szRecord.size() < dwLength.value())
+                        return false;
+
+                    arguments.emplace_back(std::string{szRecord.substr(0, dwLength.value())});
+                    szRecord.remove_prefix(dwLength.value());
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    /// @brief Formats a single argument with the given format spec, falling back to its default formatting should the
+    /// spec not suit it.
+    std::string FormatArgument(const Argument &argument, const std::string_view szSpec) {
+        return std::visit(
+                [szSpec](const auto &value) -> std::string {
+                    using T = std::decay_t<decltype(value)>;
+                    if constexpr (std::is_same_v<T, PointerArgument>) {
+                        const auto pointer =
+                                reinterpret_cast<const void *>(static_cast<std::uintptr_t>(value.ullAddress));
+                        try {
+                            return std::vformat(std::format("{{:{}}}", szSpec), std::make_format_args(pointer));
+                        } catch (const std::format_error &) {
+                            return std::format("{}", pointer);
+                        }
+                    } else {
+                        try {
+                            return std::vformat(std::format("{{:{}}}", szSpec), std::make_format_args(value));
+                        } catch (const std::format_error &) {
+                            return std::format("{}", value);
+                        }
+                    }
+                },
+                argument);
+    }
+
+    /// @brief Formats a message, replacing every replacement field in its format string with its argument.
+    std::string FormatMessage(const std::string_view szFormat, const std::vector<Argument> &arguments) {
+        std::string szOutput;
+        std::size_t ullNextArgument = 0;
+        for (std::size_t i = 0; i < szFormat.size(); i++) {
+            const auto c = szFormat[i];
+            if ((c == '{' || c == '}') && i + 1 < szFormat.size() && szFormat[i + 1] == c) {
+                szOutput.push_back(c);
+                i++;
+                continue;
+            }
+
+            const auto ullEnd = szFormat.find('}', i);
+            if (c != '{' || ullEnd == std::string_view::npos) {
+                szOutput.push_back(c);
+                continue;
+            }
+
+            // "{index:spec}", both parts being optional.
+            const auto szField = szFormat.substr(i + 1, ullEnd - i - 1);
+            const auto ullColon = szField.find(':');
+            const auto szIndex = szField.substr(0, ullColon);
+            const auto szSpec = ullColon == std::string_view::npos ? std::string_view{} : szField.substr(ullColon + 1);
+            auto ullArgument = ullNextArgument++;
+            if (!szIndex.empty())
+                ullArgument = std::strtoull(std::string{szIndex}.c_str(), nullptr, 10);
+
+            if (ullArgument < arguments.size())
+                szOutput.append(FormatArgument(arguments[ullArgument], szSpec));
+            else
+                szOutput.append("<missing argument>");
+
+            i = ullEnd;
+        }
+
+        return szOutput;
+    }
+
+    std::string FormatTimestamp(const std::int64_t llTimestamp) {
+        const auto llSeconds = llTimestamp / 1000000000;
+        const auto llNanoseconds = llTimestamp % 1000000000;
+        const auto time = static_cast<std::time_t>(llSeconds);
+        std::tm tm{};
+        gmtime_r(&time, &tm);
+        return std::format("{:04}-{:02}-{:02}T{:02}:{:02}:{:02}.{:09}Z", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                           tm.tm_hour, tm.tm_min, tm.tm_sec, llNanoseconds);
+    }
+
+    std::string EscapeJson(const std::string_view szString) {
+        std::string szOutput;
+        for (const auto c: szString) {
+            switch (c) {
+                case '"':
+                    szOutput.append("\\\"");
+                    break;
+                case '\\':
+                    szOutput.append("\\\\");
+                    break;
+                case '\n':
+                    szOutput.append("\\n");
+                    break;
+                case '\r':
+                    szOutput.append("\\r");
+                    break;
+                case '\t':
+                    szOutput.append("\\t");
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                        szOutput.append(std::format("\\u{:04x}", static_cast<unsigned char>(c)));
+                    else
+                        szOutput.push_back(c);
+            }
+        }
+
+        return szOutput;
+    }
+
+    std::string ArgumentToJson(const Argument &argument) {
+        return std::visit(
+                [](const auto &value) -> std::string {
+                    using T = std::decay_t<decltype(value)>;
+                    if constexpr (std::is_same_v<T, PointerArgument>)
+                        return std::format("\"{:#x}\"", value.ullAddress);
+                    else if constexpr (std::is_same_v<T, std::string>)
+                        return std::format("\"{}\"", EscapeJson(value));
+                    else if constexpr (std::is_same_v<T, char>)
+                        return std::format("\"{}\"", EscapeJson({&value, 1}));
+                    else if constexpr (std::is_same_v<T, double>)
+                        return value == value && value - value == 0 ? std::format("{}", value) : "null";
+                    else
+                        return std::format("{}", value);
+                },
+                argument);
+    }
+
+    /// @brief Decodes a binary log file, printing every message in it.
+    /// @return False if the file could not be read or is not a binary log file.
+    bool DecodeFile(const char *szPath, const bool bAsJson) {
+        std::ifstream file{szPath, std::ios::binary};
+        if (!file) {
+            std::fprintf(stderr, "%s: cannot be opened\n", szPath);
+            return false;
+        }
+
+        const std::string szContents{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+        std::string_view szBytes = szContents;
+        const auto header = ReadValue<FileHeader>(szBytes);
+        if (!header.has_value() || header->dwMagic != BinaryLogMagic) {
+            std::fprintf(stderr, "%s: not a binary log file\n", szPath);
+            return false;
+        }
+
+        if (header->wVersion != BinaryLogVersion) {
+            std::fprintf(stderr, "%s: unsupported version %u, expected %u\n", szPath, header->wVersion,
+                         BinaryLogVersion);
+            return false;
+        }
+
+        std::unordered_map<std::uint32_t, std::string> strings;
+        const auto getString = [&strings](const std::uint32_t dwId) {
+            if (const auto string = strings.find(dwId); string != strings.end())
+                return string->second;
+
+            return std::format("<unknown string {}>", dwId);
+        };
+
+        RecordHeader recordHeader{};
+        std::string_view szRecord;
+        while (ReadRecord(szBytes, recordHeader, szRecord)) {
+            if (recordHeader.type == RecordType::String) {
+                if (const auto record = ReadValue<StringRecord>(szRecord); record.has_value())
+                    strings[record->dwId] = std::string{szRecord};
+
+                continue;
+            }
+
+            // Records of types we do not know of are skipped, they may have been added by a newer RbxStu.
+            if (recordHeader.type != RecordType::Message)
+                continue;
+
+            std::vector<Argument> arguments;
+            const auto record = ReadValue<MessageRecord>(szRecord);
+            if (!record.has_value() || !ReadArguments(szRecord, record->bArgumentCount, arguments)) {
+                std::fprintf(stderr, "%s: skipping a malformed message\n", szPath);
+                continue;
+            }
+
+            const auto szLevel = LevelNames[std::min<std::size_t>(record->bLevel, std::size(LevelNames) - 1)];
+            const auto szSection = getString(record->dwSectionId);
+            const auto szFormat = getString(record->dwFormatId);
+            const auto szText = FormatMessage(szFormat, arguments);
+            const auto szTimestamp = FormatTimestamp(record->llTimestamp);
+
+            std::string szLine;
+            if (bAsJson) {
+                std::string szArguments;
+                for (const auto &argument: arguments)
+                    szArguments.append(szArguments.empty() ? "" : ",").append(ArgumentToJson(argument));
+
+                szLine = std::format(R"({{"timestamp":"{}","level":"{}","section":"{}","thread":{},"message":"{}",)"
+                                     R"("format":"{}","arguments":[{}]}})",
+                                     szTimestamp, szLevel, EscapeJson(szSection), record->dwThreadId,
+                                     EscapeJson(szText), EscapeJson(szFormat), szArguments);
+            } else {
+                szLine = std::format("{} [{}/{}] <{}> {}", szTimestamp, szLevel, szSection, record->dwThreadId,
+                                     szText);
+            }
+
+            std::fwrite(szLine.data(), 1, szLine.size(), stdout);
+            std::fputc('\n', stdout);
+        }
+
+        return true;
+    }
+} // namespace
+
+int main(const int argc, const char **argv) {
+    bool bAsJson = false;
+    std::vector<const char *> files;
+    for (int i = 1; i < argc; i++) {
+        if (std::string_view{argv[i]} == "--json")
+            bAsJson = true;
+        else
+            files.push_back(argv[i]);
+    }
+
+    if (files.empty()) {
+        std::fprintf(stderr, "Usage: %s [--json] <file>...\n", argv[0]);
+        return 2;
+    }
+
+    bool bSucceeded = true;
+    for (const auto szPath: files)
+        bSucceeded &= DecodeFile(szPath, bAsJson);
+
+    return bSucceeded ? 0 : 1;
+}
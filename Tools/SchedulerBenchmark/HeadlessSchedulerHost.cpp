@@ -0,0 +1,69 @@
+#include "HeadlessSchedulerHost.hpp"
+
+#include "Logger.hpp"
+
+HeadlessSchedulerHost::HeadlessSchedulerHost(const luaL_Reg *pLibrary) { this->m_pLibrary = pLibrary; }
+
+void HeadlessSchedulerHost::OnResumed(lua_State *L, const int dwStatus) {
+    if (dwStatus == LUA_OK) {
+        this->m_ullCompletedThreads++;
+    } else if (dwStatus != LUA_YIELD && dwStatus != LUA_BREAK) {
+        // The job trampoline has reported the error already, this is the error raised again for Roblox to print.
+        RbxStuLog(Debug, RbxStu::Scheduler, "Thread failed: {}", lua_isstring(L, -1) ? lua_tostring(L, -1) : "?");
+        this->m_ullFailedThreads++;
+        lua_settop(L, 0);
+    }
+}
+
+void HeadlessSchedulerHost::RunDeferredThreads() {
+    for (const auto &[L, dwThreadRef]: std::exchange(this->m_vDeferredThreads, {})) {
+        this->OnResumed(L, lua_resume(L, nullptr, 0));
+        // A thread that yielded is kept alive by whatever it yielded on.
+        lua_unref(L, dwThreadRef);
+    }
+}
+
+std::size_t HeadlessSchedulerHost::GetCompletedThreads() const { return this->m_ullCompletedThreads; }
+
+std::size_t HeadlessSchedulerHost::GetFailedThreads() const { return this->m_ullFailedThreads; }
+
+bool HeadlessSchedulerHost::IsReady() { return true; }
+
+std::optional<void *> HeadlessSchedulerHost::GetCurrentDataModel() { return this; }
+
+bool HeadlessSchedulerHost::IsDataModelAlive(void *pDataModel) { return pDataModel == this; }
+
+void HeadlessSchedulerHost::PushEnvironment(lua_State *L) {
+    lua_pushvalue(L, LUA_GLOBALSINDEX);
+    luaL_register(L, nullptr, this->m_pLibrary);
+    lua_pop(L, 1);
+}
+
+void HeadlessSchedulerHost::ConnectHeartbeat(lua_State *L) {
+    // There is no engine to connect to, the owner of the host steps the Scheduler itself.
+}
+
+bool HeadlessSchedulerHost::DeferThread(lua_State *L) {
+    lua_pushthread(L);
+    this->m_vDeferredThreads.emplace_back(L, lua_ref(L, -1));
+    lua_pop(L, 1);
+    return true;
+}
+
+void HeadlessSchedulerHost::ResumeThread(lua_State *L, const int dwThreadRef, const std::int32_t nret,
+                                         const bool isError, const char *szErrorMessage) {
+    if (isError) {
+        lua_pushstring(L, szErrorMessage);
+        this->OnResumed(L, lua_resumeerror(L, nullptr));
+    } else {
+        this->OnResumed(L, lua_resume(L, nullptr, nret));
+    }
+}
+
+void HeadlessSchedulerHost::SetThreadSecurity(lua_State *L, const int identity) {
+    // Without Roblox there are no identities to elevate to.
+}
+
+void HeadlessSchedulerHost::SetClosureSecurity(Closure *closure, const int identity) {}
+
+bool HeadlessSchedulerHost::IsCodeGenerationEnabled() { return false; }
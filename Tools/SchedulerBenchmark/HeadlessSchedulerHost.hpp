@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "SchedulerHost.hpp"
+#include "lualib.h"
+
+/// @brief A SchedulerHost that runs the Scheduler on a plain Luau VM, without Roblox. It stands in for Roblox's task
+/// scheduler as well: deferred threads are run by RunDeferredThreads, and yielded threads are resumed right away.
+/// @remarks Not thread-safe, like the VM it runs on. Frames are driven by its owner, who calls Scheduler::StepScheduler
+/// and then RunDeferredThreads once per frame, as Roblox would on Heartbeat.
+class HeadlessSchedulerHost final : public SchedulerHost {
+    /// @brief The functions pushed into the executor environment, terminated by an entry with a nullptr name.
+    const luaL_Reg *m_pLibrary;
+    /// @brief The threads handed over through DeferThread and the registry references that keep them alive, run on
+    /// the next call to RunDeferredThreads.
+    std::vector<std::pair<lua_State *, int>> m_vDeferredThreads;
+    /// @brief The threads that ran to completion.
+    std::size_t m_ullCompletedThreads = 0;
+    /// @brief The threads that ended with an error.
+    std::size_t m_ullFailedThreads = 0;
+
+    /// @brief Accounts for how a resumption of a thread ended.
+    void OnResumed(lua_State *L, int dwStatus);
+
+public:
+    /// @param pLibrary The functions to push into the executor environment, terminated by an entry with a nullptr
+    /// name. Must outlive the host.
+    explicit HeadlessSchedulerHost(const luaL_Reg *pLibrary);
+
+    /// @brief Runs every thread deferred since the last call. Threads deferred whilst doing so run on the next call.
+    void RunDeferredThreads();
+
+    /// @brief Obtains the number of threads that ran to completion so far.
+    [[nodiscard]] std::size_t GetCompletedThreads() const;
+
+    /// @brief Obtains the number of threads that ended with an error so far.
+    [[nodiscard]] std::size_t GetFailedThreads() const;
+
+    bool IsReady() override;
+    std::optional<void *> GetCurrentDataModel() override;
+    bool IsDataModelAlive(void *pDataModel) override;
+    void PushEnvironment(lua_State *L) override;
+    void ConnectHeartbeat(lua_State *L) override;
+    bool DeferThread(lua_State *L) override;
+    void ResumeThread(lua_State *L, int dwThreadRef, std::int32_t nret, bool isError,
+                      const char *szErrorMessage) override;
+    void SetThreadSecurity(lua_State *L, int identity) override;
+    void SetClosureSecurity(Closure *closure, int identity) override;
+    bool IsCodeGenerationEnabled() override;
+};
@@ -0,0 +1,303 @@
+// Headless benchmark of the Scheduler. It drives the real Scheduler, on the stock Luau VM and through the
+// HeadlessSchedulerHost instead of Roblox, with real Luau jobs, so scheduling changes can be measured reproducibly
+// outside of Studio:
+//  - Code jobs compile and run plain Luau code, whose size decides the lane they are queued on.
+//  - HttpGet jobs call httpget against a local stand-in server, yielding until the reply arrives on the ThreadPool,
+//    and are resumed through the Resumption lane.
+//  - Error jobs raise an error, like a script indexing nil.
+// Jobs are submitted from another thread, the way the pipe does, whilst the main thread steps the Scheduler once per
+// frame, the way Heartbeat does.
+//
+// Usage: SchedulerBenchmark [--jobs=N] [--http=PERCENT] [--errors=PERCENT] [--background=PERCENT]
+//                           [--server-delay-us=N] [--frame-ms=N] [--seed=N]
+
+#include <WinSock2.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "HeadlessSchedulerHost.hpp"
+#include "Histogram.hpp"
+#include "LatencyTracker.hpp"
+#include "Logger.hpp"
+#include "Scheduler.hpp"
+#include "SchedulerManager.hpp"
+#include "Task.hpp"
+#include "lualib.h"
+
+namespace {
+    struct Options {
+        std::size_t ullJobs = 10000;
+        std::uint32_t dwHttpPercent = 20;
+        std::uint32_t dwErrorPercent = 5;
+        std::uint32_t dwBackgroundPercent = 2;
+        std::uint32_t dwServerDelayUs = 2000;
+        std::uint32_t dwFrameMs = 0;
+        std::uint32_t dwSeed = 1337;
+    };
+
+    /// @brief The time without a single job finishing after which the benchmark gives up.
+    constexpr std::chrono::seconds StallTimeout{30};
+
+    /// @brief A local HTTP server that answers every request with a fixed body after an artificial delay.
+    class StandInHttpServer final {
+        SOCKET m_listenSocket = INVALID_SOCKET;
+        std::uint16_t m_wPort = 0;
+        std::uint32_t m_dwDelayUs;
+        std::vector<std::thread> m_acceptors;
+
+        void Serve() const {
+            while (true) {
+                const auto client = accept(this->m_listenSocket, nullptr, nullptr);
+                if (client == INVALID_SOCKET)
+                    return;
+
+                char buffer[1024];
+                std::string request;
+                while (request.find("\r\n\r\n") == std::string::npos) {
+                    const auto dwRead = recv(client, buffer, sizeof(buffer), 0);
+                    if (dwRead <= 0)
+                        break;
+                    request.append(buffer, static_cast<std::size_t>(dwRead));
+                }
+
+                std::this_thread::sleep_for(std::chrono::microseconds{this->m_dwDelayUs});
+                constexpr std::string_view szResponse =
+                        "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: close\r\n\r\nOK";
+                send(client, szResponse.data(), static_cast<int>(szResponse.size()), 0);
+                closesocket(client);
+            }
+        }
+
+    public:
+        StandInHttpServer(const std::uint32_t dwDelayUs, const std::uint32_t dwAcceptors) : m_dwDelayUs(dwDelayUs) {
+            this->m_listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = 0;
+            if (this->m_listenSocket == INVALID_SOCKET ||
+                bind(this->m_listenSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+                listen(this->m_listenSocket, SOMAXCONN) != 0) {
+                throw std::runtime_error("Failed to set up the stand-in HTTP server!");
+            }
+
+            int addressLength = sizeof(address);
+            getsockname(this->m_listenSocket, reinterpret_cast<sockaddr *>(&address), &addressLength);
+            this->m_wPort = ntohs(address.sin_port);
+
+            for (std::uint32_t i = 0; i < dwAcceptors; i++)
+                this->m_acceptors.emplace_back([this] { this->Serve(); });
+        }
+
+        ~StandInHttpServer() {
+            closesocket(this->m_listenSocket);
+            for (auto &acceptor: this->m_acceptors)
+                acceptor.join();
+        }
+
+        [[nodiscard]] std::uint16_t GetPort() const { return this->m_wPort; }
+    };
+
+    /// @brief Performs a blocking HTTP GET against the stand-in server listening on the port of the given URL.
+    /// @return The body of the reply.
+    std::string HttpGet(const std::string &szUrl) {
+        const auto ullPortStart = szUrl.rfind(':');
+        const auto wPort = static_cast<std::uint16_t>(std::strtoul(szUrl.c_str() + ullPortStart + 1, nullptr, 10));
+        const auto connection = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (connection == INVALID_SOCKET)
+            throw std::exception("HttpGet failed\nCould not create a socket.");
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(wPort);
+        if (connect(connection, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+            closesocket(connection);
+            throw std::exception("HttpGet failed\nCould not connect to the server.");
+        }
+
+        constexpr std::string_view szRequest =
+                "GET / HTTP/1.1\r\nHost: localhost\r\nUser-Agent: Roblox/WinInet\r\n\r\n";
+        send(connection, szRequest.data(), static_cast<int>(szRequest.size()), 0);
+
+        std::string response;
+        char buffer[1024];
+        while (true) {
+            const auto dwRead = recv(connection, buffer, sizeof(buffer), 0);
+            if (dwRead <= 0)
+                break;
+            response.append(buffer, static_cast<std::size_t>(dwRead));
+        }
+
+        closesocket(connection);
+        const auto ullBodyStart = response.find("\r\n\r\n");
+        if (!response.starts_with("HTTP/1.1 200") || ullBodyStart == std::string::npos)
+            throw std::exception("HttpGet failed\nThe server did not reply with 200 OK.");
+
+        return response.substr(ullBodyStart + 4);
+    }
+
+    /// @brief httpget, as exposed to the jobs. Yields like the one of the environment does, only against the stand-in
+    /// server instead of through cpr.
+    RbxStu::Task<int> httpget(lua_State *L) {
+        const std::string url = luaL_checkstring(L, 1);
+        const auto output = co_await RbxStu::RunOnThreadPool([url] { return HttpGet(url); });
+        lua_pushlstring(L, output.c_str(), output.size());
+        co_return 1;
+    }
+
+    /// @brief Generates plain Luau code of at least the given size.
+    std::string GenerateCode(const std::size_t ullSize) {
+        std::string szCode = "local sum = 0\n";
+        for (std::size_t i = 0; szCode.size() < ullSize; i++)
+            szCode += std::format("sum += math.sqrt({}) * {}\n", i, i % 7);
+
+        return szCode;
+    }
+
+    std::uint32_t ParseOption(const std::string_view szArgument, const std::string_view szName,
+                              const std::uint32_t dwDefault) {
+        if (!szArgument.starts_with(szName) || szArgument.size() <= szName.size() || szArgument[szName.size()] != '=')
+            return dwDefault;
+
+        return static_cast<std::uint32_t>(std::strtoul(szArgument.data() + szName.size() + 1, nullptr, 10));
+    }
+
+    std::uint64_t MicrosecondsBetween(const std::chrono::steady_clock::time_point begin,
+                                      const std::chrono::steady_clock::time_point end) {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+    }
+} // namespace
+
+int main(const int argc, const char **argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view szArgument = argv[i];
+        options.ullJobs = ParseOption(szArgument, "--jobs", static_cast<std::uint32_t>(options.ullJobs));
+        options.dwHttpPercent = ParseOption(szArgument, "--http", options.dwHttpPercent);
+        options.dwErrorPercent = ParseOption(szArgument, "--errors", options.dwErrorPercent);
+        options.dwBackgroundPercent = ParseOption(szArgument, "--background", options.dwBackgroundPercent);
+        options.dwServerDelayUs = ParseOption(szArgument, "--server-delay-us", options.dwServerDelayUs);
+        options.dwFrameMs = ParseOption(szArgument, "--frame-ms", options.dwFrameMs);
+        options.dwSeed = ParseOption(szArgument, "--seed", options.dwSeed);
+    }
+
+    Logger::GetSingleton()->Initialize(false);
+    Logger::SetLogLevel(RbxStu::LogLevel::Warning);
+
+    WSADATA wsaData{};
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        std::fprintf(stderr, "Failed to initialize Winsock!\n");
+        return 1;
+    }
+
+    StandInHttpServer server{options.dwServerDelayUs, 16};
+
+    const luaL_Reg library[] = {{"httpget", RbxStu::YieldingCFunction<httpget>}, {nullptr, nullptr}};
+    const auto host = std::make_shared<HeadlessSchedulerHost>(library);
+
+    // The VM stands in for the one of the DataModel's ScriptContext. Both threads the Scheduler is initialized with are
+    // kept on the stack of its main thread, else nothing would keep them alive.
+    lua_State *robloxL = luaL_newstate();
+    luaL_openlibs(robloxL);
+    luaL_sandbox(robloxL);
+    lua_State *rL = lua_newthread(robloxL);
+    lua_State *L = lua_newthread(robloxL);
+
+    const auto scheduler = SchedulerManager::GetSingleton()->GetScheduler(RBX::DataModelType_Edit).value();
+    scheduler->InitializeWith(host, L, rL, host->GetCurrentDataModel().value());
+    if (!scheduler->IsInitialized()) {
+        std::fprintf(stderr, "Failed to initialize the Scheduler!\n");
+        return 1;
+    }
+
+    const auto szUrl = std::format("http://127.0.0.1:{}/", server.GetPort());
+    std::atomic_size_t ullExpectedErrors = 0;
+    Histogram frameTime;
+
+    // Submit every job from another thread, the way the pipe thread does, whilst the main thread steps the Scheduler.
+    const auto benchmarkStart = std::chrono::steady_clock::now();
+    std::thread producer([&] {
+        std::mt19937 random{options.dwSeed};
+        std::uniform_int_distribution<std::uint32_t> percent{0, 99};
+        std::uniform_int_distribution<std::size_t> smallSize{64, 16 * 1024};
+        std::uniform_int_distribution<std::size_t> largeSize{RbxStu::BackgroundCodeThreshold + 1, 1024 * 1024};
+
+        for (std::size_t i = 0; i < options.ullJobs; i++) {
+            const auto bIsBackground = percent(random) < options.dwBackgroundPercent;
+            auto szCode = GenerateCode(bIsBackground ? largeSize(random) : smallSize(random));
+            if (const auto dwRoll = percent(random); dwRoll < options.dwHttpPercent) {
+                szCode = std::format("local body = httpget(\"{}\")\nassert(body == \"OK\", body)\n", szUrl) + szCode;
+            } else if (dwRoll < options.dwHttpPercent + options.dwErrorPercent) {
+                szCode += "local part = nil\nreturn part.Parent\n";
+                ullExpectedErrors++;
+            }
+
+            scheduler->ScheduleJob(SchedulerJob(std::move(szCode)));
+        }
+    });
+
+    std::size_t ullFrames = 0;
+    std::size_t ullFinished = 0;
+    auto lastProgress = benchmarkStart;
+    while (ullFinished < options.ullJobs) {
+        const auto frameStart = std::chrono::steady_clock::now();
+        scheduler->StepScheduler(L);
+        host->RunDeferredThreads();
+        const auto frameEnd = std::chrono::steady_clock::now();
+        frameTime.Record(MicrosecondsBetween(frameStart, frameEnd));
+        ullFrames++;
+
+        if (const auto ullNowFinished = host->GetCompletedThreads() + host->GetFailedThreads();
+            ullNowFinished != ullFinished) {
+            ullFinished = ullNowFinished;
+            lastProgress = frameEnd;
+        } else if (frameEnd - lastProgress > StallTimeout) {
+            std::fprintf(stderr, "No job has finished in %lld seconds, giving up with %zu of %zu jobs finished!\n",
+                         static_cast<long long>(StallTimeout.count()), ullFinished, options.ullJobs);
+            producer.join();
+            return 1;
+        }
+
+        if (options.dwFrameMs != 0)
+            std::this_thread::sleep_until(frameStart + std::chrono::milliseconds{options.dwFrameMs});
+        else if (frameEnd - frameStart < std::chrono::microseconds{50})
+            std::this_thread::yield();
+    }
+
+    const auto benchmarkEnd = std::chrono::steady_clock::now();
+    producer.join();
+
+    const auto dSeconds = std::chrono::duration<double>(benchmarkEnd - benchmarkStart).count();
+    const auto frames = frameTime.GetSnapshot();
+    std::printf("SchedulerBenchmark: %zu jobs (%u%% httpget, %u%% errors, %u%% background), frame pacing: %s\n",
+                options.ullJobs, options.dwHttpPercent, options.dwErrorPercent, options.dwBackgroundPercent,
+                options.dwFrameMs == 0 ? "unthrottled" : (std::to_string(options.dwFrameMs) + " ms").c_str());
+    std::printf("  elapsed                %.3f s\n", dSeconds);
+    std::printf("  throughput             %.1f jobs/s\n", static_cast<double>(options.ullJobs) / dSeconds);
+    std::printf("  frames                 %zu\n", ullFrames);
+    std::printf("  frame time (us)        mean=%llu p50=%llu p90=%llu p99=%llu max=%llu\n",
+                static_cast<unsigned long long>(frames.ullCount == 0 ? 0 : frames.ullSum / frames.ullCount),
+                static_cast<unsigned long long>(frames.ullP50), static_cast<unsigned long long>(frames.ullP90),
+                static_cast<unsigned long long>(frames.ullP99), static_cast<unsigned long long>(frames.ullMax));
+    std::printf("  completed jobs         %zu\n", host->GetCompletedThreads());
+    std::printf("  failed jobs            %zu (%zu expected)\n", host->GetFailedThreads(), ullExpectedErrors.load());
+    std::printf("Pipeline latencies:\n%s\n", LatencyTracker::GetSingleton()->GenerateReport().c_str());
+
+    const auto bAsExpected = host->GetFailedThreads() == ullExpectedErrors.load();
+    scheduler->ResetScheduler();
+    lua_close(robloxL);
+    WSACleanup();
+    return bAsExpected ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+#include "TraceRecorder.hpp"
+
+#include <Windows.h>
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <fstream>
+#include <string_view>
+
+std::shared_ptr<TraceRecorder> TraceRecorder::pInstance;
+
+static std::atomic_bool s_bIsEnabled{false};
+
+RbxStu::TraceSpan::TraceSpan(const char *szCategory, const char *szName)
+    : m_szCategory(szCategory), m_szName(szName) {
+    // Spans begun whilst tracing is disabled are never recorded, even if it is enabled before they end.
+    if (TraceRecorder::IsEnabled())
+        this->m_start = std::chrono::steady_clock::now();
+}
+
+RbxStu::TraceSpan::~TraceSpan() {
+    if (this->m_start != std::chrono::steady_clock::time_point{})
+        TraceRecorder::GetSingleton()->Record(this->m_szCategory, this->m_szName, this->m_start,
+                                              std::chrono::steady_clock::now());
+}
+
+std::shared_ptr<TraceRecorder> TraceRecorder::GetSingleton() {
+    if (TraceRecorder::pInstance == nullptr)
+        TraceRecorder::pInstance = std::make_shared<TraceRecorder>();
+
+    return TraceRecorder::pInstance;
+}
+
+bool TraceRecorder::IsEnabled() { return s_bIsEnabled.load(std::memory_order_relaxed); }
+
+void TraceRecorder::SetEnabled(const bool bEnabled) {
+    // The instance is created beforehand, as spans may end on any thread once they are recorded.
+    TraceRecorder::GetSingleton();
+    s_bIsEnabled.store(bEnabled, std::memory_order_relaxed);
+}
+
+TraceRecorder::ThreadBuffer *TraceRecorder::GetThreadBuffer() {
+    // The buffer outlives its thread, so that the spans of threads which have exited can still be exported.
+    thread_local struct ThreadBufferOwner {
+        std::shared_ptr<ThreadBuffer> pBuffer;
+
+        ~ThreadBufferOwner() {
+            if (this->pBuffer != nullptr) {
+                std::lock_guard lock{this->pBuffer->mutex};
+                this->pBuffer->bIsAbandoned = true;
+            }
+        }
+    } owner;
+
+    if (owner.pBuffer == nullptr) {
+        owner.pBuffer = std::make_shared<ThreadBuffer>();
+        owner.pBuffer->dwThreadId = GetCurrentThreadId();
+
+        std::lock_guard lock{this->m_buffersMutex};
+        const auto ullAbandoned = std::ranges::count_if(this->m_buffers, [](const auto &pBuffer) {
+            std::lock_guard bufferLock{pBuffer->mutex};
+            return pBuffer->bIsAbandoned;
+        });
+
+        // The oldest buffers come first.
+        if (static_cast<std::size_t>(ullAbandoned) >= TraceRecorder::MaximumAbandonedBuffers) {
+            const auto pOldest = std::ranges::find_if(this->m_buffers, [](const auto &pBuffer) {
+                std::lock_guard bufferLock{pBuffer->mutex};
+                return pBuffer->bIsAbandoned;
+            });
+            this->m_buffers.erase(pOldest);
+        }
+
+        this->m_buffers.push_back(owner.pBuffer);
+    }
+
+    return owner.pBuffer.get();
+}
+
+void TraceRecorder::Record(const char *szCategory, const char *szName,
+                           const std::chrono::steady_clock::time_point start,
+                           const std::chrono::steady_clock::time_point end) {
+    const auto pBuffer = this->GetThreadBuffer();
+    std::lock_guard lock{pBuffer->mutex};
+    const Span span{szCategory, szName, start, end - start};
+    // The buffer only grows as spans are recorded, as most threads record only a handful of them.
+    if (pBuffer->spans.size() < TraceRecorder::SpansPerThread)
+        pBuffer->spans.push_back(span);
+    else
+        pBuffer->spans[pBuffer->ullRecorded % TraceRecorder::SpansPerThread] = span;
+
+    pBuffer->ullRecorded++;
+}
+
+void TraceRecorder::Clear() {
+    std::lock_guard lock{this->m_buffersMutex};
+    std::erase_if(this->m_buffers, [](const auto &pBuffer) {
+        std::lock_guard bufferLock{pBuffer->mutex};
+        pBuffer->spans.clear();
+        pBuffer->ullRecorded = 0;
+        return pBuffer->bIsAbandoned;
+    });
+}
+
+/// @brief Escapes a string to be written into a JSON string.
+static std::string EscapeJson(const std::string_view szString) {
+    std::string szEscaped;
+    for (const auto c: szString) {
+        if (c == '"' || c == '\\')
+            szEscaped += '\\';
+
+        if (static_cast<unsigned char>(c) < 0x20)
+            szEscaped += std::format("\\u{:04x}", static_cast<unsigned char>(c));
+        else
+            szEscaped += c;
+    }
+
+    return szEscaped;
+}
+
+std::string TraceRecorder::ExportChromeTrace() {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard lock{this->m_buffersMutex};
+        buffers = this->m_buffers;
+    }
+
+    // Complete events ("X") carry their duration, timestamps being in microseconds.
+    const auto dwProcessId = GetCurrentProcessId();
+    std::string szTrace = R"({"displayTimeUnit":"ms","traceEvents":[)";
+    bool bIsFirst = true;
+    std::vector<Span> spans;
+    for (const auto &pBuffer: buffers) {
+        std::uint32_t dwThreadId;
+        {
+            std::lock_guard lock{pBuffer->mutex};
+            spans = pBuffer->spans;
+            dwThreadId = pBuffer->dwThreadId;
+        }
+
+        for (const auto &span: spans) {
+            const auto llStart =
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(span.start.time_since_epoch()).count();
+            const auto llDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(span.duration).count();
+            szTrace += std::format(R"({}{{"name":"{}","cat":"{}","ph":"X","ts":{:.3f},"dur":{:.3f},)"
+                                   R"("pid":{},"tid":{}}})",
+                                   bIsFirst ? "" : ",", EscapeJson(span.szName), EscapeJson(span.szCategory),
+                                   static_cast<double>(llStart) / 1000.0, static_cast<double>(llDuration) / 1000.0,
+                                   dwProcessId, dwThreadId);
+            bIsFirst = false;
+        }
+    }
+
+    szTrace += "]}";
+    return szTrace;
+}
+
+bool TraceRecorder::DumpToFile(const std::filesystem::path &path) {
+    std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    file << this->ExportChromeTrace();
+    return file.good();
+}
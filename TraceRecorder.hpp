@@ -0,0 +1,89 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace RbxStu {
+    /// @brief Records the time the current thread spends in its scope as a span on the trace timeline, if tracing is
+    /// enabled when it is constructed.
+    /// @remarks The category and the name are kept as pointers, they must have static storage, such as literals or the
+    /// section names of the Logger.
+    class TraceSpan final {
+        const char *m_szCategory;
+        const char *m_szName;
+        std::chrono::steady_clock::time_point m_start;
+
+    public:
+        TraceSpan(const char *szCategory, const char *szName);
+        ~TraceSpan();
+
+        TraceSpan(const TraceSpan &) = delete;
+        TraceSpan &operator=(const TraceSpan &) = delete;
+    };
+} // namespace RbxStu
+
+/// @brief Keeps the most recent spans of every thread, to be exported as a Chrome trace (chrome://tracing, Perfetto)
+/// on demand.
+class TraceRecorder final {
+    /// @brief Private, Static shared pointer into the instance.
+    static std::shared_ptr<TraceRecorder> pInstance;
+
+    struct Span {
+        const char *szCategory;
+        const char *szName;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::duration duration;
+    };
+
+    /// @brief The spans of a single thread, a ring once full. Its mutex is only ever contended by exports.
+    struct ThreadBuffer {
+        std::mutex mutex;
+        std::uint32_t dwThreadId;
+        std::vector<Span> spans;
+        /// @brief The amount of spans recorded into the buffer, the oldest one being at this index once it is full.
+        std::uint64_t ullRecorded = 0;
+        /// @brief Set once the thread has exited.
+        bool bIsAbandoned = false;
+    };
+
+    std::mutex m_buffersMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+
+    /// @brief Obtains the buffer of the calling thread, registering it on first use.
+    ThreadBuffer *GetThreadBuffer();
+
+public:
+    /// @brief The amount of spans kept per thread, older ones being overwritten.
+    static constexpr std::size_t SpansPerThread = 8192;
+    /// @brief The amount of buffers of threads which have exited that are kept, as threads such as the ones of the
+    /// Scanner are short-lived.
+    static constexpr std::size_t MaximumAbandonedBuffers = 256;
+
+    /// @brief Obtains the shared pointer that points to the global singleton for the current class.
+    /// @return Singleton for TraceRecorder as a std::shared_ptr<TraceRecorder>.
+    static std::shared_ptr<TraceRecorder> GetSingleton();
+
+    /// @brief Obtains whether spans are being recorded.
+    static bool IsEnabled();
+
+    /// @brief Begins or stops recording spans. Spans recorded so far are kept.
+    static void SetEnabled(bool bEnabled);
+
+    /// @brief Records a span of the calling thread.
+    void Record(const char *szCategory, const char *szName, std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end);
+
+    /// @brief Discards every span recorded so far.
+    void Clear();
+
+    /// @brief Generates a Chrome trace, in the JSON format of the Trace Event Format, with every span kept.
+    [[nodiscard]] std::string ExportChromeTrace();
+
+    /// @brief Writes the trace generated by ExportChromeTrace into the given file, replacing its contents.
+    /// @return True if the file was written successfully.
+    bool DumpToFile(const std::filesystem::path &path);
+};
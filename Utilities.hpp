@@ -3,6 +3,7 @@
 //
 #pragma once
 #include <Windows.h>
+#include <filesystem>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -35,6 +36,20 @@ public:
         return GetProcAddress(GetModuleHandle("ntdll.dll"), "wine_get_version") != nullptr;
     }
 
+    /// @return The directory the RbxStu DLL was loaded from, or an empty string if it cannot be determined.
+    __forceinline static std::string GetDllDir() {
+        char path[MAX_PATH];
+        HMODULE hModule = nullptr;
+
+        if (GetModuleHandleEx(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                              reinterpret_cast<LPCSTR>(&Utilities::GetDllDir), &hModule) &&
+            GetModuleFileNameA(hModule, path, sizeof(path))) {
+            return std::filesystem::path(path).parent_path().string();
+        }
+
+        return "";
+    }
+
     /// @brief Used to validate a pointer.
     /// @remarks This template does NOT validate ANY data inside the pointer. It just validates that the pointer is at
     /// LEAST of the size of the given type, and that the pointer is allocated in memory.
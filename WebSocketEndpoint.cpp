@@ -0,0 +1,167 @@
+#include "WebSocketEndpoint.hpp"
+
+#include <format>
+#include <ixwebsocket/IXNetSystem.h>
+#include <ixwebsocket/IXWebSocketServer.h>
+#include <thread>
+
+#include "Communication.hpp"
+#include "CommunicationProtocol.hpp"
+#include "ExecutionReporter.hpp"
+#include "Logger.hpp"
+
+std::shared_ptr<WebSocketEndpoint> WebSocketEndpoint::pInstance;
+
+/// @brief The amount of bytes that may be waiting to be sent to a client before further messages to it are dropped.
+constexpr std::size_t MaximumBufferedSize = 16 * 1024 * 1024;
+
+/// @brief Obtains whether a message of the given size may be sent to the client, which must be connected and must not
+/// have fallen too far behind on what it has been sent already.
+static bool CanSendTo(ix::WebSocket &webSocket, const std::size_t ullSize) {
+    return webSocket.getReadyState() == ix::ReadyState::Open &&
+           webSocket.bufferedAmount() + ullSize <= MaximumBufferedSize;
+}
+
+/// @brief The channel to a WebSocket client, which sends to it for as long as it stays connected.
+class WebSocketReplyChannel final : public RbxStu::ReplyChannel {
+    /// @brief The client, which owns the channel through its message callback, and so must not be owned by it.
+    std::weak_ptr<ix::WebSocket> m_pWebSocket;
+
+public:
+    explicit WebSocketReplyChannel(std::weak_ptr<ix::WebSocket> pWebSocket) : m_pWebSocket(std::move(pWebSocket)) {}
+
+    bool Send(std::string szMessage) override {
+        const auto pWebSocket = this->m_pWebSocket.lock();
+        if (pWebSocket == nullptr || !CanSendTo(*pWebSocket, szMessage.size()))
+            return false;
+
+        return pWebSocket->sendBinary(szMessage).success;
+    }
+
+    [[nodiscard]] bool IsOpen() const override {
+        const auto pWebSocket = this->m_pWebSocket.lock();
+        return pWebSocket != nullptr && pWebSocket->getReadyState() == ix::ReadyState::Open;
+    }
+};
+
+std::shared_ptr<WebSocketEndpoint> WebSocketEndpoint::GetSingleton() {
+    if (WebSocketEndpoint::pInstance == nullptr)
+        WebSocketEndpoint::pInstance = std::make_shared<WebSocketEndpoint>();
+
+    return WebSocketEndpoint::pInstance;
+}
+
+void WebSocketEndpoint::BroadcastOutput() {
+    while (true) {
+        std::deque<std::string> qOutput;
+        {
+            std::unique_lock lock{this->m_outputMutex};
+            this->m_outputCondition.wait(lock, [this] { return !this->m_qPendingOutput.empty(); });
+            qOutput.swap(this->m_qPendingOutput);
+        }
+
+        const auto clients = this->m_pServer->getClients();
+        for (const auto &szOutput: qOutput) {
+            const auto szMessage =
+                    RbxStu::Protocol::SerializeMessage(RbxStu::Protocol::MessageType::ConsoleOutput, 0, szOutput);
+            // Clients that fall behind miss the output instead of buffering it without bound.
+            for (const auto &client: clients) {
+                if (CanSendTo(*client, szMessage.size()))
+                    client->sendBinary(szMessage);
+            }
+        }
+    }
+}
+
+bool WebSocketEndpoint::Start(const std::uint16_t wPort) {
+    const auto logger = Logger::GetSingleton();
+    if (this->m_pServer != nullptr) {
+        logger->PrintWarning(RbxStu::WebSocketEndpoint, "The WebSocket endpoint is running already!");
+        return false;
+    }
+
+    ix::initNetSystem();
+    const auto pServer = std::make_shared<ix::WebSocketServer>(
+            wPort, "127.0.0.1", ix::SocketServer::kDefaultTcpBacklog, WebSocketEndpoint::MaximumClients);
+
+    pServer->setOnConnectionCallback([this](const std::weak_ptr<ix::WebSocket> &pWebSocket,
+                                            const std::shared_ptr<ix::ConnectionState> &connectionState) {
+        const auto pLockedWebSocket = pWebSocket.lock();
+        if (pLockedWebSocket == nullptr)
+            return;
+
+        // The callback is owned by the WebSocket, it may refer to it without keeping it alive.
+        const auto pWebSocketRaw = pLockedWebSocket.get();
+        const auto pChannel = std::make_shared<WebSocketReplyChannel>(pWebSocket);
+        pWebSocketRaw->setOnMessageCallback([this, pWebSocketRaw, pChannel,
+                                             connectionState](const ix::WebSocketMessagePtr &message) {
+            const auto logger = Logger::GetSingleton();
+            const auto szClient = std::format("WebSocket client #{}", connectionState->getId());
+            switch (message->type) {
+                case ix::WebSocketMessageType::Open:
+                    this->m_ullClientCount++;
+                    logger->PrintInformation(RbxStu::WebSocketEndpoint,
+                                             std::format("{} connected from {}.", szClient,
+                                                         connectionState->getRemoteIp()));
+                    break;
+                case ix::WebSocketMessageType::Close:
+                    this->m_ullClientCount--;
+                    logger->PrintInformation(RbxStu::WebSocketEndpoint, std::format("{} disconnected.", szClient));
+                    break;
+                case ix::WebSocketMessageType::Error:
+                    logger->PrintError(RbxStu::WebSocketEndpoint,
+                                       std::format("{} has failed: {}", szClient, message->errorInfo.reason));
+                    break;
+                case ix::WebSocketMessageType::Message: {
+                    const auto receivedAt = std::chrono::steady_clock::now();
+                    RbxStu::Protocol::Message request{};
+                    if (!message->binary) {
+                        request.header = {RbxStu::Protocol::MessageMagic,
+                                          static_cast<std::uint32_t>(message->str.size()), 0,
+                                          RbxStu::Protocol::MessageType::ExecuteScript};
+                        request.szPayload = message->str;
+                    } else if (RbxStu::Protocol::ParseMessage(message->str, request) !=
+                               RbxStu::Protocol::ReadStatus::Success) {
+                        logger->PrintError(RbxStu::WebSocketEndpoint,
+                                           std::format("{} sent a malformed message! Dropping it.", szClient));
+                        pWebSocketRaw->close();
+                        break;
+                    }
+
+                    Communication::SubmitMessage(request, szClient, receivedAt, pChannel);
+                    break;
+                }
+                default:
+                    break;
+            }
+        });
+    });
+
+    if (const auto [bListening, szError] = pServer->listen(); !bListening) {
+        logger->PrintError(RbxStu::WebSocketEndpoint,
+                           std::format("Failed to listen on 127.0.0.1:{}! Error: {}", wPort, szError));
+        return false;
+    }
+
+    pServer->start();
+    this->m_pServer = pServer;
+
+    std::thread([this] { this->BroadcastOutput(); }).detach();
+    logger->AddOutputListener([this](RBX::Console::MessageType, const std::string &szOutput) {
+        if (this->m_ullClientCount.load(std::memory_order_relaxed) == 0)
+            return;
+
+        std::lock_guard lock{this->m_outputMutex};
+        if (this->m_qPendingOutput.size() >= WebSocketEndpoint::MaximumPendingOutput)
+            this->m_qPendingOutput.pop_front();
+
+        this->m_qPendingOutput.emplace_back(szOutput);
+        this->m_outputCondition.notify_one();
+    });
+
+    logger->PrintInformation(RbxStu::WebSocketEndpoint,
+                             std::format("Listening for WebSocket clients on ws://127.0.0.1:{}/", wPort));
+    return true;
+}
+
+std::size_t WebSocketEndpoint::GetClientCount() const { return this->m_ullClientCount; }
@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace ix {
+    class WebSocketServer;
+} // namespace ix
+
+/// @brief A loopback WebSocket server through which tools may execute code, as they would through the pipe.
+/// @remarks Every binary frame carries one message of the pipe protocol, header and payload alike, whilst text frames
+/// are executed as Luau code with no request ID. Every request is answered with a RequestResult message, followed by
+/// ExecutionEvents messages once accepted, and the RbxStu console is streamed to every client as ConsoleOutput
+/// messages. Frames are compressed with permessage-deflate if the client supports it.
+class WebSocketEndpoint final {
+    /// @brief Private, Static shared pointer into the instance.
+    static std::shared_ptr<WebSocketEndpoint> pInstance;
+
+    /// @brief The amount of clients that may be connected at once.
+    static constexpr std::size_t MaximumClients = 32;
+    /// @brief The amount of console output that may be waiting to be sent before the oldest of it is dropped.
+    static constexpr std::size_t MaximumPendingOutput = 4096;
+
+    std::shared_ptr<ix::WebSocketServer> m_pServer;
+    std::atomic_size_t m_ullClientCount;
+
+    /// @brief Guards the console output that is waiting to be sent.
+    std::mutex m_outputMutex;
+    std::condition_variable m_outputCondition;
+    std::deque<std::string> m_qPendingOutput;
+
+    /// @brief Sends the console output to every client as it is written, so that slow clients never hold up the
+    /// Logger.
+    void BroadcastOutput();
+
+public:
+    /// @brief Obtains the shared pointer that points to the global singleton for the current class.
+    /// @return Singleton for WebSocketEndpoint as a std::shared_ptr<WebSocketEndpoint>.
+    static std::shared_ptr<WebSocketEndpoint> GetSingleton();
+
+    /// @brief Begins listening for clients on the loopback interface.
+    /// @param wPort The port to listen on.
+    /// @return True if the server is listening, false if it could not be started or is running already.
+    bool Start(std::uint16_t wPort);
+
+    /// @brief Obtains the amount of clients currently connected.
+    [[nodiscard]] std::size_t GetClientCount() const;
+};
@@ -4,19 +4,30 @@
 #include <Windows.h>
 
 #include <Logger.hpp>
+#include <charconv>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
 
 #include <DbgHelp.h> // Must be positioned here because else include failure.
 
 #include "Communication.hpp"
+#include "CoverageCollector.hpp"
 #include "LuauManager.hpp"
+#include "MetricsEndpoint.hpp"
+#include "MetricsRegistry.hpp"
 #include "RobloxManager.hpp"
 #include "Scanner.hpp"
 #include "Scheduler.hpp"
+#include "SchedulerManager.hpp"
+#include "SharedMemoryEndpoint.hpp"
+#include "TraceRecorder.hpp"
+#include "WebSocketEndpoint.hpp"
 
 long exception_filter(PEXCEPTION_POINTERS pExceptionPointers) {
     const auto *pContext = pExceptionPointers->ContextRecord;
+    // Writes out whatever was logged before the exception, as the logging thread will not get to.
+    Logger::GetSingleton()->Flush();
     printf("\r\n-- WARNING: Exception handler caught an exception\r\n");
 
     if (pExceptionPointers->ExceptionRecord->ExceptionCode == EXCEPTION_ACCESS_VIOLATION) {
@@ -111,8 +122,48 @@ long exception_filter(PEXCEPTION_POINTERS pExceptionPointers) {
 int main() {
     SetUnhandledExceptionFilter(exception_filter);
     AllocConsole();
+    // Metrics are registered from whichever thread first uses them, the registry must exist before any of them run.
+    MetricsRegistry::GetSingleton();
     const auto logger = Logger::GetSingleton();
     logger->Initialize(true);
+
+    // Levels may be configured at runtime, e.g. "Warning,RbxStu::Scheduler=Debug", never below the compiled one.
+    if (char szLevels[256]{}; GetEnvironmentVariableA("RBXSTU_LOG_LEVEL", szLevels, sizeof(szLevels)) != 0 &&
+                              !Logger::ConfigureLogLevels(szLevels)) {
+        RbxStuLog(Warning, RbxStu::MainThread, "RBXSTU_LOG_LEVEL is not a valid configuration: '{}'", szLevels);
+    }
+
+    // The sections that may flood the console are rate limited, so that a burst of messages cannot stall Studio. Other
+    // limits, or lifting these, may be configured at runtime, e.g. "RbxStu::Scheduler=off,RbxStu::Security=1/10".
+    Logger::ConfigureLogLimits("RbxStu::HookedFunction<anonymous>=200/s,RbxStu::Scheduler=200/s");
+    if (char szLimits[256]{}; GetEnvironmentVariableA("RBXSTU_LOG_LIMITS", szLimits, sizeof(szLimits)) != 0 &&
+                              !Logger::ConfigureLogLimits(szLimits)) {
+        RbxStuLog(Warning, RbxStu::MainThread, "RBXSTU_LOG_LIMITS is not a valid configuration: '{}'", szLimits);
+    }
+
+    // Log files are opt-in, they are kept across sessions, rotated by size. Binary ones also carry the traces, and are
+    // read with Tools/LogDecoder.
+    auto logFileFormat = RbxStu::LogFileFormat::Text;
+    if (char szFormat[16]{}; GetEnvironmentVariableA("RBXSTU_LOG_FORMAT", szFormat, sizeof(szFormat)) != 0 &&
+                             std::string_view{szFormat} == "binary")
+        logFileFormat = RbxStu::LogFileFormat::Binary;
+
+    if (char szDirectory[MAX_PATH]{};
+        GetEnvironmentVariableA("RBXSTU_LOG_DIRECTORY", szDirectory, sizeof(szDirectory)) != 0 &&
+        !logger->EnableFileSink(szDirectory, logFileFormat)) {
+        RbxStuLog(Warning, RbxStu::MainThread, "Failed to create log files in RBXSTU_LOG_DIRECTORY: '{}'", szDirectory);
+    }
+
+    // Tracing may be enabled from the start, so that the Scanner's work shows as well, or later through settracing.
+    if (char szTrace[8]{}; GetEnvironmentVariableA("RBXSTU_TRACE", szTrace, sizeof(szTrace)) != 0 &&
+                           std::string_view{szTrace} == "1")
+        TraceRecorder::SetEnabled(true);
+
+    // Coverage is opt-in, as instrumented scripts run slower. It may also be toggled later through setcoverage.
+    if (char szCoverage[8]{}; GetEnvironmentVariableA("RBXSTU_COVERAGE", szCoverage, sizeof(szCoverage)) != 0 &&
+                              std::string_view{szCoverage} == "1")
+        CoverageCollector::SetEnabled(true);
+
     logger->PrintInformation(RbxStu::MainThread,
                              std::format("-- Studio Base: {}", static_cast<void *>(GetModuleHandle(nullptr))));
     logger->PrintInformation(RbxStu::MainThread,
@@ -126,12 +177,44 @@ int main() {
 
     std::thread(Communication::HandlePipe, "CommunicationPipe").detach();
 
+    // The WebSocket endpoint is opt-in, as it is reachable by anything running on the machine.
+    if (char szPort[8]{}; GetEnvironmentVariableA("RBXSTU_WEBSOCKET_PORT", szPort, sizeof(szPort)) != 0) {
+        std::uint16_t wPort{};
+        if (const auto [pEnd, error] = std::from_chars(szPort, szPort + std::strlen(szPort), wPort);
+            error == std::errc{} && wPort != 0) {
+            logger->PrintInformation(RbxStu::MainThread, "-- Initializing WebSocketEndpoint...");
+            WebSocketEndpoint::GetSingleton()->Start(wPort);
+        } else {
+            logger->PrintWarning(RbxStu::MainThread,
+                                 std::format("RBXSTU_WEBSOCKET_PORT is not a valid port: '{}'", szPort));
+        }
+    }
+
+    // So is the shared memory endpoint, it is meant for tools that submit more than the pipe can take.
+    if (char szName[64]{}; GetEnvironmentVariableA("RBXSTU_SHARED_MEMORY", szName, sizeof(szName)) != 0) {
+        logger->PrintInformation(RbxStu::MainThread, "-- Initializing SharedMemoryEndpoint...");
+        SharedMemoryEndpoint::GetSingleton()->Start(szName);
+    }
+
+    // The metrics endpoint is opt-in as well, it only serves /metrics, for dashboards to scrape.
+    if (char szPort[8]{}; GetEnvironmentVariableA("RBXSTU_METRICS_PORT", szPort, sizeof(szPort)) != 0) {
+        std::uint16_t wPort{};
+        if (const auto [pEnd, error] = std::from_chars(szPort, szPort + std::strlen(szPort), wPort);
+            error == std::errc{} && wPort != 0) {
+            logger->PrintInformation(RbxStu::MainThread, "-- Initializing MetricsEndpoint...");
+            MetricsEndpoint::GetSingleton()->Start(wPort);
+        } else {
+            logger->PrintWarning(RbxStu::MainThread,
+                                 std::format("RBXSTU_METRICS_PORT is not a valid port: '{}'", szPort));
+        }
+    }
+
     const auto robloxPrint = robloxManager->GetRobloxPrint().value();
 
     robloxPrint(RBX::Console::MessageType::InformationBlue, "RbxStu: Waiting for client DataModel...");
     logger->PrintInformation(RbxStu::MainThread, "Waiting for the client DataModel...");
 
-    const auto scheduler = Scheduler::GetSingleton();
+    const auto schedulerManager = SchedulerManager::GetSingleton();
     while (true) {
         if (!robloxManager->IsDataModelValid(RBX::DataModelType_PlayClient)) {
             _mm_pause();